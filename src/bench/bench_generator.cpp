@@ -0,0 +1,118 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Measures and checks the puzzle generator over a range of sizes and
+ * noise scales, including sizes that are not a multiple of the scale.
+ * Every puzzle must have the requested size and exactly one solution.
+ * Build with NONNY_SANITIZE to also catch out-of-bounds reads while
+ * the picture is laid out.
+ *
+ * Usage: bench_generator [-n PUZZLES] [-s SEED]
+ *
+ * Exits with status 1 if any check fails.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "bench/benchmark.hpp"
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_generator.hpp"
+#include "solver/solver.hpp"
+
+const int sizes[] = { 1, 5, 10, 15, 23, 30 };
+const int scales[] = { 0, 2, 3, 4, 5, 7 };
+
+void run_case(int size, int scale, int num_puzzles, unsigned seed)
+{
+  typedef std::chrono::steady_clock clock;
+
+  GeneratorOptions options;
+  options.width = size;
+  options.height = size + 1; //keep rows and columns from lining up
+  options.noise_scale = scale;
+  if (scale == 0)
+    options.density = 0.7;
+
+  std::string label = std::to_string(options.width) + "x"
+    + std::to_string(options.height) + " scale "
+    + std::to_string(scale);
+
+  PuzzleGenerator generate(options, seed);
+  auto start = clock::now();
+  for (int i = 0; i < num_puzzles; ++i) {
+    Puzzle puzzle = generate();
+    if (puzzle.width() != options.width
+        || puzzle.height() != options.height) {
+      bench::fail(label + ": puzzle has the wrong size");
+      continue;
+    }
+
+    puzzle.clear_all_cells();
+    Solver solve(puzzle);
+    solve();
+    if (solve.num_solutions() != 1)
+      bench::fail(label + ": puzzle " + std::to_string(i) + " has "
+                  + std::to_string(solve.num_solutions()) + " solutions");
+  }
+  std::chrono::duration<double, std::milli> elapsed = clock::now() - start;
+
+  std::printf("%-40s %12.3f ms/puzzle %8ld candidates\n", label.c_str(),
+              elapsed.count() / num_puzzles, generate.num_candidates());
+}
+
+int main(int argc, char* argv[])
+{
+  int num_puzzles = 5;
+  unsigned seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-n" && i + 1 < argc) {
+      num_puzzles = std::stoi(argv[++i]);
+    } else if (arg == "-s" && i + 1 < argc) {
+      seed = std::stoul(argv[++i]);
+    } else {
+      std::cerr << "Usage: bench_generator [-n PUZZLES] [-s SEED]"
+                << std::endl;
+      return 2;
+    }
+  }
+  if (num_puzzles < 1) {
+    std::cerr << "bench_generator: invalid number of puzzles" << std::endl;
+    return 2;
+  }
+
+  try {
+    for (int size : sizes)
+      for (int scale : scales)
+        run_case(size, scale, num_puzzles, seed);
+  } catch (const std::exception& e) {
+    std::cerr << "bench_generator: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (bench::num_failures() > 0) {
+    std::cerr << bench::num_failures() << " checks failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
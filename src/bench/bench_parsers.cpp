@@ -0,0 +1,276 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Measures and checks the readers for every puzzle format. Random
+ * puzzles of several size classes are written out in each format and
+ * must read and skim back to the same puzzle before their throughput
+ * is measured. Corrupted copies of the same files are then fed to the
+ * readers, which may reject them but must not crash or accept them
+ * inconsistently. Build with NONNY_SANITIZE to catch memory errors
+ * during the corruption pass.
+ *
+ * Usage: bench_parsers [-n MUTATIONS] [-s SEED]
+ *
+ * Exits with status 1 if any check fails.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench/benchmark.hpp"
+#include "bench/parse_check.hpp"
+#include "color/color_palette.hpp"
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "puzzle/puzzle_summary.hpp"
+
+struct FormatInfo {
+  const char* name;
+  PuzzleFormat format;
+  bool has_colors;
+};
+
+const FormatInfo formats[] = {
+  { "non", PuzzleFormat::non, true },
+  { "g", PuzzleFormat::g, true },
+  { "mk", PuzzleFormat::mk, false },
+  { "nin", PuzzleFormat::nin, false },
+  { "nbn", PuzzleFormat::nbn, true }
+};
+
+struct SizeClass {
+  const char* name;
+  int size;
+};
+
+const SizeClass size_classes[] = {
+  { "small", 15 },
+  { "medium", 60 },
+  { "large", 250 }
+};
+
+// Build a random puzzle by filling cells and deriving the clues
+Puzzle make_puzzle(int size, bool multicolor, std::mt19937& rng)
+{
+  ColorPalette palette;
+  std::vector<Color> colors = { palette["black"] };
+  if (multicolor) {
+    palette.add(Color(255, 0, 0), "red", 'r');
+    palette.add(Color(0, 160, 0), "green", 'g');
+    palette.add(Color(0, 0, 255), "blue", 'b');
+    colors = { palette["black"], palette["red"], palette["green"],
+               palette["blue"] };
+  }
+
+  std::uniform_int_distribution<int> pick(-1, colors.size() - 1);
+  Puzzle puzzle(size, size, palette);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      int c = pick(rng);
+      if (c >= 0)
+        puzzle.mark_cell(x, y, colors[c]);
+    }
+  }
+  puzzle.update(true);
+  puzzle.clear_all_cells();
+  puzzle.set_property("title", "Random " + std::to_string(size));
+  puzzle.set_property("by", "bench_parsers");
+  return puzzle;
+}
+
+std::string to_string(const Puzzle& puzzle, PuzzleFormat fmt)
+{
+  std::ostringstream ss;
+  write_puzzle(ss, puzzle, fmt);
+  return ss.str();
+}
+
+// Damage a copy of a file in one of several ways
+std::string mutate(const std::string& data, std::mt19937& rng)
+{
+  static const char* const snippets[] = {
+    "0", "-1", "99999999999", " ", "\n", "\r\n", ",", ":", "\"",
+    "width ", "height ", "rows\n", "columns\n", "color ", "#", "\x80",
+    "red: "
+  };
+  constexpr int num_snippets = sizeof(snippets) / sizeof(snippets[0]);
+
+  std::string result = data;
+  std::uniform_int_distribution<int> count(1, 4);
+  for (int n = count(rng); n > 0; --n) {
+    std::size_t pos = result.empty() ? 0 : rng() % result.size();
+    switch (rng() % 6) {
+    case 0: //truncate
+      result.resize(pos);
+      break;
+    case 1: //flip a bit
+      if (!result.empty())
+        result[pos] ^= static_cast<char>(1 << (rng() % 8));
+      break;
+    case 2: //drop a span
+      result.erase(pos, rng() % 16);
+      break;
+    case 3: //insert something plausible
+      result.insert(pos, snippets[rng() % num_snippets]);
+      break;
+    case 4: //duplicate a span
+      result.insert(pos, result.substr(pos, rng() % 64));
+      break;
+    case 5: //replace a byte with a random one
+      if (!result.empty())
+        result[pos] = static_cast<char>(rng());
+      break;
+    }
+  }
+  return result;
+}
+
+void check_round_trip(const FormatInfo& info, const SizeClass& size_class,
+                      const Puzzle& puzzle, const std::string& data)
+{
+  std::string label = std::string(info.name) + " " + size_class.name;
+
+  Puzzle copy;
+  try {
+    read_puzzle(data.data(), data.size(), copy, info.format);
+  } catch (const std::exception& e) {
+    bench::fail(label + ": could not read written puzzle: " + e.what());
+    return;
+  }
+  if (!bench::same_clues(puzzle, copy, info.has_colors))
+    bench::fail(label + ": clues changed in round trip");
+
+  PuzzleSummary summary;
+  skim_puzzle(data.data(), data.size(), summary, info.format);
+  if (summary.width != puzzle.width() || summary.height != puzzle.height())
+    bench::fail(label + ": skim found the wrong size");
+
+  //the stream readers must agree with the memory readers
+  std::istringstream ss(data);
+  Puzzle from_stream;
+  read_puzzle(ss, from_stream, info.format);
+  if (!bench::same_clues(copy, from_stream))
+    bench::fail(label + ": stream and memory readers disagree");
+}
+
+void run_format_cases(const FormatInfo& info, std::mt19937& rng)
+{
+  for (const auto& size_class : size_classes) {
+    Puzzle puzzle = make_puzzle(size_class.size, info.has_colors, rng);
+    std::string data = to_string(puzzle, info.format);
+    check_round_trip(info, size_class, puzzle, data);
+
+    std::string label = std::string(info.name) + " " + size_class.name
+      + " (" + std::to_string(data.size() / 1024) + " KiB)";
+    bench::report(bench::run("read " + label, data.size(), [&]() {
+          Puzzle p;
+          read_puzzle(data.data(), data.size(), p, info.format);
+          bench::keep(p);
+        }, 0.25));
+    bench::report(bench::run("skim " + label, data.size(), [&]() {
+          PuzzleSummary summary;
+          skim_puzzle(data.data(), data.size(), summary, info.format);
+          bench::keep(summary);
+        }, 0.25));
+    bench::report(bench::run("write " + label, data.size(), [&]() {
+          std::ostringstream ss;
+          write_puzzle(ss, puzzle, info.format);
+          bench::keep(ss);
+        }, 0.25));
+  }
+}
+
+void run_mutation_cases(const FormatInfo& info, int num_mutations,
+                        std::mt19937& rng)
+{
+  std::vector<std::string> seeds;
+  for (int size : { 5, 12 }) {
+    for (bool multicolor : { false, true }) {
+      if (multicolor && !info.has_colors)
+        continue;
+      seeds.push_back(to_string(make_puzzle(size, multicolor, rng),
+                                info.format));
+    }
+  }
+
+  int accepted = 0, rejected = 0;
+  for (int i = 0; i < num_mutations; ++i) {
+    std::string input = mutate(seeds[i % seeds.size()], rng);
+    std::string message;
+    switch (bench::check_parse(input.data(), input.size(), info.format,
+                               message)) {
+    case bench::ParseResult::accepted:
+      ++accepted;
+      break;
+    case bench::ParseResult::rejected:
+      ++rejected;
+      break;
+    case bench::ParseResult::inconsistent:
+      bench::fail(std::string(info.name) + " mutation " + std::to_string(i)
+                  + ": " + message);
+      break;
+    }
+  }
+
+  std::printf("%-40s %12d accepted %8d rejected\n",
+              (std::string("corrupt ") + info.name).c_str(),
+              accepted, rejected);
+}
+
+int main(int argc, char* argv[])
+{
+  int num_mutations = 2000;
+  unsigned seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-n" && i + 1 < argc) {
+      num_mutations = std::stoi(argv[++i]);
+    } else if (arg == "-s" && i + 1 < argc) {
+      seed = std::stoul(argv[++i]);
+    } else {
+      std::cerr << "Usage: bench_parsers [-n MUTATIONS] [-s SEED]"
+                << std::endl;
+      return 2;
+    }
+  }
+
+  try {
+    std::mt19937 rng(seed);
+    bench::report_header();
+    for (const auto& info : formats)
+      run_format_cases(info, rng);
+    for (const auto& info : formats)
+      run_mutation_cases(info, num_mutations, rng);
+  } catch (const std::exception& e) {
+    std::cerr << "bench_parsers: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (bench::num_failures() > 0) {
+    std::cerr << bench::num_failures() << " checks failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,253 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Measures puzzle file parsing. Synthetic .non files of increasing
+ * size are generated in the temporary directory, along with .nbn
+ * copies, and any files named on the command line are measured as
+ * well. A directory of small puzzles is also compared with a pack
+ * file holding the same puzzles, and each puzzle is also written back
+ * out in the text and binary formats.
+ *
+ * Usage: bench_puzzle_io [file...]
+ */
+
+#include <experimental/filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench/benchmark.hpp"
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "puzzle/puzzle_pack.hpp"
+#include "puzzle/puzzle_summary.hpp"
+
+namespace stdfs = std::experimental::filesystem;
+
+const char* const color_names[] = { "black", "red", "green", "blue" };
+const char* const color_values[] = { "000000", "FF0000", "00FF00", "0000FF" };
+const char color_symbols[] = { 'X', 'r', 'g', 'b' };
+
+/*
+ * Write the clues for one line of a grid. Cells hold a color index,
+ * or -1 for background.
+ */
+void write_line(std::ostream& os, const std::vector<int>& cells)
+{
+  int cur_color = -1;
+  bool first = true;
+  std::size_t i = 0;
+  while (i < cells.size()) {
+    if (cells[i] < 0) {
+      ++i;
+      continue;
+    }
+
+    std::size_t start = i;
+    while (i < cells.size() && cells[i] == cells[start])
+      ++i;
+
+    if (!first)
+      os << ", ";
+    if (cells[start] != cur_color) {
+      cur_color = cells[start];
+      os << color_names[cur_color] << ": ";
+    }
+    os << i - start;
+    first = false;
+  }
+
+  if (first)
+    os << "0";
+  os << "\n";
+}
+
+// Generate a random puzzle with the given dimensions in .non format
+std::string make_puzzle_file(const stdfs::path& dir, int size,
+                             int num_colors, unsigned seed = 0)
+{
+  std::mt19937 rng(seed ? seed : size);
+  std::uniform_int_distribution<int> dist(-1, num_colors - 1);
+  std::vector<std::vector<int>> grid(size, std::vector<int>(size));
+  for (auto& row : grid)
+    for (auto& cell : row)
+      cell = dist(rng);
+
+  std::string name = "bench_" + std::to_string(size) + "x"
+    + std::to_string(size);
+  if (seed)
+    name += "_" + std::to_string(seed);
+  std::string filename = (dir / (name + ".non")).string();
+  std::ofstream file(filename);
+  file << "title \"Benchmark " << size << "\"\n"
+       << "by \"bench_puzzle_io\"\n"
+       << "width " << size << "\n"
+       << "height " << size << "\n\n";
+  for (int c = 0; c < num_colors; ++c)
+    file << "color " << color_names[c] << " " << color_values[c]
+         << " " << color_symbols[c] << "\n";
+
+  file << "\nrows\n";
+  for (const auto& row : grid)
+    write_line(file, row);
+
+  file << "\ncolumns\n";
+  std::vector<int> col(size);
+  for (int x = 0; x < size; ++x) {
+    for (int y = 0; y < size; ++y)
+      col[y] = grid[y][x];
+    write_line(file, col);
+  }
+
+  return filename;
+}
+
+// Write a copy of a puzzle file in the binary format
+std::string make_binary_copy(const std::string& filename)
+{
+  Puzzle puzzle;
+  read_puzzle_file(filename, puzzle);
+
+  std::string copy = stdfs::path(filename).replace_extension(".nbn").string();
+  std::ofstream file(copy, std::ios::binary);
+  write_puzzle(file, puzzle, PuzzleFormat::nbn);
+  return copy;
+}
+
+void run_file_cases(const std::string& filename)
+{
+  std::string name = stdfs::path(filename).filename().string();
+  std::size_t bytes = stdfs::file_size(filename);
+  PuzzleFormat fmt = puzzle_format(filename);
+
+  bench::report(bench::run("read_puzzle_file " + name, bytes, [&]() {
+        Puzzle puzzle;
+        read_puzzle_file(filename, puzzle, fmt);
+        bench::keep(puzzle);
+      }));
+
+  bench::report(bench::run("read_puzzle(istream) " + name, bytes, [&]() {
+        Puzzle puzzle;
+        std::ifstream file(filename, std::ios::binary);
+        read_puzzle(file, puzzle, fmt);
+        bench::keep(puzzle);
+      }));
+
+  bench::report(bench::run("skim_puzzle_file " + name, 0, [&]() {
+        PuzzleSummary summary;
+        skim_puzzle_file(filename, summary, fmt);
+        bench::keep(summary);
+      }));
+
+  //exporting, as when converting a collection to another format
+  Puzzle puzzle;
+  read_puzzle_file(filename, puzzle, fmt);
+  for (PuzzleFormat out_fmt : { PuzzleFormat::non, PuzzleFormat::nbn }) {
+    std::ostringstream ss;
+    write_puzzle(ss, puzzle, out_fmt);
+    std::string label = out_fmt == PuzzleFormat::non ? "non" : "nbn";
+    bench::report(bench::run("write_puzzle(" + label + ") " + name,
+                             ss.str().size(), [&]() {
+          std::ostringstream out;
+          write_puzzle(out, puzzle, out_fmt);
+          bench::keep(out);
+        }));
+  }
+}
+
+/*
+ * Compare browsing a directory of small puzzles file by file with
+ * listing the same puzzles from a pack index.
+ */
+void run_pack_cases(const stdfs::path& dir, int count)
+{
+  stdfs::path puzzle_dir = dir / "bench_puzzle_io_pack";
+  stdfs::create_directories(puzzle_dir);
+  for (int i = 1; i <= count; ++i)
+    make_puzzle_file(puzzle_dir, 20, 2, i);
+
+  std::string pack_filename = (dir / "bench_puzzle_io.npk").string();
+  {
+    PuzzlePackWriter writer(pack_filename);
+    for (const auto& entry : stdfs::directory_iterator(puzzle_dir)) {
+      Puzzle puzzle;
+      read_puzzle_file(entry.path().string(), puzzle);
+      writer.add(entry.path().filename().string(), puzzle);
+    }
+    writer.close();
+  }
+
+  std::string n = std::to_string(count);
+  bench::report(bench::run("skim directory (" + n + " files)", 0, [&]() {
+        std::vector<PuzzleSummary> summaries;
+        for (const auto& entry : stdfs::directory_iterator(puzzle_dir)) {
+          summaries.emplace_back();
+          skim_puzzle_file(entry.path().string(), summaries.back());
+        }
+        bench::keep(summaries);
+      }));
+
+  bench::report(bench::run("list pack (" + n + " puzzles)", 0, [&]() {
+        PuzzlePack pack(pack_filename);
+        bench::keep(pack);
+      }));
+
+  PuzzlePack pack(pack_filename);
+  bench::report(bench::run("load one puzzle from pack", 0, [&]() {
+        Puzzle puzzle;
+        pack.load(pack.size() / 2, puzzle);
+        bench::keep(puzzle);
+      }));
+
+  stdfs::remove_all(puzzle_dir);
+  stdfs::remove(pack_filename);
+}
+
+int main(int argc, char* argv[])
+{
+  try {
+    std::vector<std::string> generated;
+    stdfs::path dir = stdfs::temp_directory_path();
+    for (int size : { 25, 100, 400, 1000 }) {
+      generated.push_back(make_puzzle_file(dir, size, 4));
+      generated.push_back(make_binary_copy(generated.back()));
+    }
+
+    std::vector<std::string> files = generated;
+    for (int i = 1; i < argc; ++i)
+      files.push_back(argv[i]);
+
+    bench::report_header();
+    for (const auto& filename : files)
+      run_file_cases(filename);
+    run_pack_cases(dir, 2000);
+
+    for (const auto& filename : generated)
+      stdfs::remove(filename);
+  } catch (const std::exception& e) {
+    std::cerr << "bench_puzzle_io: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
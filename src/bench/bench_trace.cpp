@@ -0,0 +1,111 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Measures the cost of a trace scope, alone, nested, and on several
+ * threads at once. Configure with NONNY_TRACE to measure the real
+ * cost; otherwise the scopes compile to nothing and this measures the
+ * loop. Each scope should stay well under 50 ns.
+ *
+ * Usage: bench_trace [OUTPUT_FILE]
+ *
+ * With an output file, the recorded trace is written there afterward.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench/benchmark.hpp"
+#include "config.h"
+#include "utility/trace.hpp"
+
+//each case records a few million events, which stays below the
+//per-thread limit so that none are dropped
+constexpr double seconds_per_case = 0.05;
+
+void nested(int depth)
+{
+  NONNY_TRACE_SCOPE("nested");
+  if (depth > 1)
+    nested(depth - 1);
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc > 2) {
+    std::cerr << "Usage: bench_trace [OUTPUT_FILE]" << std::endl;
+    return 2;
+  }
+
+#ifndef NONNY_TRACE
+  std::printf("Tracing is not built in; scopes cost nothing\n");
+#endif
+
+  bench::report_header();
+  int counter = 0;
+  bench::report(bench::run("empty loop", 0, [&]() {
+        bench::keep(++counter);
+      }, seconds_per_case));
+  bench::report(bench::run("one scope", 0, [&]() {
+        NONNY_TRACE_SCOPE("one scope");
+        bench::keep(++counter);
+      }, seconds_per_case));
+  bench::report(bench::run("4 nested scopes", 0, [&]() {
+        for (int i = 0; i < 4; ++i) {
+          NONNY_TRACE_SCOPE("loop");
+          bench::keep(++counter);
+        }
+      }, seconds_per_case));
+  bench::report(bench::run("nested calls, depth 8", 0, [&]() {
+        nested(8);
+      }, seconds_per_case / 4));
+
+  //the threads have their own buffers, so they should not slow each
+  //other down
+  unsigned num_threads = std::max(2u, std::thread::hardware_concurrency());
+  std::vector<bench::Result> results(num_threads);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&results, t]() {
+        int local = 0;
+        results[t] = bench::run("one scope, thread " + std::to_string(t),
+                                0, [&]() {
+                                  NONNY_TRACE_SCOPE("thread scope");
+                                  bench::keep(++local);
+                                }, seconds_per_case);
+      });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  for (const auto& result : results)
+    bench::report(result);
+
+  if (argc > 1) {
+    trace::set_output_file(argv[1]);
+    if (!trace::dump()) {
+      std::cerr << "bench_trace: could not write " << argv[1] << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
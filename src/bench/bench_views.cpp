@@ -0,0 +1,332 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Measures how long each game view takes to update and draw, using the
+ * offscreen video system so that no display is needed. The views are
+ * opened one after another as a player would reach them, and each is
+ * run for a fixed number of frames of simulated time. For every view
+ * the mean and worst frame times are reported along with the number
+ * of draw calls per frame and the textures uploaded while it was open.
+ *
+ * Once a view has settled, its final frame can be saved as a PNG image
+ * or compared pixel by pixel with one saved earlier, to check that an
+ * optimization left the output unchanged:
+ *
+ * Usage: bench_views [-n FRAMES] [-p PUZZLE] [--save DIR] [--compare DIR]
+ *
+ * Exits with status 1 if a frame differs from its saved copy. Saved
+ * progress and the library cache go to a temporary directory, which is
+ * removed afterward, so the player's own files are left alone.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <experimental/filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "color/color.hpp"
+#include "input/input_handler.hpp"
+#include "settings/game_settings.hpp"
+#include "utility/png_image.hpp"
+#include "video/renderer.hpp"
+#include "video/video_system.hpp"
+#include "video/window.hpp"
+#include "view/message_box_view.hpp"
+#include "view/view_manager.hpp"
+
+namespace stdfs = std::experimental::filesystem;
+
+typedef std::chrono::steady_clock Clock;
+
+constexpr int screen_width = 1024;
+constexpr int screen_height = 768;
+constexpr unsigned frame_ticks = 16; //simulated time per frame
+constexpr int warmup_frames = 5;
+
+// Input that never arrives
+class NullInput : public InputHandler {
+public:
+  void capture_mouse() override { }
+  void release_mouse() override { }
+
+  void set_cursor(Mouse::Cursor cursor) override { m_cursor = cursor; }
+  void reset_cursor() override { m_cursor = Mouse::Cursor::arrow; }
+  Mouse::Cursor cursor() const override { return m_cursor; }
+
+private:
+  Mouse::Cursor m_cursor = Mouse::Cursor::arrow;
+};
+
+// A view to measure and how to reach it from the previous one
+struct Scene {
+  const char* name;
+  std::function<void(ViewManager&)> enter;
+};
+
+struct SceneResult {
+  int frames = 0;
+  double total_ms = 0.0;
+  double max_ms = 0.0;
+  long draw_calls = 0;
+  long texture_uploads = 0;
+  long differing_pixels = -1; //-1 if not compared
+};
+
+class ViewBench {
+public:
+  ViewBench(VideoSystem& video, Renderer& renderer, GameSettings& settings)
+    : m_renderer(renderer),
+      m_mgr(video, renderer, settings, screen_width, screen_height)
+  { m_mgr.preload_assets(); }
+
+  ViewManager& view_manager() { return m_mgr; }
+
+  // Update and draw one frame; returns the time taken in milliseconds
+  double frame(std::vector<std::uint32_t>* pixels = nullptr);
+
+  // Run frames until the view has nothing left to animate or compute
+  void settle();
+
+private:
+  Renderer& m_renderer;
+  ViewManager m_mgr;
+  NullInput m_input;
+};
+
+double ViewBench::frame(std::vector<std::uint32_t>* pixels)
+{
+  auto start = Clock::now();
+
+  m_input.update(frame_ticks);
+  m_renderer.set_draw_color(default_colors::white);
+  m_renderer.clear();
+  m_mgr.update(frame_ticks, m_input);
+  m_mgr.draw(m_renderer);
+  if (pixels) //must come before present
+    *pixels = m_renderer.read_pixels(nullptr, nullptr);
+  m_renderer.present();
+
+  std::chrono::duration<double, std::milli> time = Clock::now() - start;
+  return time.count();
+}
+
+void ViewBench::settle()
+{
+  //background work such as loading or solving runs in real time
+  auto deadline = Clock::now() + std::chrono::seconds(30);
+  while (m_mgr.time_until_update() == 0 && Clock::now() < deadline) {
+    frame();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+RgbaImage to_image(const std::vector<std::uint32_t>& pixels,
+                   int width, int height)
+{
+  RgbaImage image(width, height);
+  for (std::size_t i = 0; i < pixels.size(); ++i) {
+    image.pixels[4 * i] = pixels[i] >> 24;
+    image.pixels[4 * i + 1] = (pixels[i] >> 16) & 0xff;
+    image.pixels[4 * i + 2] = (pixels[i] >> 8) & 0xff;
+    image.pixels[4 * i + 3] = pixels[i] & 0xff;
+  }
+  return image;
+}
+
+// Count the pixels that differ, or all of them if the sizes differ
+long compare_images(const RgbaImage& a, const RgbaImage& b)
+{
+  if (a.width != b.width || a.height != b.height)
+    return static_cast<long>(a.width) * a.height;
+
+  long count = 0;
+  for (std::size_t i = 0; i < a.pixels.size(); i += 4) {
+    for (std::size_t j = i; j < i + 4; ++j) {
+      if (a.pixels[j] != b.pixels[j]) {
+        ++count;
+        break;
+      }
+    }
+  }
+  return count;
+}
+
+std::string read_file(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open())
+    throw std::runtime_error("could not open " + filename);
+  return std::string((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& filename, const std::string& data)
+{
+  std::ofstream file(filename, std::ios::binary);
+  if (!file.write(data.data(), data.size()))
+    throw std::runtime_error("could not write " + filename);
+}
+
+std::vector<Scene> make_scenes(const std::string& puzzle_file)
+{
+  typedef ViewManager::Action Action;
+  return {
+    { "menu", [](ViewManager& m) {
+        m.schedule_action(Action::open_menu); } },
+    { "files", [](ViewManager& m) {
+        m.schedule_action(Action::choose_puzzle); } },
+    { "puzzle", [puzzle_file](ViewManager& m) {
+        m.schedule_action(Action::load_puzzle, puzzle_file); } },
+    { "game_menu", [](ViewManager& m) {
+        m.schedule_action(Action::open_menu); } },
+    { "analysis", [](ViewManager& m) {
+        m.schedule_action(Action::analyze_puzzle); } },
+    { "editor", [](ViewManager& m) {
+        m.pop(); //close the analysis
+        m.schedule_action(Action::solve_and_edit); } },
+    { "properties", [](ViewManager& m) {
+        m.schedule_action(Action::edit_puzzle_data); } },
+    { "message_box", [](ViewManager& m) {
+        m.pop(); //close the properties
+        m.message_box("Nothing to see here.", MessageBoxView::Type::okay,
+                      []() { }, []() { }, []() { }); } },
+    { "victory", [](ViewManager& m) {
+        m.schedule_action(Action::show_victory_screen); } }
+  };
+}
+
+int main(int argc, char* argv[])
+{
+  int num_frames = 120;
+  std::string puzzle_file, save_dir, compare_dir;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-n" && i + 1 < argc) {
+      num_frames = std::stoi(argv[++i]);
+    } else if (arg == "-p" && i + 1 < argc) {
+      puzzle_file = argv[++i];
+    } else if (arg == "--save" && i + 1 < argc) {
+      save_dir = argv[++i];
+    } else if (arg == "--compare" && i + 1 < argc) {
+      compare_dir = argv[++i];
+    } else {
+      std::cerr << "Usage: bench_views [-n FRAMES] [-p PUZZLE] "
+                << "[--save DIR] [--compare DIR]" << std::endl;
+      return 2;
+    }
+  }
+
+  int failures = 0;
+  bool error = false;
+  stdfs::path temp_dir;
+  try {
+    temp_dir = stdfs::temp_directory_path() / "bench_views_save";
+    stdfs::remove_all(temp_dir);
+    GameSettings settings;
+    settings.set_save_dir(temp_dir.string());
+    char sep = settings.filesystem_separator();
+    if (puzzle_file.empty())
+      puzzle_file = settings.puzzle_dir() + sep + "color" + sep + "tree.non";
+
+    auto video = VideoSystem::create(VideoSystem::Mode::offscreen);
+    WindowSettings ws;
+    ws.width = screen_width;
+    ws.height = screen_height;
+    auto window = video->new_window(ws);
+    auto renderer = video->new_renderer(*window);
+    ViewBench bench(*video, *renderer, settings);
+
+    std::printf("%-16s %8s %10s %10s %12s %10s %10s\n", "view", "frames",
+                "ms/frame", "max ms", "draws/frame", "uploads", "diff px");
+    for (const auto& scene : make_scenes(puzzle_file)) {
+      scene.enter(bench.view_manager());
+      for (int i = 0; i < warmup_frames; ++i)
+        bench.frame();
+
+      SceneResult result;
+      renderer->reset_stats();
+      for (int i = 0; i < num_frames; ++i) {
+        double ms = bench.frame();
+        result.total_ms += ms;
+        if (ms > result.max_ms)
+          result.max_ms = ms;
+        ++result.frames;
+      }
+      result.draw_calls = renderer->stats().draw_calls;
+      result.texture_uploads = renderer->stats().texture_uploads;
+
+      if (!save_dir.empty() || !compare_dir.empty()) {
+        bench.settle();
+        std::vector<std::uint32_t> pixels;
+        bench.frame(&pixels);
+        RgbaImage image = to_image(pixels, screen_width, screen_height);
+        std::string name = std::string(scene.name) + ".png";
+
+        if (!save_dir.empty())
+          write_file(save_dir + sep + name, encode_png(image));
+        if (!compare_dir.empty()) {
+          std::string data = read_file(compare_dir + sep + name);
+          result.differing_pixels
+            = compare_images(image, decode_png(data.data(), data.size()));
+          if (result.differing_pixels != 0) {
+            std::cerr << "FAIL: " << scene.name
+                      << ": frame differs from saved copy" << std::endl;
+            ++failures;
+          }
+        }
+      }
+
+      int frames = result.frames > 0 ? result.frames : 1;
+      std::printf("%-16s %8d %10.3f %10.3f %12ld %10ld", scene.name,
+                  result.frames, result.total_ms / frames, result.max_ms,
+                  result.draw_calls / frames, result.texture_uploads);
+      if (result.differing_pixels >= 0)
+        std::printf(" %10ld\n", result.differing_pixels);
+      else
+        std::printf(" %10s\n", "-");
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "bench_views: " << e.what() << std::endl;
+    error = true;
+  }
+
+  std::error_code ec;
+  if (!temp_dir.empty())
+    stdfs::remove_all(temp_dir, ec);
+  if (error)
+    return 1;
+
+  if (failures > 0) {
+    std::cerr << failures << " frames differ" << std::endl;
+    return 1;
+  }
+  return 0;
+}
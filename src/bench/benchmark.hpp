@@ -0,0 +1,139 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_BENCHMARK_HPP
+#define NONNY_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+/*
+ * Minimal timing support shared by the benchmark programs. Each case
+ * is run repeatedly until a time budget has been used up, and the
+ * result is printed as a single line giving the number of iterations,
+ * the mean time per iteration, and the throughput when the number of
+ * bytes processed per iteration is known.
+ */
+namespace bench {
+  struct Result {
+    std::string name;
+    long iterations = 0;
+    double ns_per_op = 0.0;
+    double mb_per_sec = 0.0;
+  };
+
+  // Keep the optimizer from discarding a computed value
+  template <typename T>
+  inline void keep(const T& value)
+  {
+    const void* volatile address = &value;
+    (void)address;
+  }
+
+  // Time func, which processes the given number of bytes per call
+  template <typename Func>
+  Result run(const std::string& name, std::size_t bytes, Func func,
+             double min_seconds = 0.5);
+
+  // Print a result in the standard format
+  inline void report(const Result& result);
+
+  // Print the column headings
+  inline void report_header();
+
+  // Report a failed correctness check
+  inline void fail(const std::string& what);
+
+  // Number of checks that have failed so far
+  inline int num_failures();
+
+  // Counter shared by fail and num_failures
+  inline int& failure_count();
+}
+
+
+/* implementation */
+
+template <typename Func>
+bench::Result bench::run(const std::string& name, std::size_t bytes,
+                         Func func, double min_seconds)
+{
+  typedef std::chrono::steady_clock clock;
+
+  func(); //warm up caches
+
+  Result result;
+  result.name = name;
+  long batch = 1;
+  double elapsed = 0.0;
+  while (elapsed < min_seconds) {
+    auto start = clock::now();
+    for (long i = 0; i < batch; ++i)
+      func();
+    std::chrono::duration<double> time = clock::now() - start;
+
+    elapsed += time.count();
+    result.iterations += batch;
+    if (time.count() < min_seconds / 10)
+      batch *= 2;
+  }
+
+  result.ns_per_op = elapsed * 1e9 / result.iterations;
+  if (bytes > 0)
+    result.mb_per_sec = bytes * result.iterations / elapsed / 1e6;
+  return result;
+}
+
+inline void bench::report_header()
+{
+  std::printf("%-40s %12s %14s %10s\n",
+              "case", "iterations", "ns/op", "MB/s");
+}
+
+inline void bench::report(const Result& result)
+{
+  std::printf("%-40s %12ld %14.0f", result.name.c_str(),
+              result.iterations, result.ns_per_op);
+  if (result.mb_per_sec > 0.0)
+    std::printf(" %10.1f\n", result.mb_per_sec);
+  else
+    std::printf(" %10s\n", "-");
+}
+
+inline void bench::fail(const std::string& what)
+{
+  std::fprintf(stderr, "FAIL: %s\n", what.c_str());
+  ++failure_count();
+}
+
+inline int bench::num_failures()
+{
+  return failure_count();
+}
+
+inline int& bench::failure_count()
+{
+  static int count = 0;
+  return count;
+}
+
+#endif
@@ -0,0 +1,84 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Fuzzing driver for the puzzle readers. The first byte of each input
+ * selects the format and the rest is parsed as a puzzle file; see
+ * bench/parse_check.hpp for what is checked. Built with Clang, this
+ * is a libFuzzer target:
+ *
+ *   fuzz_puzzle_io [libFuzzer options] [corpus directory...]
+ *
+ * With other compilers it runs each file named on the command line
+ * once, which is useful for replaying crashes and corpus files.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include "bench/parse_check.hpp"
+#include "puzzle/puzzle_io.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data,
+                                      std::size_t size)
+{
+  //PNG decoding belongs to libpng, so only the text and binary formats
+  static const PuzzleFormat formats[] = {
+    PuzzleFormat::non, PuzzleFormat::g, PuzzleFormat::mk,
+    PuzzleFormat::nin, PuzzleFormat::nbn
+  };
+  constexpr std::size_t num_formats = sizeof(formats) / sizeof(formats[0]);
+
+  if (size == 0)
+    return 0;
+  PuzzleFormat fmt = formats[data[0] % num_formats];
+
+  std::string message;
+  if (bench::check_parse(reinterpret_cast<const char*>(data + 1), size - 1,
+                         fmt, message)
+      == bench::ParseResult::inconsistent) {
+    std::cerr << "fuzz_puzzle_io: " << message << std::endl;
+    std::abort();
+  }
+  return 0;
+}
+
+#ifdef NONNY_FUZZ_MAIN
+int main(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i) {
+    std::ifstream file(argv[i], std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "fuzz_puzzle_io: could not open " << argv[i] << std::endl;
+      return 1;
+    }
+
+    std::string input((std::istreambuf_iterator<char>(file)),
+                      std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(
+                             input.data()), input.size());
+  }
+  return 0;
+}
+#endif
@@ -0,0 +1,126 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_PARSE_CHECK_HPP
+#define NONNY_PARSE_CHECK_HPP
+
+#include <cstddef>
+#include <exception>
+#include <sstream>
+#include <string>
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "puzzle/puzzle_summary.hpp"
+
+/*
+ * Consistency checks on the puzzle readers, shared by the parser
+ * benchmark and the fuzzing driver. Any input may be rejected with an
+ * exception, but an input that is accepted must survive being written
+ * out and read back in the same format.
+ */
+namespace bench {
+  enum class ParseResult { accepted, rejected, inconsistent };
+
+  // Do two puzzles have the same dimensions and clues?
+  inline bool same_clues(const Puzzle& a, const Puzzle& b,
+                         bool compare_colors = true);
+
+  /*
+   * Check one input. On an inconsistent result, message describes the
+   * problem.
+   */
+  inline ParseResult check_parse(const char* data, std::size_t size,
+                                 PuzzleFormat fmt, std::string& message);
+}
+
+
+/* implementation */
+
+inline bool bench::same_clues(const Puzzle& a, const Puzzle& b,
+                              bool compare_colors)
+{
+  if (a.width() != b.width() || a.height() != b.height())
+    return false;
+
+  auto same_lines = [compare_colors](const Puzzle::ClueContainer& l,
+                                     const Puzzle::ClueContainer& r) {
+    if (l.size() != r.size())
+      return false;
+    for (std::size_t i = 0; i < l.size(); ++i) {
+      if (l[i].size() != r[i].size())
+        return false;
+      for (std::size_t j = 0; j < l[i].size(); ++j) {
+        if (l[i][j].value != r[i][j].value
+            || (compare_colors && l[i][j].color != r[i][j].color))
+          return false;
+      }
+    }
+    return true;
+  };
+
+  return same_lines(a.row_clues(), b.row_clues())
+    && same_lines(a.col_clues(), b.col_clues());
+}
+
+inline bench::ParseResult
+bench::check_parse(const char* data, std::size_t size, PuzzleFormat fmt,
+                   std::string& message)
+{
+  Puzzle puzzle;
+  try {
+    read_puzzle(data, size, puzzle, fmt);
+  } catch (const std::exception&) {
+    return ParseResult::rejected;
+  }
+
+  //skimming stops early, so it only has to cope with the input
+  PuzzleSummary summary;
+  try {
+    skim_puzzle(data, size, summary, fmt);
+  } catch (const std::exception&) { }
+
+  std::ostringstream ss;
+  try {
+    write_puzzle(ss, puzzle, fmt);
+  } catch (const UnsupportedFeature&) {
+    return ParseResult::accepted; //e.g. colors in a monochrome format
+  } catch (const std::exception& e) {
+    message = std::string("could not write puzzle: ") + e.what();
+    return ParseResult::inconsistent;
+  }
+
+  std::string copy = ss.str();
+  Puzzle reread;
+  try {
+    read_puzzle(copy.data(), copy.size(), reread, fmt);
+  } catch (const std::exception& e) {
+    message = std::string("could not read back written puzzle: ")
+      + e.what();
+    return ParseResult::inconsistent;
+  }
+  if (!same_clues(puzzle, reread)) {
+    message = "written puzzle reads back with different clues";
+    return ParseResult::inconsistent;
+  }
+
+  return ParseResult::accepted;
+}
+
+#endif
@@ -22,7 +22,6 @@
 
 #include <iomanip>
 #include <iostream>
-#include <sstream>
 #include "utility/utility.hpp"
 
 namespace default_colors {
@@ -77,16 +76,25 @@ std::istream& read_component(std::istream& is, int& val)
   //ignore whitespace
   while (is_space(is.peek())) is.get();
 
-  //read exactly two characters
-  char comp[3];
-  comp[0] = is.get();
-  comp[1] = is.get();
-  comp[2] = '\0';
-
-  //interpret
-  std::istringstream ss(comp);
-  ss >> std::hex >> val;
+  //read exactly two hex digits
+  int result = 0;
+  for (int i = 0; i < 2; ++i) {
+    int c = is.get();
+    int digit;
+    if (c >= '0' && c <= '9')
+      digit = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      digit = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      digit = c - 'A' + 10;
+    else {
+      is.setstate(std::ios::failbit);
+      return is;
+    }
+    result = result * 16 + digit;
+  }
 
+  val = result;
   return is;
 }
 
@@ -21,6 +21,7 @@
 #ifndef NONNY_COLOR_PALETTE_HPP
 #define NONNY_COLOR_PALETTE_HPP
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "color/color.hpp"
@@ -46,6 +47,10 @@ public:
   // Remove an existing color, throws out_of_range if not found
   void remove(const std::string& name);
 
+  // Remove every entry for which pred returns true
+  template <typename Pred>
+  void remove_if(Pred pred);
+
   // Lookup a symbol character from a color name
   inline char symbol(const std::string& name) const;
 
@@ -90,6 +95,13 @@ bool operator<(const ColorPalette::Entry& l, const ColorPalette::Entry& r);
 
 /* implementation */
 
+template <typename Pred>
+void ColorPalette::remove_if(Pred pred)
+{
+  m_colors.erase(std::remove_if(m_colors.begin(), m_colors.end(), pred),
+                 m_colors.end());
+}
+
 inline char ColorPalette::symbol(const std::string& name) const
 {
   return at(name)->symbol;
@@ -36,3 +36,32 @@ std::unique_ptr<EventHandler> EventHandler::create()
                              "event handler not implemented");
   #endif
 }
+
+bool EventHandler::process(InputHandler& input, ViewManager& view_mgr)
+{
+  m_any_events = false;
+  m_frame.ticks = get_ticks();
+  m_frame.events.clear();
+
+  poll(input, view_mgr);
+
+  //empty frames are kept too, since the time between frames affects
+  //what the views do
+  if (m_recorder)
+    m_recorder->write(m_frame);
+  return m_any_events;
+}
+
+void EventHandler::record(const std::string& filename, int width, int height)
+{
+  m_recorder = std::make_unique<EventRecordWriter>(filename, width, height);
+}
+
+void EventHandler::dispatch(const InputEvent& event,
+                            InputHandler& input, ViewManager& view_mgr)
+{
+  m_any_events = true;
+  if (m_recorder)
+    m_frame.events.push_back(event);
+  event.apply(input, view_mgr);
+}
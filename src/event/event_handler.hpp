@@ -23,6 +23,8 @@
 
 #include <cstddef>
 #include <memory>
+#include <string>
+#include "event/event_recording.hpp"
 
 class InputHandler;
 class ViewManager;
@@ -40,7 +42,44 @@ public:
   //get time in milliseconds since program started
   virtual std::size_t get_ticks() const = 0;
 
-  virtual void process(InputHandler&, ViewManager&) = 0;
+  /*
+   * Block until an event arrives or timeout milliseconds pass,
+   * without handling the event. A timeout of View::no_timeout waits
+   * indefinitely.
+   */
+  virtual void wait(unsigned timeout) = 0;
+
+  //handle all pending events, returning false if there were none
+  bool process(InputHandler& input, ViewManager& view_mgr);
+
+  /*
+   * Throw away pending events without handling them, to keep the
+   * window responsive while input comes from elsewhere. Returns true
+   * if the user asked to quit.
+   */
+  virtual bool discard_input() = 0;
+
+  // Do events and ticks come from a recording rather than real time?
+  virtual bool is_replaying() const { return false; }
+
+  /*
+   * Save the events handled in every frame from now on to a file,
+   * which ReplayEventHandler can play back. The width and height are
+   * those of the game window.
+   */
+  void record(const std::string& filename, int width, int height);
+
+protected:
+  //pass each pending event to dispatch
+  virtual void poll(InputHandler& input, ViewManager& view_mgr) = 0;
+
+  void dispatch(const InputEvent& event,
+                InputHandler& input, ViewManager& view_mgr);
+
+private:
+  std::unique_ptr<EventRecordWriter> m_recorder;
+  RecordedFrame m_frame;
+  bool m_any_events = false;
 };
 
 #endif
@@ -0,0 +1,309 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "event/event_recording.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include "input/input_handler.hpp"
+#include "utility/binary_io.hpp"
+#include "view/view_manager.hpp"
+
+/*
+ * A recording file begins with a magic number, a version, and the
+ * window width and height as varints. Each frame follows as the tick
+ * difference from the previous frame and the number of events, both
+ * varints, and then the events. An event is a type byte followed by:
+ *
+ *   resize        width, height
+ *   key           key, down byte
+ *   text          string
+ *   mouse_button  button, down byte, number of clicks
+ *   mouse_move    x, y
+ *   mouse_wheel   vertical, horizontal
+ *
+ * Positions and scroll amounts can be negative and are zigzag encoded;
+ * everything else is an unsigned varint.
+ */
+
+namespace {
+  const char record_magic[4] = { 'N', 'I', 'R', '\x1a' };
+  constexpr unsigned record_version = 1;
+
+  void put_signed(std::string& buf, int value)
+  {
+    std::int64_t v = value;
+    put_varint(buf, static_cast<std::uint64_t>((v << 1) ^ (v >> 63)));
+  }
+
+  int get_signed(ByteReader& reader)
+  {
+    std::uint64_t v = reader.varint();
+    return static_cast<int>(static_cast<std::int64_t>(v >> 1)
+                            ^ -static_cast<std::int64_t>(v & 1));
+  }
+
+  // Read a varint that must be less than limit
+  int get_bounded(ByteReader& reader, std::uint64_t limit)
+  {
+    std::uint64_t value = reader.varint();
+    if (value >= limit)
+      throw std::runtime_error("read_event_recording: "
+                               "value out of range");
+    return static_cast<int>(value);
+  }
+
+  InputEvent read_event(ByteReader& reader)
+  {
+    switch (reader.u8()) {
+    case static_cast<unsigned>(InputEvent::Type::quit):
+      return InputEvent::quit_event();
+    case static_cast<unsigned>(InputEvent::Type::resize):
+      {
+        int width = get_bounded(reader, 1 << 16);
+        int height = get_bounded(reader, 1 << 16);
+        return InputEvent::resize_event(width, height);
+      }
+    case static_cast<unsigned>(InputEvent::Type::key):
+      {
+        int key = get_bounded(reader, Keyboard::num_keys);
+        bool down = reader.u8() != 0;
+        return InputEvent::key_event(static_cast<Keyboard::Key>(key), down);
+      }
+    case static_cast<unsigned>(InputEvent::Type::text):
+      return InputEvent::text_event(reader.string());
+    case static_cast<unsigned>(InputEvent::Type::mouse_button):
+      {
+        int button = get_bounded(reader, Mouse::num_buttons);
+        bool down = reader.u8() != 0;
+        int clicks = get_bounded(reader, 256);
+        return InputEvent::button_event(static_cast<Mouse::Button>(button),
+                                        down, clicks);
+      }
+    case static_cast<unsigned>(InputEvent::Type::mouse_move):
+      {
+        int x = get_signed(reader);
+        int y = get_signed(reader);
+        return InputEvent::move_event(x, y);
+      }
+    case static_cast<unsigned>(InputEvent::Type::mouse_wheel):
+      {
+        int vert = get_signed(reader);
+        int horiz = get_signed(reader);
+        return InputEvent::wheel_event(vert, horiz);
+      }
+    default:
+      throw std::runtime_error("read_event_recording: "
+                               "unknown event type");
+    }
+  }
+}
+
+InputEvent InputEvent::quit_event()
+{
+  return InputEvent();
+}
+
+InputEvent InputEvent::resize_event(int width, int height)
+{
+  InputEvent event;
+  event.type = Type::resize;
+  event.x = width;
+  event.y = height;
+  return event;
+}
+
+InputEvent InputEvent::key_event(Keyboard::Key key, bool down)
+{
+  InputEvent event;
+  event.type = Type::key;
+  event.code = key;
+  event.down = down;
+  return event;
+}
+
+InputEvent InputEvent::text_event(const std::string& text)
+{
+  InputEvent event;
+  event.type = Type::text;
+  event.text = text;
+  return event;
+}
+
+InputEvent InputEvent::button_event(Mouse::Button button, bool down,
+                                    int num_clicks)
+{
+  InputEvent event;
+  event.type = Type::mouse_button;
+  event.code = button;
+  event.down = down;
+  event.num_clicks = num_clicks;
+  return event;
+}
+
+InputEvent InputEvent::move_event(int x, int y)
+{
+  InputEvent event;
+  event.type = Type::mouse_move;
+  event.x = x;
+  event.y = y;
+  return event;
+}
+
+InputEvent InputEvent::wheel_event(int vert, int horiz)
+{
+  InputEvent event;
+  event.type = Type::mouse_wheel;
+  event.x = vert;
+  event.y = horiz;
+  return event;
+}
+
+void InputEvent::apply(InputHandler& input, ViewManager& view_mgr) const
+{
+  switch (type) {
+  case Type::quit:
+    view_mgr.schedule_action(ViewManager::Action::quit_game);
+    break;
+  case Type::resize:
+    view_mgr.resize(x, y);
+    break;
+  case Type::key:
+    input.process_key_event(static_cast<Keyboard::Key>(code), down);
+    break;
+  case Type::text:
+    input.process_text_input_event(text);
+    break;
+  case Type::mouse_button:
+    input.process_mouse_button_event(static_cast<Mouse::Button>(code),
+                                     down, num_clicks);
+    break;
+  case Type::mouse_move:
+    input.process_mouse_move_event(x, y);
+    break;
+  case Type::mouse_wheel:
+    input.process_mouse_wheel_event(x, y);
+    break;
+  }
+}
+
+EventRecordWriter::EventRecordWriter(const std::string& filename,
+                                     int width, int height)
+  : m_file(filename, std::ios::binary)
+{
+  if (!m_file.is_open())
+    throw std::runtime_error("EventRecordWriter::EventRecordWriter: "
+                             "could not open " + filename);
+
+  m_buffer.assign(record_magic, sizeof(record_magic));
+  put_u8(m_buffer, record_version);
+  put_varint(m_buffer, width);
+  put_varint(m_buffer, height);
+  m_file.write(m_buffer.data(), m_buffer.size());
+}
+
+void EventRecordWriter::write(const RecordedFrame& frame)
+{
+  m_buffer.clear();
+  std::size_t delta = frame.ticks >= m_prev_ticks
+    ? frame.ticks - m_prev_ticks : 0;
+  m_prev_ticks = frame.ticks;
+  put_varint(m_buffer, delta);
+  put_varint(m_buffer, frame.events.size());
+
+  for (const auto& event : frame.events) {
+    put_u8(m_buffer, static_cast<unsigned>(event.type));
+    switch (event.type) {
+    case InputEvent::Type::quit:
+      break;
+    case InputEvent::Type::resize:
+      put_varint(m_buffer, event.x);
+      put_varint(m_buffer, event.y);
+      break;
+    case InputEvent::Type::key:
+      put_varint(m_buffer, event.code);
+      put_u8(m_buffer, event.down);
+      break;
+    case InputEvent::Type::text:
+      put_string(m_buffer, event.text);
+      break;
+    case InputEvent::Type::mouse_button:
+      put_varint(m_buffer, event.code);
+      put_u8(m_buffer, event.down);
+      put_varint(m_buffer, event.num_clicks);
+      break;
+    case InputEvent::Type::mouse_move:
+    case InputEvent::Type::mouse_wheel:
+      put_signed(m_buffer, event.x);
+      put_signed(m_buffer, event.y);
+      break;
+    }
+  }
+
+  if (!m_file.write(m_buffer.data(), m_buffer.size()))
+    throw std::runtime_error("EventRecordWriter::write: "
+                             "could not write recording");
+}
+
+EventRecording read_event_recording(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open())
+    throw std::runtime_error("read_event_recording: could not open "
+                             + filename);
+  std::string data((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+
+  EventRecording recording;
+  ByteReader reader(data.data(), data.data() + data.size());
+  try {
+    if (std::memcmp(reader.bytes(sizeof(record_magic)), record_magic,
+                    sizeof(record_magic)) != 0
+        || reader.u8() != record_version)
+      throw std::runtime_error("read_event_recording: "
+                               "not a recording: " + filename);
+    recording.width = get_bounded(reader, 1 << 16);
+    recording.height = get_bounded(reader, 1 << 16);
+  } catch (const std::out_of_range&) {
+    throw std::runtime_error("read_event_recording: "
+                             "not a recording: " + filename);
+  }
+
+  //a game that crashed may have left the last frame unfinished, which
+  //is dropped so that the rest can still be replayed
+  std::size_t ticks = 0;
+  try {
+    while (reader.remaining() > 0) {
+      RecordedFrame frame;
+      ticks += reader.varint();
+      frame.ticks = ticks;
+
+      std::uint64_t num_events = reader.varint();
+      for (std::uint64_t i = 0; i < num_events; ++i)
+        frame.events.push_back(read_event(reader));
+      recording.frames.push_back(std::move(frame));
+    }
+  } catch (const std::out_of_range&) { }
+
+  return recording;
+}
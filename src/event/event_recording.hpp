@@ -0,0 +1,102 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_EVENT_RECORDING_HPP
+#define NONNY_EVENT_RECORDING_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "input/key.hpp"
+
+class InputHandler;
+class ViewManager;
+
+/*
+ * An input event in a form independent of the input backend, so that
+ * a play session can be recorded and replayed exactly.
+ */
+struct InputEvent {
+  enum class Type { quit, resize, key, text, mouse_button, mouse_move,
+      mouse_wheel };
+
+  static InputEvent quit_event();
+  static InputEvent resize_event(int width, int height);
+  static InputEvent key_event(Keyboard::Key key, bool down);
+  static InputEvent text_event(const std::string& text);
+  static InputEvent button_event(Mouse::Button button, bool down,
+                                 int num_clicks);
+  static InputEvent move_event(int x, int y);
+  static InputEvent wheel_event(int vert, int horiz);
+
+  // Pass the event on to the input handler or view manager
+  void apply(InputHandler& input, ViewManager& view_mgr) const;
+
+  Type type = Type::quit;
+  int x = 0; //width, mouse position or vertical scroll
+  int y = 0; //height, mouse position or horizontal scroll
+  int code = 0; //key or mouse button
+  bool down = false;
+  int num_clicks = 0;
+  std::string text;
+};
+
+// The events handled in one frame, and the tick count when it began
+struct RecordedFrame {
+  std::size_t ticks = 0;
+  std::vector<InputEvent> events;
+};
+
+// A recorded session, starting with the size of the game window
+struct EventRecording {
+  int width = 0;
+  int height = 0;
+  std::vector<RecordedFrame> frames;
+};
+
+/*
+ * Writes frames to a recording file as they happen. Frames are stored
+ * in a compact binary form, with the ticks as the difference from the
+ * previous frame, so that a long session stays small. Throws
+ * std::runtime_error if the file cannot be written.
+ */
+class EventRecordWriter {
+public:
+  EventRecordWriter(const std::string& filename, int width, int height);
+
+  EventRecordWriter(const EventRecordWriter&) = delete;
+  EventRecordWriter& operator=(const EventRecordWriter&) = delete;
+
+  void write(const RecordedFrame& frame);
+
+private:
+  std::ofstream m_file;
+  std::size_t m_prev_ticks = 0;
+  std::string m_buffer;
+};
+
+/*
+ * Read a file written by EventRecordWriter. Throws std::runtime_error
+ * if the file cannot be read or is not a valid recording.
+ */
+EventRecording read_event_recording(const std::string& filename);
+
+#endif
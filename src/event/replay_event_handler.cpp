@@ -0,0 +1,64 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "event/replay_event_handler.hpp"
+
+#include <utility>
+#include "view/view_manager.hpp"
+
+ReplayEventHandler::ReplayEventHandler(const std::string& filename,
+                                       std::unique_ptr<EventHandler> live)
+  : m_recording(read_event_recording(filename)),
+    m_live(std::move(live))
+{
+}
+
+std::size_t ReplayEventHandler::get_ticks() const
+{
+  const auto& frames = m_recording.frames;
+  if (frames.empty())
+    return 0;
+  if (m_next_frame < frames.size())
+    return frames[m_next_frame].ticks;
+  return frames.back().ticks;
+}
+
+bool ReplayEventHandler::discard_input()
+{
+  return m_live && m_live->discard_input();
+}
+
+void ReplayEventHandler::poll(InputHandler& input, ViewManager& view_mgr)
+{
+  if (discard_input() || m_next_frame >= m_recording.frames.size()) {
+    view_mgr.schedule_action(ViewManager::Action::force_quit);
+    return;
+  }
+
+  //lay the views out as they were, whatever the size of this window
+  if (m_next_frame == 0)
+    dispatch(InputEvent::resize_event(m_recording.width,
+                                      m_recording.height),
+             input, view_mgr);
+
+  for (const auto& event : m_recording.frames[m_next_frame].events)
+    dispatch(event, input, view_mgr);
+  ++m_next_frame;
+}
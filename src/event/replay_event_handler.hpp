@@ -0,0 +1,69 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_REPLAY_EVENT_HANDLER_HPP
+#define NONNY_REPLAY_EVENT_HANDLER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "event/event_handler.hpp"
+#include "event/event_recording.hpp"
+
+/*
+ * Plays back a session saved with EventHandler::record. Each call to
+ * process handles the events of the next recorded frame, and the tick
+ * count is the one recorded for that frame, so the game sees the same
+ * input at the same times on every run no matter how long frames
+ * really take. Nothing ever waits. Once the recording runs out, or if
+ * the user closes the window, the game quits without saving.
+ *
+ * Events for the real window go to the live handler, if one is given,
+ * and are thrown away.
+ *
+ * Replays are only deterministic for views driven by input and time
+ * alone. Work done on background threads, such as the puzzle details
+ * loaded by the file browser's PuzzleInfoLoader, finishes on whatever
+ * frame it happens to, so what such a view shows (and where clicks
+ * land when its layout depends on those results) can differ from the
+ * recorded session and from one replay to the next.
+ */
+class ReplayEventHandler : public EventHandler {
+public:
+  ReplayEventHandler(const std::string& filename,
+                     std::unique_ptr<EventHandler> live = nullptr);
+
+  std::size_t get_ticks() const override;
+  void wait(unsigned) override { }
+  bool discard_input() override;
+  bool is_replaying() const override { return true; }
+
+  std::size_t num_frames() const { return m_recording.frames.size(); }
+
+protected:
+  void poll(InputHandler& input, ViewManager& view_mgr) override;
+
+private:
+  EventRecording m_recording;
+  std::size_t m_next_frame = 0;
+  std::unique_ptr<EventHandler> m_live;
+};
+
+#endif
@@ -20,21 +20,43 @@
 
 #include "event/sdl/sdl_event_handler.hpp"
 
-#include "input/input_handler.hpp"
-#include "view/view_manager.hpp"
+#include <climits>
+#include "view/view.hpp"
 
-void SDLEventHandler::process(InputHandler& input, ViewManager& view_mgr)
+void SDLEventHandler::wait(unsigned timeout)
+{
+  //a null event leaves the event in the queue for process
+  if (timeout == View::no_timeout || timeout > INT_MAX)
+    SDL_WaitEvent(NULL);
+  else if (timeout > 0)
+    SDL_WaitEventTimeout(NULL, timeout);
+}
+
+bool SDLEventHandler::discard_input()
+{
+  bool quit = false;
+  SDL_Event event;
+  while (SDL_PollEvent(&event)) {
+    if (event.type == SDL_QUIT)
+      quit = true;
+  }
+  return quit;
+}
+
+void SDLEventHandler::poll(InputHandler& input, ViewManager& view_mgr)
 {
   SDL_Event event;
   while (SDL_PollEvent(&event)) {
     switch (event.type) {
     case SDL_QUIT:
-      view_mgr.schedule_action(ViewManager::Action::quit_game);
+      dispatch(InputEvent::quit_event(), input, view_mgr);
       break;
     case SDL_WINDOWEVENT:
       switch (event.window.event) {
       case SDL_WINDOWEVENT_RESIZED:
-        view_mgr.resize(event.window.data1, event.window.data2);
+        dispatch(InputEvent::resize_event(event.window.data1,
+                                          event.window.data2),
+                 input, view_mgr);
         break;
       }
       break;
@@ -43,11 +65,11 @@ void SDLEventHandler::process(InputHandler& input, ViewManager& view_mgr)
       {
         Keyboard::Key key = convert_keycode(event.key.keysym.scancode);
         bool down = (event.type == SDL_KEYDOWN);
-        input.process_key_event(key, down);
+        dispatch(InputEvent::key_event(key, down), input, view_mgr);
       }
       break;
     case SDL_TEXTINPUT:
-      input.process_text_input_event(event.text.text);
+      dispatch(InputEvent::text_event(event.text.text), input, view_mgr);
       break;
     case SDL_MOUSEBUTTONDOWN:
     case SDL_MOUSEBUTTONUP:
@@ -55,11 +77,13 @@ void SDLEventHandler::process(InputHandler& input, ViewManager& view_mgr)
         Mouse::Button button = convert_mouse_button(event.button.button);
         bool down = (event.type == SDL_MOUSEBUTTONDOWN);
         unsigned num_clicks = event.button.clicks;
-        input.process_mouse_button_event(button, down, num_clicks);
+        dispatch(InputEvent::button_event(button, down, num_clicks),
+                 input, view_mgr);
       }
       break;
     case SDL_MOUSEMOTION:
-      input.process_mouse_move_event(event.motion.x, event.motion.y);
+      dispatch(InputEvent::move_event(event.motion.x, event.motion.y),
+               input, view_mgr);
       break;
     case SDL_MOUSEWHEEL:
       {
@@ -69,7 +93,7 @@ void SDLEventHandler::process(InputHandler& input, ViewManager& view_mgr)
           vert = -vert;
           horiz = -horiz;
         }
-        input.process_mouse_wheel_event(vert, horiz);
+        dispatch(InputEvent::wheel_event(vert, horiz), input, view_mgr);
       }
       break;
     }
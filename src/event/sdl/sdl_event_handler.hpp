@@ -37,7 +37,11 @@ public:
 
   std::size_t get_ticks() const { return SDL_GetTicks(); }
 
-  void process(InputHandler& input, ViewManager& view_mgr) override;
+  void wait(unsigned timeout) override;
+  bool discard_input() override;
+
+protected:
+  void poll(InputHandler& input, ViewManager& view_mgr) override;
 
 private:
   static Keyboard::Key convert_keycode(SDL_Scancode key);
@@ -137,6 +137,19 @@ bool InputHandler::is_alt_down() const
     || is_key_down(Keyboard::Key::ralt);
 }
 
+bool InputHandler::is_any_button_down() const
+{
+  for (bool down : m_keys) {
+    if (down)
+      return true;
+  }
+  for (bool down : m_buttons) {
+    if (down)
+      return true;
+  }
+  return false;
+}
+
 bool InputHandler::was_mouse_button_pressed(Mouse::Button button) const
 {
   return !m_prev_buttons[button] && m_buttons[button];
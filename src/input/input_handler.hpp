@@ -66,6 +66,9 @@ public:
   virtual bool is_shift_down() const;
   virtual bool is_alt_down() const;
 
+  // Is any key or mouse button being held down?
+  virtual bool is_any_button_down() const;
+
   std::string chars_entered() const { return m_characters; }
 
   virtual bool was_mouse_button_pressed(Mouse::Button button) const;
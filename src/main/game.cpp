@@ -20,18 +20,32 @@
 
 #include "main/game.hpp"
 
+#include <chrono>
 #include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
 #include "config.h"
 #include "color/color.hpp"
 #include "event/event_handler.hpp"
+#include "event/replay_event_handler.hpp"
 #include "input/input_handler.hpp"
 #include "settings/game_settings.hpp"
+#include "utility/trace.hpp"
 #include "video/font.hpp"
 #include "view/menu_view.hpp"
 #include "view/puzzle_view.hpp"
 
+//frames drawn after input before the game may sleep, since some views
+//finish handling input on the following update
+constexpr int settle_frames = 2;
+
 Game::Game(int argc, char* argv[])
 {
+  parse_arguments(argc, argv);
+
   m_video = VideoSystem::create();
 
   WindowSettings ws;
@@ -46,6 +60,7 @@ Game::Game(int argc, char* argv[])
                                              m_settings,
                                              m_window->width(),
                                              m_window->height());
+  m_view_mgr->preload_assets();
   m_view_mgr->schedule_action(ViewManager::Action::open_menu);
 }
 
@@ -53,28 +68,112 @@ void Game::run()
 {
   std::unique_ptr<InputHandler> input = InputHandler::create();
   std::unique_ptr<EventHandler> event = EventHandler::create();
+  if (!m_replay_file.empty())
+    event = std::make_unique<ReplayEventHandler>(m_replay_file,
+                                                 std::move(event));
+  else if (!m_record_file.empty())
+    event->record(m_record_file, m_view_mgr->width(), m_view_mgr->height());
+
+  //without vsync, nothing else keeps the game from drawing flat out,
+  //but a replay should run as fast as it can
+  unsigned min_frame_time = 0;
+  int max_fps = m_settings.max_frame_rate();
+  if (max_fps > 0 && !m_renderer->is_vsync_enabled()
+      && !event->is_replaying())
+    min_frame_time = 1000 / max_fps;
+
+  FrameProfiler& profiler = m_view_mgr->profiler();
+  if (!m_profile_file.empty())
+    profiler.export_to(m_profile_file);
 
   bool exit = false;
   std::size_t prev_ticks = event->get_ticks();
   std::size_t ticks = prev_ticks;
   unsigned elapsed = 0;
+  int idle_frames = 0;
   while (!exit) {
+    //when nothing is moving, sleep until there is input or a view has
+    //something new to show
+    if (idle_frames >= settle_frames && !input->is_any_button_down())
+      event->wait(m_view_mgr->time_until_update());
+
+    NONNY_TRACE_SCOPE("Game::frame");
+    profiler.begin_frame(m_renderer->stats());
     ticks = event->get_ticks();
     elapsed = ticks - prev_ticks;
     prev_ticks = ticks;
 
     input->update(elapsed);
 
-    event->process(*input, *m_view_mgr);
+    if (event->process(*input, *m_view_mgr))
+      idle_frames = 0;
+    else if (idle_frames < settle_frames)
+      ++idle_frames;
+    profiler.end_stage(FrameProfiler::Stage::events);
+
+    m_view_mgr->update(elapsed, *input);
+    profiler.end_stage(FrameProfiler::Stage::update);
 
     m_renderer->set_draw_color(default_colors::white);
     m_renderer->clear();
-
-    m_view_mgr->update(elapsed, *input);
     m_view_mgr->draw(*m_renderer);
+    profiler.end_stage(FrameProfiler::Stage::draw);
 
     m_renderer->present();
+    profiler.end_stage(FrameProfiler::Stage::present);
+    profiler.end_frame(m_renderer->stats(), m_view_mgr->num_lines_solved());
+
+    if (min_frame_time > 0) {
+      unsigned frame_time = event->get_ticks() - ticks;
+      if (frame_time < min_frame_time)
+        std::this_thread::sleep_for(std::chrono::milliseconds(
+                                      min_frame_time - frame_time));
+    }
 
     exit = m_view_mgr->empty();
   }
+
+  //replays report how long the views took, to compare builds
+  long num_frames = profiler.num_frames();
+  if (event->is_replaying() && num_frames > 0) {
+    const FrameProfiler::Frame& totals = profiler.totals();
+    std::printf("Replayed %ld frames: update %.3f ms, draw %.3f ms "
+                "per frame, worst frame %.3f ms\n", num_frames,
+                totals.time_ms(FrameProfiler::Stage::update) / num_frames,
+                totals.time_ms(FrameProfiler::Stage::draw) / num_frames,
+                profiler.worst_frame_ms());
+  }
+
+  trace::dump();
+}
+
+void Game::parse_arguments(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--max-fps" && i + 1 < argc) {
+      int fps = -1;
+      try {
+        fps = std::stoi(argv[++i]);
+      } catch (const std::exception&) { }
+      if (fps < 0)
+        throw std::invalid_argument("Game::parse_arguments: "
+                                    "invalid frame rate: "
+                                    + std::string(argv[i]));
+      m_settings.set_max_frame_rate(fps);
+    } else if (arg == "--record" && i + 1 < argc) {
+      m_record_file = argv[++i];
+    } else if (arg == "--replay" && i + 1 < argc) {
+      m_replay_file = argv[++i];
+    } else if (arg == "--profile" && i + 1 < argc) {
+      m_profile_file = argv[++i];
+    } else if (arg == "--trace" && i + 1 < argc) {
+#ifdef NONNY_TRACE
+      trace::set_output_file(argv[++i]);
+#else
+      std::fprintf(stderr, "Warning: ignoring --trace %s: tracing is only "
+                   "available when built with NONNY_TRACE\n", argv[++i]);
+#endif
+    }
+  }
 }
@@ -22,6 +22,7 @@
 #define NONNY_GAME_HPP
 
 #include <memory>
+#include <string>
 #include "settings/game_settings.hpp"
 #include "video/renderer.hpp"
 #include "video/video_system.hpp"
@@ -37,12 +38,21 @@ public:
 
   void run();
 private:
+  /*
+   * Recognizes --max-fps N, --record FILE, --replay FILE,
+   * --profile FILE and --trace FILE; other arguments are ignored
+   */
+  void parse_arguments(int argc, char* argv[]);
+
   bool m_exit;
   std::unique_ptr<VideoSystem> m_video;
   std::unique_ptr<Window> m_window;
   std::unique_ptr<Renderer> m_renderer;
   std::unique_ptr<ViewManager> m_view_mgr;
   GameSettings m_settings;
+  std::string m_record_file;
+  std::string m_replay_file;
+  std::string m_profile_file;
 };
 
 #endif
@@ -66,6 +66,7 @@ void Puzzle::mark_cell(int col, int row, const Color& color)
 
   m_rows_changed.insert(row);
   m_cols_changed.insert(col);
+  ++m_grid_revision;
 }
 
 void Puzzle::clear_cell(int col, int row)
@@ -74,6 +75,7 @@ void Puzzle::clear_cell(int col, int row)
 
   m_rows_changed.insert(row);
   m_cols_changed.insert(col);
+  ++m_grid_revision;
 }
 
 void Puzzle::cross_out_cell(int col, int row)
@@ -82,6 +84,7 @@ void Puzzle::cross_out_cell(int col, int row)
 
   m_rows_changed.insert(row);
   m_cols_changed.insert(col);
+  ++m_grid_revision;
 }
 
 void Puzzle::clear_all_cells()
@@ -97,6 +100,7 @@ void Puzzle::refresh_all_cells()
     m_cols_changed.insert(i);
   for (int j = 0; j < m_grid.height(); ++j)
     m_rows_changed.insert(j);
+  ++m_grid_revision;
 }
 
 void Puzzle::shift_cells(int x, int y)
@@ -191,6 +195,10 @@ bool Puzzle::is_clear() const
 
 void Puzzle::update(bool edit_mode)
 {
+  //edits may change the clues, leaving a stored solution out of date
+  if (edit_mode)
+    m_solution = PuzzleGrid();
+
   //make sure clue entries exist
   if (m_row_clues.empty())
     m_row_clues = ClueContainer(height(), ClueSequence());
@@ -216,24 +224,32 @@ void Puzzle::reset_palette()
   m_palette = ColorPalette::default_palette();
 }
 
-void Puzzle::purge_unused_colors()
+ColorPalette Puzzle::used_palette() const
 {
-  std::set<Color> used_colors;
-  for (auto clues : m_row_clues)
-    for (auto clue : clues)
-      used_colors.insert(clue.color);
-
-  //erase the unused colors
-  auto it = m_palette.begin();
-  while (it != m_palette.end()) {
-    if (it->name != "background"
-        && used_colors.find(it->color) == used_colors.end()) {
-      m_palette.remove(it->name);
-      it = m_palette.begin();
-    } else {
-      ++it;
+  //puzzles rarely use more than a few colors; the columns are checked
+  //too in case a damaged file gives them colors the rows lack
+  std::vector<Color> used_colors;
+  for (const auto* container : { &m_row_clues, &m_col_clues }) {
+    for (const auto& clues : *container) {
+      for (const auto& clue : clues) {
+        if (std::find(used_colors.begin(), used_colors.end(), clue.color)
+            == used_colors.end())
+          used_colors.push_back(clue.color);
+      }
     }
   }
+
+  ColorPalette palette = m_palette;
+  palette.remove_if([&used_colors](const ColorPalette::Entry& e) {
+      return e.name != "background"
+        && std::find(used_colors.begin(), used_colors.end(), e.color)
+        == used_colors.end(); });
+  return palette;
+}
+
+void Puzzle::purge_unused_colors()
+{
+  m_palette = used_palette();
 }
 
 void Puzzle::set_property(const std::string& property,
@@ -21,6 +21,7 @@
 #ifndef NONNY_PUZZLE_HPP
 #define NONNY_PUZZLE_HPP
 
+#include <cstddef>
 #include <iosfwd>
 #include <map>
 #include <set>
@@ -38,10 +39,8 @@
  * Class that represents a nonogram puzzle.
  */
 class Puzzle {
-  friend std::ostream& write_puzzle(std::ostream&, Puzzle,
-                                    PuzzleFormat fmt);
-  friend std::istream& read_puzzle(std::istream&, Puzzle&,
-                                   PuzzleFormat fmt);
+  friend void read_puzzle(const char*, std::size_t, Puzzle&,
+                          PuzzleFormat fmt);
 
 public:
   typedef std::map<std::string, std::string> Properties;
@@ -66,6 +65,20 @@ public:
 
   ConstPuzzleLine operator[](int col) const;
   inline const PuzzleCell& at(int col, int row) const;
+  const PuzzleGrid& grid() const { return m_grid; }
+
+  /*
+   * Solution that came with the puzzle file, or an empty grid if the
+   * file had none. It is kept apart from the play grid and is dropped
+   * once the puzzle is edited.
+   */
+  const PuzzleGrid& solution() const { return m_solution; }
+
+  /*
+   * A number that changes whenever any cell of the grid changes, for
+   * caching things drawn from the grid
+   */
+  unsigned grid_revision() const { return m_grid_revision; }
 
   void mark_cell(int col, int row, const Color& color = Color());
   void clear_cell(int col, int row);
@@ -100,6 +113,9 @@ public:
   // Restore the default color palette
   void reset_palette();
 
+  // Get a copy of the palette without the colors no clue uses
+  ColorPalette used_palette() const;
+
   // Get rid of palette colors that aren't being used
   void purge_unused_colors();
 
@@ -113,6 +129,8 @@ public:
   const std::string&
   property(const std::string& p) const { return m_properties.at(p); }
 
+  const Properties& properties() const { return m_properties; }
+
   const ClueContainer& row_clues() const { return m_row_clues; }
   const ClueContainer& col_clues() const { return m_col_clues; }
   inline const ClueSequence& row_clues(int row) const;
@@ -128,6 +146,7 @@ private:
   void update_line(int index, LineType type, bool edit_mode);
 
   PuzzleGrid m_grid;
+  PuzzleGrid m_solution;
   ClueContainer m_row_clues;
   ClueContainer m_col_clues;
   ColorPalette m_palette;
@@ -136,6 +155,7 @@ private:
   std::set<int> m_cols_changed;
   std::set<int> m_rows_solved;
   std::set<int> m_cols_solved;
+  unsigned m_grid_revision = 0;
 };
 
 // Reads and writes puzzles in the .non format
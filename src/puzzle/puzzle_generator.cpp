@@ -0,0 +1,243 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "puzzle/puzzle_generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include "puzzle/puzzle_cell.hpp"
+#include "solver/solver.hpp"
+
+namespace {
+  //foreground colors, in the order they are added to the palette
+  const char* const color_names[] = {
+    "red", "blue", "green", "yellow", "orange", "purple", "teal",
+    "maroon", "navy", "olive", "fuchsia", "aqua", "lime", "gray", "silver"
+  };
+  constexpr int max_colors = 1 + sizeof(color_names) / sizeof(color_names[0]);
+
+  //a candidate whose line solution leaves more than this fraction of
+  //the cells unknown is ambiguous nearly everywhere; searching it is
+  //slow and repairing one cell at a time rarely helps, so it is dropped
+  constexpr double max_unresolved = 0.125;
+}
+
+PuzzleGenerator::PuzzleGenerator(const GeneratorOptions& options,
+                                 unsigned seed)
+  : m_options(options), m_rng(seed)
+{
+  if (options.width <= 0 || options.height <= 0)
+    throw std::invalid_argument("PuzzleGenerator::PuzzleGenerator: "
+                                "invalid puzzle size");
+  if (options.density <= 0.0 || options.density >= 1.0)
+    throw std::invalid_argument("PuzzleGenerator::PuzzleGenerator: "
+                                "density must be between 0 and 1");
+  if (options.num_colors < 1 || options.num_colors > max_colors)
+    throw std::invalid_argument("PuzzleGenerator::PuzzleGenerator: "
+                                "between 1 and "
+                                + std::to_string(max_colors)
+                                + " colors are supported");
+
+  m_colors.push_back(m_palette["black"]);
+  ColorPalette defaults = ColorPalette::default_palette();
+  for (int i = 1; i < options.num_colors; ++i) {
+    std::string name = color_names[i - 1];
+    m_palette.add(defaults[name], name, defaults.symbol(name));
+    m_colors.push_back(defaults[name]);
+  }
+}
+
+Puzzle PuzzleGenerator::operator()()
+{
+  Puzzle puzzle(m_options.width, m_options.height, m_palette);
+  std::vector<int> unresolved;
+  while (true) {
+    if (m_options.noise_scale > 0)
+      fill_noise(puzzle);
+    else
+      fill_random(puzzle);
+    puzzle.update(true);
+    ++m_num_candidates;
+
+    for (int i = 0; ; ++i) {
+      if (check(puzzle, unresolved))
+        return puzzle;
+      if (i == m_options.max_repairs || too_ambiguous(unresolved))
+        break;
+      repair(puzzle, unresolved);
+      ++m_num_repairs;
+    }
+  }
+}
+
+void PuzzleGenerator::fill_random(Puzzle& puzzle)
+{
+  std::bernoulli_distribution filled(m_options.density);
+  for (int y = 0; y < puzzle.height(); ++y) {
+    for (int x = 0; x < puzzle.width(); ++x) {
+      if (filled(m_rng))
+        puzzle.mark_cell(x, y, random_color());
+      else
+        puzzle.clear_cell(x, y);
+    }
+  }
+}
+
+void PuzzleGenerator::fill_noise(Puzzle& puzzle)
+{
+  int width = puzzle.width(), height = puzzle.height();
+  std::vector<double> shape = make_noise(width, height);
+  std::vector<double> shade;
+  if (m_colors.size() > 1)
+    shade = make_noise(width, height);
+
+  //fill the cells with the highest values, so the density is exact
+  std::vector<double> sorted = shape;
+  std::size_t num_blank = static_cast<std::size_t>(
+    (1.0 - m_options.density) * sorted.size());
+  num_blank = std::min(num_blank, sorted.size() - 1);
+  std::nth_element(sorted.begin(), sorted.begin() + num_blank,
+                   sorted.end());
+  double threshold = sorted[num_blank];
+
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      int index = y * width + x;
+      if (shape[index] < threshold) {
+        puzzle.clear_cell(x, y);
+      } else if (shade.empty()) {
+        puzzle.mark_cell(x, y, m_colors[0]);
+      } else {
+        std::size_t c = static_cast<std::size_t>(shade[index]
+                                                 * m_colors.size());
+        puzzle.mark_cell(x, y, m_colors[std::min(c, m_colors.size() - 1)]);
+      }
+    }
+  }
+}
+
+std::vector<double> PuzzleGenerator::make_noise(int width, int height)
+{
+  //random values on a coarse lattice, interpolated between the points;
+  //with the offset below, a cell can lie up to scale - 1 cells further
+  //along, and each needs the lattice point after its own
+  int scale = m_options.noise_scale;
+  int lattice_width = (width + scale - 1) / scale + 2;
+  int lattice_height = (height + scale - 1) / scale + 2;
+  std::uniform_real_distribution<double> value(0.0, 1.0);
+  std::vector<double> lattice(lattice_width * lattice_height);
+  for (auto& v : lattice)
+    v = value(m_rng);
+
+  //a random offset keeps the lattice points from lining up with the
+  //same cells every time
+  std::uniform_int_distribution<int> offset(0, scale - 1);
+  int x_offset = offset(m_rng), y_offset = offset(m_rng);
+
+  auto smooth = [](double t) { return t * t * (3.0 - 2.0 * t); };
+  std::vector<double> noise(width * height);
+  for (int y = 0; y < height; ++y) {
+    int ly = (y + y_offset) / scale;
+    double ty = smooth(static_cast<double>((y + y_offset) % scale) / scale);
+    for (int x = 0; x < width; ++x) {
+      int lx = (x + x_offset) / scale;
+      double tx = smooth(static_cast<double>((x + x_offset) % scale)
+                         / scale);
+
+      const double* row = &lattice[ly * lattice_width + lx];
+      double top = row[0] + tx * (row[1] - row[0]);
+      row += lattice_width;
+      double bottom = row[0] + tx * (row[1] - row[0]);
+      noise[y * width + x] = top + ty * (bottom - top);
+    }
+  }
+  return noise;
+}
+
+bool PuzzleGenerator::check(const Puzzle& puzzle,
+                            std::vector<int>& unresolved)
+{
+  Puzzle copy = puzzle;
+  copy.clear_all_cells();
+  Solver solver(copy);
+
+  //line solve until the solver has to guess
+  bool finished = false;
+  while (!finished && solver.num_guesses() == 0)
+    finished = solver.step();
+  if (solver.is_line_solvable())
+    return true;
+
+  //the cells still unknown are where the clues leave room for doubt
+  unresolved.clear();
+  for (int y = 0; y < copy.height(); ++y) {
+    for (int x = 0; x < copy.width(); ++x) {
+      if (copy.at(x, y).state == PuzzleCell::State::blank)
+        unresolved.push_back(y * copy.width() + x);
+    }
+  }
+
+  if (m_options.line_solvable || too_ambiguous(unresolved))
+    return false;
+
+  while (!finished && solver.num_solutions() < 2
+         && solver.num_guesses() <= m_options.max_guesses)
+    finished = solver.step();
+  return finished && solver.num_solutions() == 1;
+}
+
+bool PuzzleGenerator::too_ambiguous(const std::vector<int>& unresolved) const
+{
+  return unresolved.size()
+    > max_unresolved * m_options.width * m_options.height;
+}
+
+void PuzzleGenerator::repair(Puzzle& puzzle,
+                             const std::vector<int>& unresolved)
+{
+  int index;
+  if (unresolved.empty()) {
+    std::uniform_int_distribution<int> any(0, puzzle.width()
+                                           * puzzle.height() - 1);
+    index = any(m_rng);
+  } else {
+    std::uniform_int_distribution<std::size_t> pick(0, unresolved.size() - 1);
+    index = unresolved[pick(m_rng)];
+  }
+
+  int x = index % puzzle.width(), y = index / puzzle.width();
+  if (puzzle.at(x, y).state == PuzzleCell::State::filled)
+    puzzle.clear_cell(x, y);
+  else
+    puzzle.mark_cell(x, y, random_color());
+
+  //only the row and column through the cell are recomputed
+  puzzle.update(true);
+}
+
+const Color& PuzzleGenerator::random_color()
+{
+  if (m_colors.size() == 1)
+    return m_colors[0];
+  std::uniform_int_distribution<std::size_t> pick(0, m_colors.size() - 1);
+  return m_colors[pick(m_rng)];
+}
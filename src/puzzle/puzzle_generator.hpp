@@ -0,0 +1,119 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_PUZZLE_GENERATOR_HPP
+#define NONNY_PUZZLE_GENERATOR_HPP
+
+#include <random>
+#include <vector>
+#include "color/color.hpp"
+#include "color/color_palette.hpp"
+#include "puzzle/puzzle.hpp"
+
+/*
+ * Settings for the puzzle generator.
+ */
+struct GeneratorOptions {
+  int width = 25;
+  int height = 25;
+
+  // Fraction of the cells that are filled
+  double density = 0.5;
+
+  // Number of foreground colors, 1 for a black and white puzzle
+  int num_colors = 1;
+
+  /*
+   * Distance between the points of the value noise used to lay out the
+   * picture; larger values give larger shapes. If zero, every cell is
+   * chosen independently, which below a density of about 0.6 rarely
+   * gives a unique solution.
+   */
+  int noise_scale = 4;
+
+  // Reject puzzles that cannot be solved one line at a time
+  bool line_solvable = false;
+
+  /*
+   * Guesses the solver may make while looking for a second solution.
+   * A search that runs longer than this is abandoned and the candidate
+   * is repaired as if it were ambiguous, which keeps the occasional
+   * very hard grid from stalling the generator.
+   */
+  int max_guesses = 20;
+
+  // Local repairs to try on a candidate before drawing a new one
+  int max_repairs = 40;
+};
+
+/*
+ * Produces random puzzles with exactly one solution. Each candidate
+ * grid is given to the solver, which stops as soon as a second solution
+ * turns up. When a candidate is ambiguous, a cell in the part of the
+ * grid the line solver could not settle is toggled and only the row and
+ * column through it are updated before checking again, which usually
+ * settles the puzzle much sooner than drawing a new grid would.
+ */
+class PuzzleGenerator {
+public:
+  PuzzleGenerator(const GeneratorOptions& options, unsigned seed);
+
+  // Generate a puzzle; its grid holds the solution
+  Puzzle operator()();
+
+  // Restart the random number sequence from the given seed
+  void seed(unsigned seed) { m_rng.seed(seed); }
+
+  // How many grids and repaired grids have been checked so far?
+  long num_candidates() const { return m_num_candidates; }
+  long num_repairs() const { return m_num_repairs; }
+
+private:
+  // Draw a new picture on the grid
+  void fill_random(Puzzle& puzzle);
+  void fill_noise(Puzzle& puzzle);
+
+  // Smooth random values in [0, 1), one for each cell
+  std::vector<double> make_noise(int width, int height);
+
+  /*
+   * Returns true if the candidate is acceptable. Otherwise, unresolved
+   * receives the cells that were still unknown when the line solver got
+   * stuck.
+   */
+  bool check(const Puzzle& puzzle, std::vector<int>& unresolved);
+
+  // Are too many cells unresolved for a search or repair to pay off?
+  bool too_ambiguous(const std::vector<int>& unresolved) const;
+
+  // Toggle one of the unresolved cells
+  void repair(Puzzle& puzzle, const std::vector<int>& unresolved);
+
+  const Color& random_color();
+
+  GeneratorOptions m_options;
+  ColorPalette m_palette;
+  std::vector<Color> m_colors;
+  std::mt19937 m_rng;
+  long m_num_candidates = 0;
+  long m_num_repairs = 0;
+};
+
+#endif
@@ -20,13 +20,41 @@
 
 #include "puzzle/puzzle_grid.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <map>
 #include <sstream>
 #include <stdexcept>
 #include "color/color_palette.hpp"
 #include "puzzle/puzzle_io.hpp"
+#include "utility/binary_io.hpp"
 #include "utility/utility.hpp"
 
+namespace {
+  /*
+   * Packed grids store each cell as a code: 0 for a blank cell, 1 for a
+   * crossed-out cell, or 2 plus the palette index of a filled cell. The
+   * cell data begins with a byte giving the encoding, followed by either
+   * a varint for each run of equal codes, holding the code in the low
+   * bits and the run length minus one in the remaining bits, or by the
+   * codes themselves packed at a fixed number of bits per cell.
+   */
+  constexpr unsigned packed_version = 1;
+  constexpr unsigned run_encoding = 0;
+  constexpr unsigned bit_encoding = 1;
+
+  // Largest grid dimension accepted when unpacking
+  constexpr int max_packed_size = 1 << 13;
+
+  unsigned bits_per_code(std::size_t num_colors)
+  {
+    unsigned bits = 1;
+    while ((std::size_t(1) << bits) < num_colors + 2)
+      ++bits;
+    return bits;
+  }
+}
+
 PuzzleCell& PuzzleGrid::at(int x, int y)
 {
   //call const version and convert back
@@ -150,3 +178,153 @@ std::istream& read_grid(std::istream& is, PuzzleGrid& grid,
 
   return is;
 }
+
+std::string pack_grid(const PuzzleGrid& grid)
+{
+  std::vector<Color> colors;
+  std::vector<unsigned> codes;
+  codes.reserve(grid.width() * grid.height());
+  for (int y = 0; y != grid.height(); ++y) {
+    for (int x = 0; x != grid.width(); ++x) {
+      const PuzzleCell& cell = grid.at(x, y);
+      unsigned code = 0;
+      if (cell.state == PuzzleCell::State::crossed_out) {
+        code = 1;
+      } else if (cell.state == PuzzleCell::State::filled) {
+        auto it = std::find(colors.begin(), colors.end(), cell.color);
+        if (it == colors.end())
+          it = colors.insert(colors.end(), cell.color);
+        code = 2 + (it - colors.begin());
+      }
+      codes.push_back(code);
+    }
+  }
+
+  unsigned bits = bits_per_code(colors.size());
+
+  std::string runs;
+  put_u8(runs, run_encoding);
+  for (std::size_t pos = 0; pos != codes.size(); ) {
+    std::size_t end = pos + 1;
+    while (end != codes.size() && codes[end] == codes[pos])
+      ++end;
+    put_varint(runs, static_cast<std::uint64_t>(end - pos - 1) << bits
+               | codes[pos]);
+    pos = end;
+  }
+
+  std::string data;
+  if (runs.size() - 1 <= (codes.size() * bits + 7) / 8) {
+    data = std::move(runs);
+  } else {
+    put_u8(data, bit_encoding);
+    std::uint64_t accum = 0;
+    unsigned num_bits = 0;
+    for (unsigned code : codes) {
+      accum |= static_cast<std::uint64_t>(code) << num_bits;
+      num_bits += bits;
+      while (num_bits >= 8) {
+        put_u8(data, static_cast<unsigned>(accum));
+        accum >>= 8;
+        num_bits -= 8;
+      }
+    }
+    if (num_bits > 0)
+      put_u8(data, static_cast<unsigned>(accum));
+  }
+
+  std::ostringstream ss;
+  ss << packed_version << " " << grid.width() << " " << grid.height()
+     << " " << colors.size();
+  for (const Color& color : colors)
+    ss << " " << color;
+  ss << " " << base64_encode(data);
+  return ss.str();
+}
+
+PuzzleGrid unpack_grid(const std::string& packed)
+{
+  std::istringstream ss(packed);
+  unsigned version = 0;
+  int width = -1, height = -1;
+  std::size_t num_colors = 0;
+  ss >> version >> width >> height >> num_colors;
+  if (!ss || version != packed_version)
+    throw InvalidPuzzleFile("::unpack_grid: unsupported grid format");
+  if (width < 0 || height < 0
+      || width > max_packed_size || height > max_packed_size
+      || (width == 0) != (height == 0))
+    throw InvalidPuzzleFile("::unpack_grid: invalid grid size");
+
+  std::size_t num_cells = static_cast<std::size_t>(width) * height;
+  if (num_colors > num_cells || num_colors > packed.size() / 7)
+    throw InvalidPuzzleFile("::unpack_grid: invalid palette");
+
+  std::vector<Color> colors(num_colors);
+  for (Color& color : colors)
+    ss >> color;
+
+  std::string text;
+  ss >> text;
+  if (!ss)
+    throw InvalidPuzzleFile("::unpack_grid: unexpected end of grid");
+
+  //cell for each code
+  std::vector<PuzzleCell> cells(num_colors + 2);
+  cells[1].state = PuzzleCell::State::crossed_out;
+  for (std::size_t i = 0; i != num_colors; ++i) {
+    cells[i + 2].state = PuzzleCell::State::filled;
+    cells[i + 2].color = colors[i];
+  }
+
+  PuzzleGrid grid;
+  grid.m_width = width;
+  grid.m_grid.reserve(num_cells);
+  try {
+    std::string data = base64_decode(text);
+    ByteReader reader(data.data(), data.data() + data.size());
+    unsigned bits = bits_per_code(num_colors);
+    std::uint64_t mask = (std::uint64_t(1) << bits) - 1;
+
+    unsigned encoding = reader.u8();
+    if (encoding == run_encoding) {
+      while (grid.m_grid.size() < num_cells) {
+        std::uint64_t run = reader.varint();
+        std::uint64_t length = (run >> bits) + 1;
+        std::uint64_t code = run & mask;
+        if (length > num_cells - grid.m_grid.size())
+          throw InvalidPuzzleFile("::unpack_grid: too many cells");
+        if (code >= cells.size())
+          throw InvalidPuzzleFile("::unpack_grid: invalid color index");
+        grid.m_grid.insert(grid.m_grid.end(),
+                           static_cast<std::size_t>(length), cells[code]);
+      }
+    } else if (encoding == bit_encoding) {
+      std::size_t size = (num_cells * bits + 7) / 8;
+      const unsigned char* bytes
+        = reinterpret_cast<const unsigned char*>(reader.bytes(size));
+      std::uint64_t accum = 0;
+      unsigned num_bits = 0;
+      while (grid.m_grid.size() < num_cells) {
+        while (num_bits < bits) {
+          accum |= static_cast<std::uint64_t>(*bytes++) << num_bits;
+          num_bits += 8;
+        }
+        std::uint64_t code = accum & mask;
+        accum >>= bits;
+        num_bits -= bits;
+        if (code >= cells.size())
+          throw InvalidPuzzleFile("::unpack_grid: invalid color index");
+        grid.m_grid.push_back(cells[code]);
+      }
+    } else {
+      throw InvalidPuzzleFile("::unpack_grid: unknown cell encoding");
+    }
+  } catch (const std::invalid_argument&) {
+    throw InvalidPuzzleFile("::unpack_grid: invalid grid data");
+  } catch (const std::out_of_range&) {
+    throw InvalidPuzzleFile("::unpack_grid: unexpected end of grid");
+  }
+
+  return grid;
+}
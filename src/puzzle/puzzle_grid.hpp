@@ -23,6 +23,7 @@
 
 #include <iosfwd>
 #include <stdexcept>
+#include <string>
 #include <vector>
 #include "puzzle/puzzle_cell.hpp"
 
@@ -34,6 +35,7 @@ class ColorPalette;
 class PuzzleGrid {
   friend std::istream& read_grid(std::istream& is, PuzzleGrid& grid,
                                  const ColorPalette& palette);
+  friend PuzzleGrid unpack_grid(const std::string& packed);
 public:
   PuzzleGrid() : m_width(0) { }
   PuzzleGrid(const PuzzleGrid&) = default;
@@ -63,6 +65,16 @@ std::ostream& write_grid(std::ostream& os, const PuzzleGrid& grid,
 std::istream& read_grid(std::istream& is, PuzzleGrid& grid,
                         const ColorPalette& palette);
 
+/*
+ * Converts a grid to/from the compact single-line form used in save
+ * files. The line holds a format version, the grid dimensions and the
+ * colors used by filled cells, followed by the base64-encoded cells,
+ * which are stored either as runs or bit-packed, whichever is smaller.
+ * Unpacking throws InvalidPuzzleFile if the data is malformed.
+ */
+std::string pack_grid(const PuzzleGrid& grid);
+PuzzleGrid unpack_grid(const std::string& packed);
+
 /* implementation */
 
 inline int PuzzleGrid::height() const
@@ -0,0 +1,493 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "puzzle/puzzle_image.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "color/color_palette.hpp"
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "solver/solver.hpp"
+
+namespace {
+  // Pixels at least this opaque after scaling become filled cells
+  constexpr unsigned min_filled_alpha = 128;
+
+  // Rounds of refinement applied to the median cut palette
+  constexpr int refine_passes = 4;
+
+  // Symbols for imported colors; this also limits the palette size
+  const char color_symbols[] = "abcdefghijklmnopqrstuvwxyz";
+  constexpr int max_import_colors = sizeof(color_symbols) - 1;
+
+  /*
+   * Opaque pixels of a scaled image, with each channel in its own
+   * array so that the distance calculations vectorize.
+   */
+  struct PixelSet {
+    std::vector<int> index; //position in the image
+    std::vector<int> r, g, b;
+  };
+
+  // A group of pixels being split by the median cut
+  struct ColorBox {
+    std::size_t begin, end;
+    int channel; //channel with the largest range
+    int range;
+  };
+
+  /*
+   * The pixel kernels below work on fixed-size blocks copied into
+   * local arrays: the block loops have a constant trip count and
+   * cannot alias, so the compiler vectorizes them even at -O2.
+   */
+  constexpr std::size_t block_size = 16;
+
+  void add_row(std::uint64_t* sums, const std::uint8_t* row, std::size_t n)
+  {
+    std::size_t i = 0;
+    for (; i + block_size <= n; i += block_size) {
+      std::uint8_t in[block_size];
+      std::uint64_t out[block_size];
+      std::memcpy(in, row + i, sizeof(in));
+      std::memcpy(out, sums + i, sizeof(out));
+      for (std::size_t j = 0; j < block_size; ++j)
+        out[j] += in[j];
+      std::memcpy(sums + i, out, sizeof(out));
+    }
+
+    for (; i < n; ++i)
+      sums[i] += row[i];
+  }
+
+  // Sum color channels weighted by alpha, along with the alpha itself
+  void add_row_premultiplied(std::uint64_t* sums, const std::uint8_t* row,
+                             std::size_t num_pixels)
+  {
+    std::size_t n = num_pixels * 4;
+    std::size_t i = 0;
+    for (; i + block_size <= n; i += block_size) {
+      std::uint8_t in[block_size];
+      std::uint64_t out[block_size];
+      std::uint32_t weight[block_size];
+      std::memcpy(in, row + i, sizeof(in));
+      std::memcpy(out, sums + i, sizeof(out));
+      for (std::size_t j = 0; j < block_size; ++j)
+        weight[j] = (j & 3) == 3 ? 1 : in[j | 3];
+      for (std::size_t j = 0; j < block_size; ++j)
+        out[j] += in[j] * weight[j];
+      std::memcpy(sums + i, out, sizeof(out));
+    }
+
+    for (; i < n; i += 4) {
+      std::uint64_t alpha = row[i + 3];
+      sums[i] += row[i] * alpha;
+      sums[i + 1] += row[i + 1] * alpha;
+      sums[i + 2] += row[i + 2] * alpha;
+      sums[i + 3] += alpha;
+    }
+  }
+
+  bool is_opaque(const RgbaImage& image)
+  {
+    const std::uint8_t* pixels = image.pixels.data();
+    std::size_t size = image.pixels.size();
+    unsigned min_alpha = 255;
+    for (std::size_t i = 3; i < size; i += 4)
+      min_alpha = std::min<unsigned>(min_alpha, pixels[i]);
+    return min_alpha == 255;
+  }
+
+  // Boundaries of the source pixels covered by each target pixel
+  std::vector<int> scale_bounds(int source_size, int target_size)
+  {
+    std::vector<int> bounds(target_size + 1);
+    for (int i = 0; i <= target_size; ++i)
+      bounds[i] = static_cast<int>(static_cast<std::int64_t>(i)
+                                   * source_size / target_size);
+    return bounds;
+  }
+
+  /*
+   * Assign each pixel to the nearest color. Returns false if the
+   * assignment did not change.
+   */
+  bool assign_pixels(const PixelSet& pixels,
+                     const std::vector<Color>& colors,
+                     std::vector<int>& labels)
+  {
+    std::size_t n = pixels.index.size();
+    std::vector<int> best(n, std::numeric_limits<int>::max());
+    std::vector<int> nearest(n, 0);
+    const int* r = pixels.r.data();
+    const int* g = pixels.g.data();
+    const int* b = pixels.b.data();
+    int* best_data = best.data();
+    int* nearest_data = nearest.data();
+
+    for (std::size_t c = 0; c < colors.size(); ++c) {
+      int cr = colors[c].red(), cg = colors[c].green(), cb = colors[c].blue();
+      int label = static_cast<int>(c);
+
+      std::size_t i = 0;
+      for (; i + block_size <= n; i += block_size) {
+        int dist[block_size], best_block[block_size], label_block[block_size];
+        int in_r[block_size], in_g[block_size], in_b[block_size];
+        std::memcpy(in_r, r + i, sizeof(in_r));
+        std::memcpy(in_g, g + i, sizeof(in_g));
+        std::memcpy(in_b, b + i, sizeof(in_b));
+        std::memcpy(best_block, best_data + i, sizeof(best_block));
+        std::memcpy(label_block, nearest_data + i, sizeof(label_block));
+        for (std::size_t j = 0; j < block_size; ++j) {
+          int dr = in_r[j] - cr, dg = in_g[j] - cg, db = in_b[j] - cb;
+          dist[j] = dr * dr + dg * dg + db * db;
+        }
+        for (std::size_t j = 0; j < block_size; ++j) {
+          label_block[j] = dist[j] < best_block[j] ? label : label_block[j];
+          best_block[j] = dist[j] < best_block[j] ? dist[j] : best_block[j];
+        }
+        std::memcpy(best_data + i, best_block, sizeof(best_block));
+        std::memcpy(nearest_data + i, label_block, sizeof(label_block));
+      }
+
+      for (; i < n; ++i) {
+        int dr = r[i] - cr, dg = g[i] - cg, db = b[i] - cb;
+        int dist = dr * dr + dg * dg + db * db;
+        if (dist < best_data[i]) {
+          best_data[i] = dist;
+          nearest_data[i] = label;
+        }
+      }
+    }
+
+    bool changed = nearest != labels;
+    labels.swap(nearest);
+    return changed;
+  }
+
+  // Replace each color by the mean of its pixels, dropping unused colors
+  void update_colors(const PixelSet& pixels, std::vector<Color>& colors,
+                     std::vector<int>& labels)
+  {
+    std::vector<std::int64_t> sums(colors.size() * 4, 0);
+    for (std::size_t i = 0; i < labels.size(); ++i) {
+      std::int64_t* sum = &sums[labels[i] * 4];
+      sum[0] += pixels.r[i];
+      sum[1] += pixels.g[i];
+      sum[2] += pixels.b[i];
+      ++sum[3];
+    }
+
+    std::vector<Color> means;
+    std::vector<int> new_label(colors.size(), -1);
+    for (std::size_t c = 0; c < colors.size(); ++c) {
+      const std::int64_t* sum = &sums[c * 4];
+      if (sum[3] == 0)
+        continue;
+      Color mean(static_cast<int>((sum[0] + sum[3] / 2) / sum[3]),
+                 static_cast<int>((sum[1] + sum[3] / 2) / sum[3]),
+                 static_cast<int>((sum[2] + sum[3] / 2) / sum[3]));
+      auto it = std::find(means.begin(), means.end(), mean);
+      new_label[c] = it - means.begin();
+      if (it == means.end())
+        means.push_back(mean);
+    }
+
+    for (int& label : labels)
+      label = new_label[label];
+    colors.swap(means);
+  }
+
+  ColorBox make_box(const PixelSet& pixels, const std::vector<int>& order,
+                    std::size_t begin, std::size_t end)
+  {
+    int low[3] = { 255, 255, 255 }, high[3] = { 0, 0, 0 };
+    for (std::size_t i = begin; i < end; ++i) {
+      int p = order[i];
+      int value[3] = { pixels.r[p], pixels.g[p], pixels.b[p] };
+      for (int c = 0; c < 3; ++c) {
+        low[c] = std::min(low[c], value[c]);
+        high[c] = std::max(high[c], value[c]);
+      }
+    }
+
+    ColorBox box { begin, end, 0, high[0] - low[0] };
+    for (int c = 1; c < 3; ++c) {
+      if (high[c] - low[c] > box.range) {
+        box.channel = c;
+        box.range = high[c] - low[c];
+      }
+    }
+    return box;
+  }
+
+  /*
+   * Choose up to num_colors colors for the pixels by median cut, then
+   * refine them with a few rounds of k-means. On return, labels holds
+   * the index of each pixel's color.
+   */
+  std::vector<Color> quantize(const PixelSet& pixels, int num_colors,
+                              std::vector<int>& labels)
+  {
+    std::vector<int> order(pixels.index.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+      order[i] = static_cast<int>(i);
+
+    std::vector<ColorBox> boxes;
+    boxes.push_back(make_box(pixels, order, 0, order.size()));
+    while (static_cast<int>(boxes.size()) < num_colors) {
+      auto widest = std::max_element(boxes.begin(), boxes.end(),
+                                     [](const ColorBox& l, const ColorBox& r)
+                                     { return l.range < r.range; });
+      if (widest->range == 0)
+        break;
+
+      const std::vector<int>* channel = widest->channel == 0 ? &pixels.r
+        : widest->channel == 1 ? &pixels.g : &pixels.b;
+      std::size_t mid = widest->begin + (widest->end - widest->begin) / 2;
+      std::nth_element(order.begin() + widest->begin, order.begin() + mid,
+                       order.begin() + widest->end,
+                       [channel](int l, int r)
+                       { return (*channel)[l] < (*channel)[r]; });
+
+      ColorBox upper = make_box(pixels, order, mid, widest->end);
+      *widest = make_box(pixels, order, widest->begin, mid);
+      boxes.push_back(upper);
+    }
+
+    std::vector<Color> colors;
+    labels.assign(pixels.index.size(), 0);
+    for (std::size_t c = 0; c < boxes.size(); ++c)
+      for (std::size_t i = boxes[c].begin; i < boxes[c].end; ++i)
+        labels[order[i]] = static_cast<int>(c);
+    colors.resize(boxes.size());
+    update_colors(pixels, colors, labels);
+
+    for (int pass = 0; pass < refine_passes; ++pass) {
+      if (!assign_pixels(pixels, colors, labels))
+        break;
+      update_colors(pixels, colors, labels);
+    }
+    return colors;
+  }
+}
+
+RgbaImage scale_image(const RgbaImage& image, int width, int height)
+{
+  if (width <= 0 || height <= 0 || image.width <= 0 || image.height <= 0)
+    throw std::invalid_argument("::scale_image: invalid image size");
+
+  RgbaImage result(width, height);
+  bool opaque = is_opaque(image);
+  std::vector<int> x_bounds = scale_bounds(image.width, width);
+  std::vector<int> y_bounds = scale_bounds(image.height, height);
+  std::size_t row_size = static_cast<std::size_t>(image.width) * 4;
+  std::vector<std::uint64_t> sums(row_size);
+
+  std::uint8_t* out = result.pixels.data();
+  for (int y = 0; y < height; ++y) {
+    //when enlarging, each target pixel still needs one source pixel
+    int y0 = std::min(y_bounds[y], image.height - 1);
+    int y1 = std::max(y_bounds[y + 1], y0 + 1);
+
+    //total each column over the rows of this band
+    std::fill(sums.begin(), sums.end(), 0);
+    for (int sy = y0; sy < y1; ++sy) {
+      const std::uint8_t* row = image.pixels.data() + sy * row_size;
+      if (opaque)
+        add_row(sums.data(), row, row_size);
+      else
+        add_row_premultiplied(sums.data(), row, image.width);
+    }
+
+    //then total the columns that fall in each target pixel
+    for (int x = 0; x < width; ++x, out += 4) {
+      int x0 = std::min(x_bounds[x], image.width - 1);
+      int x1 = std::max(x_bounds[x + 1], x0 + 1);
+      std::uint64_t total[4] = { 0, 0, 0, 0 };
+      for (int sx = x0; sx < x1; ++sx)
+        for (int c = 0; c < 4; ++c)
+          total[c] += sums[sx * 4 + c];
+
+      std::uint64_t count = static_cast<std::uint64_t>(x1 - x0) * (y1 - y0);
+      if (opaque) {
+        for (int c = 0; c < 4; ++c)
+          out[c] = static_cast<std::uint8_t>((total[c] + count / 2) / count);
+      } else if (total[3] > 0) {
+        for (int c = 0; c < 3; ++c)
+          out[c] = static_cast<std::uint8_t>((total[c] + total[3] / 2)
+                                             / total[3]);
+        out[3] = static_cast<std::uint8_t>((total[3] + count / 2) / count);
+      } else {
+        out[0] = out[1] = out[2] = out[3] = 0;
+      }
+    }
+  }
+
+  return result;
+}
+
+void import_size(int image_width, int image_height,
+                 const ImageImportOptions& options, int& width, int& height)
+{
+  width = options.width;
+  height = options.height;
+  if (width > 0 && height > 0)
+    return;
+
+  double aspect = static_cast<double>(image_width) / image_height;
+  if (width > 0) {
+    height = static_cast<int>(width / aspect + 0.5);
+  } else if (height > 0) {
+    width = static_cast<int>(height * aspect + 0.5);
+  } else {
+    int size = std::max(options.max_size, 1);
+    width = std::min(image_width, size);
+    height = std::min(image_height, size);
+    if (aspect >= 1.0)
+      height = static_cast<int>(width / aspect + 0.5);
+    else
+      width = static_cast<int>(height * aspect + 0.5);
+  }
+  width = std::max(width, 1);
+  height = std::max(height, 1);
+}
+
+void image_to_puzzle(const RgbaImage& image, Puzzle& puzzle,
+                     const ImageImportOptions& options)
+{
+  if (image.width <= 0 || image.height <= 0)
+    throw InvalidPuzzleFile("::image_to_puzzle: image is empty");
+
+  int width, height;
+  import_size(image.width, image.height, options, width, height);
+  RgbaImage scaled = scale_image(image, width, height);
+
+  PixelSet pixels;
+  std::size_t num_cells = static_cast<std::size_t>(width) * height;
+  for (std::size_t i = 0; i < num_cells; ++i) {
+    const std::uint8_t* p = &scaled.pixels[i * 4];
+    if (p[3] >= min_filled_alpha) {
+      pixels.index.push_back(static_cast<int>(i));
+      pixels.r.push_back(p[0]);
+      pixels.g.push_back(p[1]);
+      pixels.b.push_back(p[2]);
+    }
+  }
+
+  //without transparency, one extra color is needed for the background
+  bool has_background = pixels.index.size() < num_cells;
+  int max_colors = std::max(1, std::min(options.max_colors,
+                                        max_import_colors));
+  int num_colors = has_background ? max_colors : max_colors + 1;
+
+  std::vector<int> labels;
+  std::vector<Color> colors;
+  if (!pixels.index.empty())
+    colors = quantize(pixels, num_colors, labels);
+
+  int background = -1;
+  if (!has_background && colors.size() > 1) {
+    auto darker = [](const Color& l, const Color& r) {
+      return l.luminance() < r.luminance();
+    };
+    auto lightest = std::max_element(colors.begin(), colors.end(), darker);
+    background = lightest - colors.begin();
+  }
+
+  ColorPalette palette;
+  std::vector<Color> cell_colors(colors.size());
+  int num_added = 0;
+  for (std::size_t c = 0; c < colors.size(); ++c) {
+    if (static_cast<int>(c) == background)
+      continue;
+
+    Color color = colors[c];
+    if (max_colors == 1 || color == palette["black"]) {
+      color = palette["black"];
+    } else {
+      //keep the palette's background entry intact
+      if (color == palette["background"])
+        color = Color(254, 254, 254);
+      palette.add(color, "color" + std::to_string(num_added + 1),
+                  color_symbols[num_added]);
+      ++num_added;
+    }
+    cell_colors[c] = color;
+  }
+
+  Puzzle result(width, height, palette);
+  for (std::size_t i = 0; i < labels.size(); ++i) {
+    if (labels[i] != background) {
+      int cell = pixels.index[i];
+      result.mark_cell(cell % width, cell / width, cell_colors[labels[i]]);
+    }
+  }
+  result.update(true);
+  result.clear_all_cells();
+
+  if (options.require_unique) {
+    Puzzle copy = result;
+    Solver solver(copy);
+    while (!solver.step() && solver.num_solutions() < 2) { }
+    if (solver.num_solutions() != 1)
+      throw InvalidPuzzleFile("::image_to_puzzle: puzzle does not have "
+                              "a unique solution");
+  }
+
+  puzzle = std::move(result);
+}
+
+RgbaImage puzzle_to_image(const Puzzle& puzzle, int cell_size)
+{
+  if (cell_size <= 0)
+    throw std::invalid_argument("::puzzle_to_image: invalid cell size");
+
+  RgbaImage image(puzzle.width() * cell_size, puzzle.height() * cell_size);
+  std::size_t row_size = static_cast<std::size_t>(image.width) * 4;
+  for (int y = 0; y < puzzle.height(); ++y) {
+    std::uint8_t* row = image.pixels.data() + y * cell_size * row_size;
+    for (int x = 0; x < puzzle.width(); ++x) {
+      const PuzzleCell& cell = puzzle.at(x, y);
+      if (cell.state != PuzzleCell::State::filled)
+        continue;
+
+      for (int i = 0; i < cell_size; ++i) {
+        std::uint8_t* out = row + (x * cell_size + i) * 4;
+        out[0] = static_cast<std::uint8_t>(cell.color.red());
+        out[1] = static_cast<std::uint8_t>(cell.color.green());
+        out[2] = static_cast<std::uint8_t>(cell.color.blue());
+        out[3] = 255;
+      }
+    }
+
+    //the remaining rows of each cell are copies of the first
+    for (int i = 1; i < cell_size; ++i)
+      std::copy(row, row + row_size, row + i * row_size);
+  }
+
+  return image;
+}
@@ -0,0 +1,79 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_PUZZLE_IMAGE_HPP
+#define NONNY_PUZZLE_IMAGE_HPP
+
+#include "utility/png_image.hpp"
+
+class Puzzle;
+
+/*
+ * Settings for turning an image into a puzzle.
+ */
+struct ImageImportOptions {
+  /*
+   * Size of the puzzle grid. If either is zero, it is chosen to keep
+   * the aspect ratio of the image, with neither side longer than
+   * max_size.
+   */
+  int width = 0;
+  int height = 0;
+  int max_size = 30;
+
+  // Largest number of foreground colors, 1 for a black and white puzzle
+  int max_colors = 4;
+
+  // Reject the image unless the puzzle has exactly one solution
+  bool require_unique = false;
+};
+
+/*
+ * Build a puzzle from an image. The image is scaled down to the grid
+ * size and its colors are reduced to a small palette. Transparent
+ * areas become blank cells; if there are none, the lightest color is
+ * used for the blank cells instead. Throws InvalidPuzzleFile if the
+ * uniqueness check is requested and fails.
+ */
+void image_to_puzzle(const RgbaImage& image, Puzzle& puzzle,
+                     const ImageImportOptions& options
+                     = ImageImportOptions());
+
+/*
+ * The grid size image_to_puzzle picks for an image of the given size,
+ * so that it can be found from the image header alone.
+ */
+void import_size(int image_width, int image_height,
+                 const ImageImportOptions& options, int& width, int& height);
+
+/*
+ * Render the cells of a puzzle grid as an image, such as a solution
+ * drawn in the editor, using a square of cell_size pixels for each
+ * cell and leaving unfilled cells transparent.
+ */
+RgbaImage puzzle_to_image(const Puzzle& puzzle, int cell_size = 1);
+
+/*
+ * Resize an image by averaging the pixels that fall in each target
+ * pixel, weighting colors by their opacity.
+ */
+RgbaImage scale_image(const RgbaImage& image, int width, int height);
+
+#endif
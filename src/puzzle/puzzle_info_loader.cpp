@@ -0,0 +1,236 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "puzzle/puzzle_info_loader.hpp"
+
+#include <algorithm>
+#include <exception>
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "puzzle/puzzle_pack.hpp"
+#include "puzzle/puzzle_progress.hpp"
+#include "save/save_manager.hpp"
+#include "utility/trace.hpp"
+
+//loading is mostly disk-bound, so a few threads are enough
+constexpr unsigned min_loader_threads = 2;
+constexpr unsigned max_loader_threads = 4;
+
+PuzzleInfoLoader::PuzzleInfoLoader(SaveManager& save_mgr,
+                                   unsigned num_threads)
+  : m_save_mgr(save_mgr)
+{
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+    num_threads = std::max(num_threads, min_loader_threads);
+    num_threads = std::min(num_threads, max_loader_threads);
+  }
+
+  for (unsigned i = 0; i < num_threads; ++i)
+    m_threads.emplace_back(&PuzzleInfoLoader::work, this);
+}
+
+PuzzleInfoLoader::~PuzzleInfoLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quit = true;
+  }
+  m_job_ready.notify_all();
+
+  for (auto& thread : m_threads)
+    thread.join();
+}
+
+void PuzzleInfoLoader::request(std::size_t index, const std::string& path,
+                               std::shared_ptr<const LibraryEntry> known)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (index >= m_jobs.size())
+      m_jobs.resize(index + 1);
+
+    Job& job = m_jobs[index];
+    if (job.path.empty() || job.taken)
+      ++m_pending;
+    job.path = path;
+    job.known = std::move(known);
+    job.taken = false;
+    if (index < m_next)
+      m_next = index;
+  }
+  m_job_ready.notify_one();
+}
+
+void PuzzleInfoLoader::prioritize(std::size_t first, std::size_t last)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_priority_first = first;
+  m_priority_last = last;
+}
+
+void PuzzleInfoLoader::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_jobs.clear();
+  m_results.clear();
+  m_next = m_pending = 0;
+  m_priority_first = m_priority_last = 0;
+  ++m_generation;
+}
+
+std::vector<PuzzleInfoLoader::Result> PuzzleInfoLoader::take_results()
+{
+  std::vector<Result> results;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  results.swap(m_results);
+  return results;
+}
+
+bool PuzzleInfoLoader::is_busy() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pending > 0 || m_active > 0;
+}
+
+bool PuzzleInfoLoader::has_results() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return !m_results.empty();
+}
+
+void PuzzleInfoLoader::work()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_job_ready.wait(lock, [this]() { return m_quit || m_pending > 0; });
+    if (m_quit)
+      return;
+
+    std::size_t index;
+    if (!next_job(index))
+      continue;
+
+    std::string path = m_jobs[index].path;
+    auto known = m_jobs[index].known;
+    unsigned generation = m_generation;
+    ++m_active;
+
+    lock.unlock();
+    Result result = load(index, path, known.get());
+    lock.lock();
+
+    --m_active;
+    //discard the result if the jobs were cleared in the meantime
+    if (generation == m_generation)
+      m_results.push_back(std::move(result));
+  }
+}
+
+/*
+ * Choose the next job to run and mark it as taken. The lock must be
+ * held by the caller.
+ */
+bool PuzzleInfoLoader::next_job(std::size_t& index)
+{
+  std::size_t last = std::min(m_priority_last, m_jobs.size());
+  for (std::size_t i = m_priority_first; i < last; ++i) {
+    if (!m_jobs[i].path.empty() && !m_jobs[i].taken) {
+      index = i;
+      m_jobs[i].taken = true;
+      --m_pending;
+      return true;
+    }
+  }
+
+  for (; m_next < m_jobs.size(); ++m_next) {
+    if (!m_jobs[m_next].path.empty() && !m_jobs[m_next].taken) {
+      index = m_next;
+      m_jobs[m_next++].taken = true;
+      --m_pending;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+PuzzleInfoLoader::Result
+PuzzleInfoLoader::load(std::size_t index, const std::string& path,
+                       const LibraryEntry* known) const
+{
+  NONNY_TRACE_SCOPE("PuzzleInfoLoader::load");
+  Result result;
+  result.index = index;
+  result.entry = std::make_shared<LibraryEntry>();
+  LibraryEntry& entry = *result.entry;
+
+  //stamp the file before reading it so a later change is noticed
+  entry.file_stamp = file_stamp(path);
+
+  try {
+    //puzzles in a pack already have their summary from the index,
+    //and images are only converted when they are opened
+    if (known) {
+      entry.summary = known->summary;
+      entry.clue_hash = known->clue_hash;
+    } else if (puzzle_format(path) == PuzzleFormat::png) {
+      skim_puzzle_file(path, entry.summary, PuzzleFormat::png);
+    } else {
+      Puzzle puzzle;
+      if (read_puzzle_file(path, puzzle, puzzle_format(path))) {
+        entry.summary = make_summary(puzzle);
+        entry.clue_hash = clue_hash(puzzle);
+      }
+    }
+  } catch (const std::exception&) {
+    //show the file without its information, but try its skim data
+    entry.summary = PuzzleSummary();
+    try {
+      skim_puzzle_file(path, entry.summary, puzzle_format(path));
+    } catch (const std::exception&) {
+      entry.summary = PuzzleSummary();
+    }
+  }
+
+  try {
+    std::string collection, id;
+    SaveManager::progress_key(entry.summary, path, collection, id);
+    std::string save_file
+      = m_save_mgr.find_progress_file(path, collection, id);
+    entry.save_stamp = progress_stamp(save_file);
+
+    PuzzleProgress progress;
+    m_save_mgr.load_progress(progress, path, collection, id);
+    entry.is_complete = progress.is_complete();
+    entry.best_time = progress.best_time();
+    entry.current_time = progress.current_time();
+    if (progress.is_complete())
+      entry.thumbnail = make_thumbnail(progress.solution());
+    else
+      entry.thumbnail = make_thumbnail(progress.state());
+  } catch (const std::exception&) {
+    entry.is_complete = false;
+    entry.best_time = entry.current_time = 0;
+    entry.thumbnail = PuzzleThumbnail();
+  }
+
+  return result;
+}
@@ -0,0 +1,109 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_PUZZLE_INFO_LOADER_HPP
+#define NONNY_PUZZLE_INFO_LOADER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "save/library_cache.hpp"
+
+class SaveManager;
+
+/*
+ * Loads library entries (puzzle summaries, clue hashes, and saved
+ * progress) on a pool of background threads. Requests are identified
+ * by an index chosen by the caller (normally the position of the file
+ * in a list). Entries inside the priority range are loaded first, the
+ * rest in index order. Finished results are collected by the owner
+ * with take_results().
+ */
+class PuzzleInfoLoader {
+public:
+  explicit PuzzleInfoLoader(SaveManager& save_mgr,
+                            unsigned num_threads = 0);
+  PuzzleInfoLoader(const PuzzleInfoLoader&) = delete;
+  PuzzleInfoLoader(PuzzleInfoLoader&&) = delete;
+  ~PuzzleInfoLoader();
+
+  PuzzleInfoLoader& operator=(const PuzzleInfoLoader&) = delete;
+  PuzzleInfoLoader& operator=(PuzzleInfoLoader&&) = delete;
+
+  struct Result {
+    std::size_t index;
+    std::shared_ptr<LibraryEntry> entry;
+  };
+
+  /*
+   * Queue a file for loading. If known is non-null its summary and
+   * clue hash are used as-is and only the saved progress is loaded.
+   */
+  void request(std::size_t index, const std::string& path,
+               std::shared_ptr<const LibraryEntry> known = nullptr);
+
+  // Prefer requests with indices in [first, last)
+  void prioritize(std::size_t first, std::size_t last);
+
+  // Drop all pending requests and any results not yet taken
+  void clear();
+
+  // Retrieve the results finished since the last call
+  std::vector<Result> take_results();
+
+  // Check whether any requests are still pending or in progress
+  bool is_busy() const;
+
+  // Check whether there are finished results waiting to be taken
+  bool has_results() const;
+
+private:
+  struct Job {
+    std::string path;
+    std::shared_ptr<const LibraryEntry> known;
+    bool taken = false;
+  };
+
+  void work();
+  bool next_job(std::size_t& index);
+  Result load(std::size_t index, const std::string& path,
+              const LibraryEntry* known) const;
+
+  SaveManager& m_save_mgr;
+  std::vector<std::thread> m_threads;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_job_ready;
+  std::vector<Job> m_jobs; //indexed by request index
+  std::size_t m_next = 0; //first job that may still be pending
+  std::size_t m_pending = 0;
+  std::size_t m_active = 0;
+  std::size_t m_priority_first = 0;
+  std::size_t m_priority_last = 0;
+  unsigned m_generation = 0; //incremented whenever the jobs are cleared
+  std::vector<Result> m_results;
+  bool m_quit = false;
+};
+
+#endif
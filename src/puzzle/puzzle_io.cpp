@@ -21,17 +21,28 @@
 #include "puzzle/puzzle_io.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 #include "color/color_palette.hpp"
 #include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_image.hpp"
 #include "puzzle/puzzle_summary.hpp"
+#include "utility/binary_io.hpp"
+#include "utility/mapped_file.hpp"
+#include "utility/png_image.hpp"
+#include "utility/trace.hpp"
 #include "utility/utility.hpp"
 
 enum class ClueType { row, col };
@@ -46,59 +57,213 @@ struct PuzzleBlueprint {
   Puzzle::ClueContainer col_clues;
   ColorPalette palette;
   Puzzle::Properties properties;
+  PuzzleGrid grid; //only used if the format stores cell states
+  PuzzleGrid solution; //only used if the format stores the solution
 };
 
+std::string read_stream(std::istream& is);
+
+// Get a filename's extension, including the dot, in lowercase
+std::string lowercase_extension(const std::string& filename);
+
+// Throw InvalidPuzzleFile if a blueprint cannot make a usable puzzle
+void check_blueprint(const PuzzleBlueprint& blueprint);
+
 namespace non_format {
-  std::ostream& write(std::ostream& os, const Puzzle& puzzle);
+  std::ostream& write(std::ostream& os, const Puzzle& puzzle,
+                      const ColorPalette& palette);
   std::istream& read(std::istream& is, PuzzleBlueprint& blueprint);
   std::istream& skim(std::istream& is, PuzzleSummary& summary);
+
+  // Parse directly from a block of memory
+  void read(const char* begin, const char* end, PuzzleBlueprint& blueprint);
+  void skim(const char* begin, const char* end, PuzzleSummary& summary);
 }
 
 namespace g_format {
-  std::ostream& write(std::ostream& os, const Puzzle& puzzle);
+  std::ostream& write(std::ostream& os, const Puzzle& puzzle,
+                      const ColorPalette& palette);
   std::istream& read(std::istream& is, PuzzleBlueprint& blueprint);
   std::istream& skim(std::istream& is, PuzzleSummary& summary);
 }
 
 namespace mk_format {
-  std::ostream& write(std::ostream& os, const Puzzle& puzzle);
+  std::ostream& write(std::ostream& os, const Puzzle& puzzle,
+                      const ColorPalette& palette);
   std::istream& read(std::istream& is, PuzzleBlueprint& blueprint);
   std::istream& skim(std::istream& is, PuzzleSummary& summary);
 }
 
 namespace nin_format {
-  std::ostream& write(std::ostream& os, const Puzzle& puzzle);
+  std::ostream& write(std::ostream& os, const Puzzle& puzzle,
+                      const ColorPalette& palette);
   std::istream& read(std::istream& is, PuzzleBlueprint& blueprint);
   std::istream& skim(std::istream& is, PuzzleSummary& summary);
 }
 
-std::ostream& write_puzzle(std::ostream& os, Puzzle puzzle,
+namespace nbn_format {
+  std::ostream& write(std::ostream& os, const Puzzle& puzzle,
+                      const ColorPalette& palette);
+  void read(const char* begin, const char* end, PuzzleBlueprint& blueprint);
+  void skim(const char* begin, const char* end, PuzzleSummary& summary);
+  std::istream& skim(std::istream& is, PuzzleSummary& summary);
+}
+
+std::string lowercase_extension(const std::string& filename)
+{
+  auto pos = filename.rfind('.');
+  std::string extension = "";
+  if (pos != std::string::npos) {
+    extension = filename.substr(pos);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   to_lower);
+  }
+  return extension;
+}
+
+PuzzleFormat puzzle_format(const std::string& filename)
+{
+  std::string extension = lowercase_extension(filename);
+  if (extension == ".g")
+    return PuzzleFormat::g;
+  else if (extension == ".mk")
+    return PuzzleFormat::mk;
+  else if (extension == ".nin")
+    return PuzzleFormat::nin;
+  else if (extension == ".nbn")
+    return PuzzleFormat::nbn;
+  else if (extension == ".png")
+    return PuzzleFormat::png;
+  else
+    return PuzzleFormat::non;
+}
+
+bool is_puzzle_file(const std::string& filename)
+{
+  return lowercase_extension(filename) == ".non"
+    || puzzle_format(filename) != PuzzleFormat::non;
+}
+
+std::ostream& write_puzzle(std::ostream& os, const Puzzle& puzzle,
                            PuzzleFormat fmt)
 {
-  //just modifying local copy
-  puzzle.purge_unused_colors();
+  if (fmt == PuzzleFormat::png) {
+    std::string data = encode_png(puzzle_to_image(puzzle));
+    return os.write(data.data(), data.size());
+  }
+
+  //only colors used by the clues are written
+  ColorPalette palette = puzzle.used_palette();
 
   switch (fmt) {
   default:
   case PuzzleFormat::non:
-    return non_format::write(os, puzzle);
+    return non_format::write(os, puzzle, palette);
   case PuzzleFormat::g:
-    return g_format::write(os, puzzle);
+    return g_format::write(os, puzzle, palette);
   case PuzzleFormat::mk:
-    return mk_format::write(os, puzzle);
+    return mk_format::write(os, puzzle, palette);
   case PuzzleFormat::nin:
-    return nin_format::write(os, puzzle);
+    return nin_format::write(os, puzzle, palette);
+  case PuzzleFormat::nbn:
+    return nbn_format::write(os, puzzle, palette);
+  }
+}
+
+/*
+ * Read-only stream buffer over a block of memory, used to pass
+ * in-memory data to the stream-based readers.
+ */
+class MemoryBuffer : public std::streambuf {
+public:
+  MemoryBuffer(const char* data, std::size_t size)
+  {
+    char* begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+  }
+};
+
+// Read the remainder of a stream into memory
+std::string read_stream(std::istream& is)
+{
+  std::string data;
+  char block[4096];
+  while (is.read(block, sizeof(block)) || is.gcount() > 0)
+    data.append(block, is.gcount());
+  return data;
+}
+
+/*
+ * The readers tolerate missing sections and unusual color
+ * declarations, but a puzzle needs a size, a clue sequence for every
+ * line, and a palette holding the background and every clue color,
+ * with no clue drawn in the background color.
+ */
+void check_blueprint(const PuzzleBlueprint& blueprint)
+{
+  if (blueprint.width <= 0 || blueprint.height <= 0)
+    throw InvalidPuzzleFile("::check_blueprint: puzzle has no width or "
+                            "height");
+  if (blueprint.row_clues.size() != static_cast<std::size_t>(blueprint.height)
+      || blueprint.col_clues.size()
+         != static_cast<std::size_t>(blueprint.width))
+    throw InvalidPuzzleFile("::check_blueprint: number of clue lines does "
+                            "not match puzzle dimensions");
+
+  const ColorPalette& palette = blueprint.palette;
+  auto background = std::find_if(palette.begin(), palette.end(),
+                                 [](const ColorPalette::Entry& e)
+                                 { return e.name == "background"; });
+  if (background == palette.end())
+    throw InvalidPuzzleFile("::check_blueprint: background color is not "
+                            "defined");
+
+  //puzzles use few colors, so remember the ones already found
+  std::vector<Color> known;
+  for (const auto* container : { &blueprint.row_clues,
+                                 &blueprint.col_clues }) {
+    for (const auto& clues : *container) {
+      for (const auto& clue : clues) {
+        if (clue.value == 0
+            || std::find(known.begin(), known.end(), clue.color)
+               != known.end())
+          continue;
+        if (palette.find(clue.color) == palette.end()
+            || clue.color == background->color)
+          throw InvalidPuzzleFile("::check_blueprint: clue color is "
+                                  "missing from palette or is the "
+                                  "background");
+        known.push_back(clue.color);
+      }
+    }
   }
 }
 
 std::istream& read_puzzle(std::istream& is, Puzzle& puzzle,
                           PuzzleFormat fmt)
 {
+  std::string data = read_stream(is);
+  read_puzzle(data.data(), data.size(), puzzle, fmt);
+  return is;
+}
+
+void read_puzzle(const char* data, std::size_t size, Puzzle& puzzle,
+                 PuzzleFormat fmt)
+{
+  NONNY_TRACE_SCOPE("read_puzzle");
+  if (fmt == PuzzleFormat::png) {
+    image_to_puzzle(decode_png(data, size), puzzle);
+    return;
+  }
+
   PuzzleBlueprint blueprint;
+  MemoryBuffer buffer(data, size);
+  std::istream is(&buffer);
+
   switch (fmt) {
   default:
   case PuzzleFormat::non:
-    non_format::read(is, blueprint);
+    non_format::read(data, data + size, blueprint);
     break;
   case PuzzleFormat::g:
     g_format::read(is, blueprint);
@@ -109,17 +274,44 @@ std::istream& read_puzzle(std::istream& is, Puzzle& puzzle,
   case PuzzleFormat::nin:
     nin_format::read(is, blueprint);
     break;
+  case PuzzleFormat::nbn:
+    nbn_format::read(data, data + size, blueprint);
+    break;
   }
 
+  check_blueprint(blueprint);
+
+  //keep counting revisions so that nothing mistakes the new grid
+  //for one it has already seen
+  unsigned revision = puzzle.m_grid_revision;
   puzzle = Puzzle();
-  puzzle.m_grid = PuzzleGrid(blueprint.width, blueprint.height);
+  puzzle.m_grid_revision = revision;
+  if (blueprint.grid.width() == blueprint.width
+      && blueprint.grid.height() == blueprint.height)
+    puzzle.m_grid = std::move(blueprint.grid);
+  else
+    puzzle.m_grid = PuzzleGrid(blueprint.width, blueprint.height);
+  if (blueprint.solution.width() == blueprint.width
+      && blueprint.solution.height() == blueprint.height)
+    puzzle.m_solution = std::move(blueprint.solution);
   puzzle.m_row_clues = std::move(blueprint.row_clues);
   puzzle.m_col_clues = std::move(blueprint.col_clues);
   puzzle.m_palette = std::move(blueprint.palette);
   puzzle.m_properties = std::move(blueprint.properties);
 
   puzzle.refresh_all_cells();
-  return is;
+}
+
+bool read_puzzle_file(const std::string& filename, Puzzle& puzzle,
+                      PuzzleFormat fmt)
+{
+  NONNY_TRACE_SCOPE("read_puzzle_file");
+  MappedFile file(filename);
+  if (!file.is_open())
+    return false;
+
+  read_puzzle(file.data(), file.size(), puzzle, fmt);
+  return true;
 }
 
 std::istream& skim_puzzle(std::istream& is, PuzzleSummary& summary,
@@ -135,7 +327,59 @@ std::istream& skim_puzzle(std::istream& is, PuzzleSummary& summary,
     return mk_format::skim(is, summary);
   case PuzzleFormat::nin:
     return nin_format::skim(is, summary);
+  case PuzzleFormat::nbn:
+    return nbn_format::skim(is, summary);
+  case PuzzleFormat::png: {
+    char header[png_size_header_length];
+    is.read(header, sizeof(header));
+    skim_puzzle(header, is.gcount(), summary, fmt);
+    return is;
+  }
+  }
+}
+
+void skim_puzzle(const char* data, std::size_t size, PuzzleSummary& summary,
+                 PuzzleFormat fmt)
+{
+  if (fmt == PuzzleFormat::png) {
+    //converting the image is slow, so only its size is read; whether
+    //the puzzle has colors is not known until it is opened
+    int image_width, image_height;
+    read_png_size(data, size, image_width, image_height);
+    summary = PuzzleSummary();
+    import_size(image_width, image_height, ImageImportOptions(),
+                summary.width, summary.height);
+  } else if (fmt == PuzzleFormat::non) {
+    non_format::skim(data, data + size, summary);
+  } else if (fmt == PuzzleFormat::nbn) {
+    nbn_format::skim(data, data + size, summary);
+  } else {
+    MemoryBuffer buffer(data, size);
+    std::istream is(&buffer);
+    skim_puzzle(is, summary, fmt);
+  }
+}
+
+bool skim_puzzle_file(const std::string& filename, PuzzleSummary& summary,
+                      PuzzleFormat fmt)
+{
+  //the .non, .nbn and .png headers are read incrementally, so there is
+  //no need to map the whole file
+  if (fmt == PuzzleFormat::non || fmt == PuzzleFormat::nbn
+      || fmt == PuzzleFormat::png) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+      return false;
+    skim_puzzle(file, summary, fmt);
+    return true;
   }
+
+  MappedFile file(filename);
+  if (!file.is_open())
+    return false;
+
+  skim_puzzle(file.data(), file.size(), summary, fmt);
+  return true;
 }
 
 
@@ -149,13 +393,79 @@ namespace non_format {
   std::ostream& write_colors(std::ostream& os, const ColorPalette& palette);
 
   /* .non input */
-  std::istream&
-  read_clues(std::istream& is, PuzzleBlueprint& blueprint, ClueType type);
-
-  Puzzle::ClueSequence
-  parse_clue_line(const std::string& line, const ColorPalette& palette);
 
-  void parse_color(const std::string& args, ColorPalette& palette);
+  // Number of bytes read at a time when skimming from a stream
+  constexpr std::size_t skim_block_size = 4096;
+
+  /*
+   * A range of characters within an in-memory document.
+   */
+  struct TextSlice {
+    const char* begin;
+    const char* end;
+
+    bool empty() const { return begin == end; }
+    std::size_t size() const { return end - begin; }
+    std::string str() const { return std::string(begin, end); }
+  };
+
+  /*
+   * Splits an in-memory document into lines, keeping track of the
+   * current line so that errors can report where they occurred.
+   */
+  class LineReader {
+  public:
+    LineReader(const char* begin, const char* end, bool complete = true)
+      : m_pos(begin), m_end(end), m_line_start(begin),
+        m_complete(complete) { }
+
+    bool next(TextSlice& line);
+
+    // Start of the text that has not been read yet
+    const char* position() const { return m_pos; }
+
+    // Number of bytes that have not been read yet
+    std::size_t remaining() const { return m_end - m_pos; }
+
+    // Throw an InvalidPuzzleFile error pointing at pos in the current line
+    [[noreturn]] void error(const char* pos, const std::string& msg) const;
+  private:
+    const char* m_pos;
+    const char* m_end;
+    const char* m_line_start;
+    unsigned m_line = 0;
+    bool m_complete;
+  };
+
+  // Classification of characters in a clue line
+  enum class CharType : unsigned char { other, delimiter, digit, letter };
+
+  std::array<CharType, 256> make_char_types();
+  const std::array<CharType, 256> char_types = make_char_types();
+  inline CharType char_type(char c)
+  { return char_types[static_cast<unsigned char>(c)]; }
+
+  TextSlice trim(TextSlice s);
+  int hex_value(char c);
+  void split_property(TextSlice line,
+                      TextSlice& property, TextSlice& argument);
+  bool matches(TextSlice s, const char* keyword);
+  int parse_number(const LineReader& reader, TextSlice& s);
+  int parse_dimension(const LineReader& reader, TextSlice arg);
+  const Color& find_color(const LineReader& reader, TextSlice name,
+                          const ColorPalette& palette);
+
+  void read_clues(LineReader& reader,
+                  PuzzleBlueprint& blueprint, ClueType type);
+  void parse_clue_line(const LineReader& reader, TextSlice line,
+                       const ColorPalette& palette,
+                       const Color& default_color,
+                       Puzzle::ClueSequence& result);
+  void parse_color(const LineReader& reader, TextSlice args,
+                   ColorPalette& palette);
+
+  bool skim_lines(LineReader& reader, PuzzleSummary& summary,
+                  ColorPalette& palette);
 }
 
 std::ostream&
@@ -200,7 +510,8 @@ non_format::write_colors(std::ostream& os, const ColorPalette& palette)
 }
 
 std::ostream&
-non_format::write(std::ostream& os, const Puzzle& puzzle)
+non_format::write(std::ostream& os, const Puzzle& puzzle,
+                  const ColorPalette& palette)
 {
   //basic properties
   const std::string* val;
@@ -222,25 +533,173 @@ non_format::write(std::ostream& os, const Puzzle& puzzle)
      << "height " << puzzle.height() << "\n";
 
   //only write colors if they're different from defaults
-  if (puzzle.palette() != ColorPalette())
-    write_colors(os << "\n", puzzle.palette());
+  if (palette != ColorPalette())
+    write_colors(os << "\n", palette);
 
   os << "\nrows\n";
-  write_clues(os, puzzle.row_clues(), puzzle.palette());
+  write_clues(os, puzzle.row_clues(), palette);
   os << "\ncolumns\n";
-  write_clues(os, puzzle.col_clues(), puzzle.palette());
+  write_clues(os, puzzle.col_clues(), palette);
   return os;
 }
 
 
 
 /*
- * Read a series of lines containing clue numbers with color
- * specifiers.
+ * Returns the next line of the document, without its line terminator,
+ * or false if there are no complete lines left. When the reader was
+ * constructed with complete set to false, a trailing line with no
+ * newline is held back since more text may follow it.
  */
-std::istream&
-non_format::read_clues(std::istream& is,
-                       PuzzleBlueprint& blueprint, ClueType type)
+bool non_format::LineReader::next(TextSlice& line)
+{
+  if (m_pos == m_end)
+    return false;
+
+  auto newline = static_cast<const char*>
+    (std::memchr(m_pos, '\n', m_end - m_pos));
+  if (!newline && !m_complete)
+    return false;
+
+  const char* line_end = newline ? newline : m_end;
+  line.begin = m_pos;
+  line.end = line_end;
+  if (line.end != line.begin && *(line.end - 1) == '\r')
+    --line.end;
+
+  m_line_start = m_pos;
+  m_pos = newline ? newline + 1 : m_end;
+  ++m_line;
+  return true;
+}
+
+void non_format::LineReader::error(const char* pos,
+                                   const std::string& msg) const
+{
+  std::string where = "non_format::read: line " + std::to_string(m_line);
+  if (pos)
+    where += ", column " + std::to_string(pos - m_line_start + 1);
+  throw InvalidPuzzleFile(where + ": " + msg);
+}
+
+non_format::TextSlice non_format::trim(TextSlice s)
+{
+  while (s.begin != s.end && is_space(*s.begin))
+    ++s.begin;
+  while (s.end != s.begin && is_space(*(s.end - 1)))
+    --s.end;
+  return s;
+}
+
+// Value of a hexadecimal digit, or -1 if c is not one
+int non_format::hex_value(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  else if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  else if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  else
+    return -1;
+}
+
+/*
+ * Splits a line into a property name and its argument, in the same
+ * way as ::parse_property but without copying.
+ */
+void non_format::split_property(TextSlice line,
+                                TextSlice& property, TextSlice& argument)
+{
+  line = trim(line);
+  property.begin = line.begin;
+  property.end = std::find_if(line.begin, line.end, is_space);
+  argument = trim(TextSlice{property.end, line.end});
+}
+
+// Case-insensitive comparison against a lowercase keyword
+bool non_format::matches(TextSlice s, const char* keyword)
+{
+  for (const char* c = s.begin; c != s.end; ++c, ++keyword) {
+    if (!*keyword || to_lower(*c) != *keyword)
+      return false;
+  }
+  return !*keyword;
+}
+
+std::array<non_format::CharType, 256> non_format::make_char_types()
+{
+  std::array<CharType, 256> types;
+  for (int i = 0; i < 256; ++i) {
+    char c = static_cast<char>(i);
+    if (is_digit(c))
+      types[i] = CharType::digit;
+    else if (is_alpha(c))
+      types[i] = CharType::letter;
+    else if (is_space(c) || c == ',' || c == ':')
+      types[i] = CharType::delimiter;
+    else
+      types[i] = CharType::other;
+  }
+  return types;
+}
+
+/*
+ * Reads a nonnegative decimal number from the start of the slice,
+ * advancing past the digits that were read.
+ */
+int non_format::parse_number(const LineReader& reader, TextSlice& s)
+{
+  if (s.empty() || !is_digit(*s.begin))
+    reader.error(s.begin, "expected a number");
+
+  const char* start = s.begin;
+  int value = 0;
+  while (s.begin != s.end && is_digit(*s.begin)) {
+    //check before multiplying, since long may be no wider than int
+    int digit = *s.begin - '0';
+    if (value > (std::numeric_limits<int>::max() - digit) / 10)
+      reader.error(start, "number is too large");
+    value = value * 10 + digit;
+    ++s.begin;
+  }
+  return value;
+}
+
+/*
+ * Reads a puzzle dimension, which must be a number with nothing
+ * following it.
+ */
+int non_format::parse_dimension(const LineReader& reader, TextSlice arg)
+{
+  int value = parse_number(reader, arg);
+  if (!arg.empty())
+    reader.error(arg.begin, "unexpected text after puzzle dimension");
+  return value;
+}
+
+/*
+ * Looks up a color by name without building a temporary string.
+ */
+const Color& non_format::find_color(const LineReader& reader,
+                                    TextSlice name,
+                                    const ColorPalette& palette)
+{
+  for (const auto& entry : palette) {
+    if (entry.name.size() == name.size()
+        && std::equal(name.begin, name.end, entry.name.begin()))
+      return entry.color;
+  }
+
+  reader.error(name.begin, "color " + name.str() + " is not defined");
+}
+
+/*
+ * Reads a series of lines containing clue numbers with color
+ * specifiers. Lines that contain no clue numbers are skipped.
+ */
+void non_format::read_clues(LineReader& reader,
+                            PuzzleBlueprint& blueprint, ClueType type)
 {
   Puzzle::ClueContainer* clues = nullptr;
   int count = 0;
@@ -252,23 +711,33 @@ non_format::read_clues(std::istream& is,
     count = blueprint.width;
   }
 
-  std::string line;
+  //every clue line takes at least one byte, which bounds the space
+  //needed even if the stated dimensions are absurd
+  if (count > 0)
+    clues->reserve(clues->size()
+                   + std::min<std::size_t>(count, reader.remaining()));
+  static const char default_name[] = "black";
+  const Color& default_color
+    = find_color(reader, TextSlice{default_name, default_name + 5},
+                 blueprint.palette);
+
+  //clues are collected in a scratch sequence so that each stored
+  //sequence is allocated once at its final size
+  Puzzle::ClueSequence clue_seq;
+  TextSlice line;
   while (count > 0) {
-    if (!std::getline(is, line))
-      throw InvalidPuzzleFile("non_format::read_clues: "
-                              "number of clue lines "
-                              "does not match puzzle dimensions");
+    if (!reader.next(line))
+      reader.error(nullptr, "number of clue lines "
+                   "does not match puzzle dimensions");
 
-    auto clue_seq
-      = parse_clue_line(line, blueprint.palette);
+    parse_clue_line(reader, line, blueprint.palette, default_color,
+                    clue_seq);
 
     if (!clue_seq.empty()) {
-      if (clues) clues->push_back(std::move(clue_seq));
+      clues->emplace_back(clue_seq.begin(), clue_seq.end());
       --count;
     }
   }
-
-  return is;
 }
 
 /*
@@ -288,32 +757,45 @@ non_format::read_clues(std::istream& is,
  * start of each line is "default" which is usually an alias for
  * black.
  */
-Puzzle::ClueSequence
-non_format::parse_clue_line(const std::string& line,
-                            const ColorPalette& palette)
+void non_format::parse_clue_line(const LineReader& reader, TextSlice line,
+                                 const ColorPalette& palette,
+                                 const Color& default_color,
+                                 Puzzle::ClueSequence& result)
 {
-  Puzzle::ClueSequence result;
-  std::vector<std::string> clue_strs;
-  split(line, std::back_inserter(clue_strs), ",: \t\v\f");
+  result.clear();
 
-  Color color = palette["black"];
+  const Color* color = &default_color;
   PuzzleClue clue;
-  for (auto& s : clue_strs) {
-    if (!s.empty() && is_digit(s[0])) { //read clue number
-      std::size_t chars_read = 0;
-      clue.value = str_to_uint(s, &chars_read);
-      clue.color = color;
+  const char* pos = line.begin;
+  while (pos != line.end) {
+    CharType type = char_type(*pos);
+    if (type == CharType::delimiter) {
+      ++pos;
+      continue;
+    }
+
+    if (type == CharType::digit) { //read clue number
+      TextSlice number{pos, line.end};
+      clue.value = parse_number(reader, number);
+      clue.color = *color;
       result.push_back(clue);
 
-      s.erase(0, chars_read); //in case there's a color trailing the number
+      //a color name may follow the number without a delimiter
+      pos = number.begin;
+      if (pos == line.end)
+        break;
+      type = char_type(*pos);
     }
 
-    if (!s.empty() && is_alpha(s[0])) { //read color
-      color = palette[s];
-    }
-  }
+    const char* token_end = pos;
+    while (token_end != line.end
+           && char_type(*token_end) != CharType::delimiter)
+      ++token_end;
 
-  return result;
+    if (type == CharType::letter) //read color
+      color = &find_color(reader, TextSlice{pos, token_end}, palette);
+    pos = token_end;
+  }
 }
 
 /*
@@ -325,86 +807,147 @@ non_format::parse_clue_line(const std::string& line,
  * where symbol is an optional character to be used in reading or
  * generating puzzle solutions.
  */
-void
-non_format::parse_color(const std::string& args, ColorPalette& palette)
+void non_format::parse_color(const LineReader& reader, TextSlice args,
+                             ColorPalette& palette)
 {
-  std::string name;
-  Color value;
-  char symbol;
-  std::istringstream ss(args);
+  TextSlice name{args.begin, std::find_if(args.begin, args.end, is_space)};
+  if (name.empty())
+    reader.error(args.begin, "expected a color name");
+
+  TextSlice value = trim(TextSlice{name.end, args.end});
+  int components[3];
+  for (int& comp : components) {
+    comp = 0;
+    for (int i = 0; i < 2; ++i, ++value.begin) {
+      int digit = value.empty() ? -1 : hex_value(*value.begin);
+      if (digit < 0)
+        reader.error(value.begin, "expected a hexadecimal color value");
+      comp = comp * 16 + digit;
+    }
+  }
 
-  ss >> name >> value >> symbol;
-  palette.add(value, name, symbol);
+  TextSlice rest = trim(value);
+  char symbol = rest.empty() ? '\0' : *rest.begin;
+  palette.add(Color(components[0], components[1], components[2]),
+              name.str(), symbol);
 }
 
-std::istream&
-non_format::read(std::istream& is, PuzzleBlueprint& blueprint)
+void non_format::read(const char* begin, const char* end,
+                      PuzzleBlueprint& blueprint)
 {
-  std::string line;
-  while (std::getline(is, line)) {
-    auto p = parse_property(line);
-    std::string& property = p.first;
-    std::string& argument = p.second;
+  LineReader reader(begin, end);
+  TextSlice line, property, argument;
+  while (reader.next(line)) {
+    split_property(line, property, argument);
+    if (property.empty())
+      continue;
 
     //"rows" or "columns" with an argument is an alias for width/height
-    if (property == "rows" && !argument.empty())
-      property = "width";
-    else if (property == "columns" && !argument.empty())
-      property = "height";
-
-    //see if we're reading dimensions
-    int* dimension = nullptr;
-    if (property == "width")
-      dimension = &blueprint.width;
-    else if (property == "height")
-      dimension = &blueprint.height;
-
-    if (dimension) {
-      try {
-        *dimension = str_to_uint(argument);
-      } catch (const std::logic_error&) {
-        throw InvalidPuzzleFile("non_format::read: invalid puzzle "
-                                + property);
-      }
-    } else if (property == "rows" && argument.empty())
-      read_clues(is, blueprint, ClueType::row);
-    else if (property == "columns" && argument.empty())
-      read_clues(is, blueprint, ClueType::col);
-    else if (property == "color")
-      parse_color(argument, blueprint.palette);
-    else
-      blueprint.properties[property] = argument;
+    if (matches(property, "width")
+        || (matches(property, "rows") && !argument.empty()))
+      blueprint.width = parse_dimension(reader, argument);
+    else if (matches(property, "height")
+             || (matches(property, "columns") && !argument.empty()))
+      blueprint.height = parse_dimension(reader, argument);
+    else if (matches(property, "rows"))
+      read_clues(reader, blueprint, ClueType::row);
+    else if (matches(property, "columns"))
+      read_clues(reader, blueprint, ClueType::col);
+    else if (matches(property, "color"))
+      parse_color(reader, argument, blueprint.palette);
+    else {
+      std::string name;
+      name.reserve(property.size());
+      std::transform(property.begin, property.end,
+                     std::back_inserter(name), to_lower);
+      blueprint.properties[name] = escape(argument.str());
+    }
   }
+}
 
+std::istream&
+non_format::read(std::istream& is, PuzzleBlueprint& blueprint)
+{
+  std::string data = read_stream(is);
+  read(data.data(), data.data() + data.size(), blueprint);
   return is;
 }
 
+/*
+ * Collects summary information from the header lines available to the
+ * reader. Returns true once the first block of clues is reached,
+ * since nothing after that point is needed.
+ */
+bool non_format::skim_lines(LineReader& reader, PuzzleSummary& summary,
+                            ColorPalette& palette)
+{
+  TextSlice line, property, argument;
+  while (reader.next(line)) {
+    split_property(line, property, argument);
+
+    if (matches(property, "title"))
+      summary.title = escape(argument.str());
+    else if (matches(property, "by"))
+      summary.author = escape(argument.str());
+    else if (matches(property, "collection"))
+      summary.collection = escape(argument.str());
+    else if (matches(property, "id"))
+      summary.id = escape(argument.str());
+    else if (matches(property, "color"))
+      parse_color(reader, argument, palette);
+    else if (matches(property, "width") || matches(property, "rows")) {
+      if (argument.empty())
+        return true;
+      summary.width = parse_dimension(reader, argument);
+    } else if (matches(property, "height")
+               || matches(property, "columns")) {
+      if (argument.empty())
+        return true;
+      summary.height = parse_dimension(reader, argument);
+    }
+  }
+  return false;
+}
+
+void non_format::skim(const char* begin, const char* end,
+                      PuzzleSummary& summary)
+{
+  ColorPalette palette;
+  try {
+    LineReader reader(begin, end);
+    skim_lines(reader, summary, palette);
+  } catch (const std::exception&) { } //ignore file errors
+
+  summary.is_multicolor = palette.size() > 2;
+}
+
+/*
+ * Reads the stream a block at a time, stopping as soon as the header
+ * has been read.
+ */
 std::istream&
 non_format::skim(std::istream& is, PuzzleSummary& summary)
 {
+  ColorPalette palette;
   try {
-    std::string line;
-    while (std::getline(is, line)) {
-      auto p = parse_property(line);
-      if (p.first == "title")
-        summary.title = p.second;
-      else if (p.first == "by")
-        summary.author = p.second;
-      else if (p.first == "width")
-        summary.width = str_to_uint(p.second);
-      else if (p.first == "height")
-        summary.height = str_to_uint(p.second);
-      else if (p.first == "collection")
-        summary.collection = p.second;
-      else if (p.first == "id")
-        summary.id = p.second;
-      else if (p.first == "rows" && !p.second.empty())
-        summary.width = str_to_uint(p.second);
-      else if (p.first == "columns" && !p.second.empty())
-        summary.height = str_to_uint(p.second);
+    std::vector<char> buffer;
+    bool done = false;
+    while (!done) {
+      std::size_t old_size = buffer.size();
+      buffer.resize(old_size + skim_block_size);
+      is.read(buffer.data() + old_size, skim_block_size);
+      buffer.resize(old_size + is.gcount());
+      bool at_end = !is;
+
+      LineReader reader(buffer.data(), buffer.data() + buffer.size(),
+                        at_end);
+      done = skim_lines(reader, summary, palette) || at_end;
+      buffer.erase(buffer.begin(),
+                   buffer.begin() + (reader.position() - buffer.data()));
     }
   } catch (const std::exception&) { } //ignore file errors
 
+  summary.is_multicolor = palette.size() > 2;
   return is;
 }
 
@@ -436,7 +979,8 @@ namespace g_format {
 }
 
 std::ostream&
-g_format::write(std::ostream& os, const Puzzle& puzzle)
+g_format::write(std::ostream& os, const Puzzle& puzzle,
+                const ColorPalette& palette)
 {
   const std::string* cat = puzzle.find_property("catalogue");
   const std::string* title = puzzle.find_property("title");
@@ -456,15 +1000,15 @@ g_format::write(std::ostream& os, const Puzzle& puzzle)
     os << *copy << "\n";
 
   std::map<std::string, char> short_names;
-  generate_short_color_names(puzzle.palette(), short_names);
+  generate_short_color_names(palette, short_names);
 
   os << "#d\n";
-  write_colors(os, puzzle.palette(), short_names);
+  write_colors(os, palette, short_names);
 
   os << ": rows\n";
-  write_clues(os, puzzle.row_clues(), puzzle.palette(), short_names);
+  write_clues(os, puzzle.row_clues(), palette, short_names);
   os << ": columns\n";
-  write_clues(os, puzzle.col_clues(), puzzle.palette(), short_names);
+  write_clues(os, puzzle.col_clues(), palette, short_names);
 
   return os;
 }
@@ -476,18 +1020,21 @@ g_format::generate_short_color_names(const ColorPalette& palette,
   std::string used = "";
   char next = 'a';
   for (const auto& c : palette) {
-    const std::string& name = c.name;
-    auto pos = name.find_first_not_of(used);
-    char sn = next;
-    if (pos != std::string::npos)
-      sn = name[pos];
-    else {
+    //short names follow clue numbers, so only letters can be used
+    char sn = 0;
+    for (char ch : c.name) {
+      if (is_alpha(ch) && used.find(ch) == std::string::npos) {
+        sn = ch;
+        break;
+      }
+    }
+    if (!sn) {
       while (used.find(next) != std::string::npos && next < 'z')
         ++next;
       sn = next;
     }
 
-    short_names[name] = sn;
+    short_names[c.name] = sn;
     used.push_back(sn);
   }
 }
@@ -614,11 +1161,15 @@ g_format::read_colors(std::istream& is,
     ss >> color_str;
     std::getline(ss, name);
     name = trim(name);
+    if (name.empty() && inchar != '0')
+      throw InvalidPuzzleFile("g_format::read_colors: color has no name");
 
     Color color;
     if (!color_str.empty() && color_str[0] == '#') {
       std::istringstream css(color_str.substr(1, 6));
-      css >> color;
+      if (!(css >> color))
+        throw InvalidPuzzleFile("g_format::read_colors: invalid color "
+                                + color_str);
     } else {
       if (color_str == "black")
         color = default_colors::black;
@@ -660,6 +1211,14 @@ g_format::read_clues(std::istream& is,
     size = &blueprint.width;
   }
 
+  //clues without a color use the palette's black, which the color
+  //declarations may have redefined
+  Color default_color = default_colors::black;
+  for (const auto& entry : blueprint.palette) {
+    if (entry.name == "black")
+      default_color = entry.color;
+  }
+
   std::string line;
   while (std::getline(is, line)) {
     if (!line.empty() && line[0] == ':')
@@ -671,7 +1230,7 @@ g_format::read_clues(std::istream& is,
     while (ss >> value) {
       PuzzleClue clue;
       clue.value = value;
-      clue.color = default_colors::black;
+      clue.color = default_color;
 
       if (ss.good()) {
         char c = ss.get();
@@ -681,7 +1240,9 @@ g_format::read_clues(std::istream& is,
           clue.color = blueprint.palette[color_names.at('1')];
       }
 
-      cseq.push_back(clue);
+      //zeros only mark empty lines, which are handled below
+      if (value != 0)
+        cseq.push_back(clue);
     }
 
     //handle empty lines
@@ -755,7 +1316,8 @@ namespace mk_format {
 }
 
 std::ostream&
-mk_format::write(std::ostream& os, const Puzzle& puzzle)
+mk_format::write(std::ostream& os, const Puzzle& puzzle,
+                 const ColorPalette&)
 {
   if (puzzle.is_multicolor())
     throw UnsupportedFeature("mk_format::write: multicolor puzzles are "
@@ -878,8 +1440,13 @@ mk_format::skim(std::istream& is, PuzzleSummary& summary)
 
 
 std::ostream&
-nin_format::write(std::ostream& os, const Puzzle& puzzle)
+nin_format::write(std::ostream& os, const Puzzle& puzzle,
+                  const ColorPalette&)
 {
+  if (puzzle.is_multicolor())
+    throw UnsupportedFeature("nin_format::write: multicolor puzzles are "
+                             "not supported by .nin format");
+
   //format is same as .mk except for the first line
   os << puzzle.width() << " " << puzzle.height() << "\n";
   mk_format::write_clues(os, puzzle.row_clues());
@@ -923,3 +1490,496 @@ nin_format::skim(std::istream& is, PuzzleSummary& summary)
 
   return is;
 }
+
+
+/* .nbn format */
+
+namespace nbn_format {
+  /*
+   * Layout of the fixed-size header at the start of every file. All
+   * integers are little-endian.
+   *
+   *   offset  size  field
+   *        0     4  magic number
+   *        4     2  format version
+   *        6     2  flags
+   *        8     4  header size (offset of the summary block)
+   *       12     4  puzzle width
+   *       16     4  puzzle height
+   *       20     4  number of palette entries
+   *       24     4  size of the summary block
+   *       28     4  size of the data block
+   *
+   * The summary block holds the title, author, collection, and id as
+   * length-prefixed strings, so a puzzle can be skimmed by reading the
+   * header and summary alone. The data block holds the remaining
+   * properties, the palette, varint-encoded clues, and optionally a
+   * grid packed at a few bits per cell. The grid is the puzzle's
+   * solution unless the progress_grid flag marks it as a player's
+   * progress; only then is it loaded into the play grid.
+   */
+  const char magic[4] = { 'N', 'B', 'N', '\x1a' };
+  constexpr unsigned version = 1;
+  constexpr std::size_t header_size = 32;
+
+  // Largest header and summary that skim will read from a stream
+  constexpr std::uint32_t max_skim_size = 1 << 20;
+
+  // Values for the flags field
+  constexpr unsigned has_grid = 0x1;
+  constexpr unsigned single_clue_color = 0x2;
+  constexpr unsigned progress_grid = 0x4;
+
+  // Properties that are stored in the summary block
+  const char* const summary_properties[] = {
+    "title", "by", "collection", "id"
+  };
+
+  /*
+   * Header fields, without the magic number and header size which are
+   * checked on reading.
+   */
+  struct Header {
+    unsigned version = 0;
+    unsigned flags = 0;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t num_colors = 0;
+    std::uint32_t summary_size = 0;
+    std::uint32_t data_size = 0;
+  };
+
+  /* .nbn output */
+  void write_header(std::string& buf, const Header& header);
+  void write_clues(std::string& buf, const Puzzle::ClueContainer& clues,
+                   const std::vector<Color>& colors, bool with_color);
+  bool write_grid(std::string& buf, const PuzzleGrid& grid,
+                  const std::vector<Color>& colors);
+
+  /* .nbn input */
+  Header read_header(ByteReader& reader);
+  void read_summary(ByteReader& reader, PuzzleSummary& summary);
+  void read_clues(ByteReader& reader, Puzzle::ClueContainer& clues,
+                  std::size_t count, const std::vector<Color>& colors,
+                  const Color* single_color);
+  void read_grid(ByteReader& reader, PuzzleGrid& grid,
+                 const std::vector<Color>& colors);
+
+  // Number of bits used for each cell of a grid
+  unsigned bits_per_cell(std::size_t num_colors);
+}
+
+void nbn_format::write_header(std::string& buf, const Header& header)
+{
+  buf.append(magic, sizeof(magic));
+  put_u16(buf, header.version);
+  put_u16(buf, header.flags);
+  put_u32(buf, header_size);
+  put_u32(buf, header.width);
+  put_u32(buf, header.height);
+  put_u32(buf, header.num_colors);
+  put_u32(buf, header.summary_size);
+  put_u32(buf, header.data_size);
+}
+
+void nbn_format::write_clues(std::string& buf,
+                             const Puzzle::ClueContainer& clues,
+                             const std::vector<Color>& colors,
+                             bool with_color)
+{
+  for (const auto& seq : clues) {
+    put_varint(buf, seq.size());
+    for (const auto& clue : seq) {
+      put_varint(buf, clue.value);
+      if (with_color) {
+        auto it = std::find(colors.begin(), colors.end(), clue.color);
+        if (it == colors.end())
+          throw InvalidPuzzleFile("nbn_format::write_clues: "
+                                  "clue color is not in palette");
+        put_varint(buf, it - colors.begin());
+      }
+    }
+  }
+}
+
+/*
+ * Packs the grid into the buffer, with each cell stored as 0 for a
+ * blank cell, 1 for a crossed-out cell, or 2 plus the palette index of
+ * a filled cell. Returns false without writing anything if the grid
+ * uses a color that is not in the palette.
+ */
+bool nbn_format::write_grid(std::string& buf, const PuzzleGrid& grid,
+                            const std::vector<Color>& colors)
+{
+  unsigned bits = bits_per_cell(colors.size());
+  std::string packed;
+  unsigned accum = 0, num_bits = 0;
+  for (int y = 0; y < grid.height(); ++y) {
+    for (int x = 0; x < grid.width(); ++x) {
+      const PuzzleCell& cell = grid.at(x, y);
+      unsigned code = 0;
+      if (cell.state == PuzzleCell::State::crossed_out) {
+        code = 1;
+      } else if (cell.state == PuzzleCell::State::filled) {
+        auto it = std::find(colors.begin(), colors.end(), cell.color);
+        if (it == colors.end())
+          return false;
+        code = 2 + (it - colors.begin());
+      }
+
+      accum |= code << num_bits;
+      num_bits += bits;
+      while (num_bits >= 8) {
+        put_u8(packed, accum);
+        accum >>= 8;
+        num_bits -= 8;
+      }
+    }
+  }
+  if (num_bits > 0)
+    put_u8(packed, accum);
+
+  buf += packed;
+  return true;
+}
+
+std::ostream& nbn_format::write(std::ostream& os, const Puzzle& puzzle,
+                                const ColorPalette& palette)
+{
+  std::vector<Color> colors;
+  for (const auto& entry : palette)
+    colors.push_back(entry.color);
+
+  //clue colors can be left out if they are all the same
+  const Color* single_color = nullptr;
+  bool uniform = true;
+  for (const auto* clues : { &puzzle.row_clues(), &puzzle.col_clues() }) {
+    for (const auto& seq : *clues) {
+      for (const auto& clue : seq) {
+        if (!single_color)
+          single_color = &clue.color;
+        else if (clue.color != *single_color)
+          uniform = false;
+      }
+    }
+  }
+
+  Header header;
+  header.version = version;
+  header.width = puzzle.width();
+  header.height = puzzle.height();
+  header.num_colors = colors.size();
+
+  std::string summary;
+  for (const char* property : summary_properties) {
+    const std::string* value = puzzle.find_property(property);
+    put_string(summary, value ? *value : std::string());
+  }
+
+  std::string data;
+  std::size_t num_properties = 0;
+  for (const auto& property : puzzle.properties())
+    if (std::find(std::begin(summary_properties),
+                  std::end(summary_properties), property.first)
+        == std::end(summary_properties))
+      ++num_properties;
+
+  put_varint(data, num_properties);
+  for (const auto& property : puzzle.properties()) {
+    if (std::find(std::begin(summary_properties),
+                  std::end(summary_properties), property.first)
+        == std::end(summary_properties)) {
+      put_string(data, property.first);
+      put_string(data, property.second);
+    }
+  }
+
+  for (const auto& entry : palette) {
+    put_string(data, entry.name);
+    put_u8(data, entry.color.red());
+    put_u8(data, entry.color.green());
+    put_u8(data, entry.color.blue());
+    put_u8(data, static_cast<unsigned char>(entry.symbol));
+  }
+
+  if (uniform && single_color) {
+    auto it = std::find(colors.begin(), colors.end(), *single_color);
+    if (it != colors.end()) {
+      header.flags |= single_clue_color;
+      put_varint(data, it - colors.begin());
+    }
+  }
+
+  bool with_color = !(header.flags & single_clue_color);
+  write_clues(data, puzzle.row_clues(), colors, with_color);
+  write_clues(data, puzzle.col_clues(), colors, with_color);
+
+  //a filled-in grid is taken to be the solution, as in the editor
+  const PuzzleGrid* solution = nullptr;
+  if (!puzzle.is_clear())
+    solution = &puzzle.grid();
+  else if (puzzle.solution().width() > 0)
+    solution = &puzzle.solution();
+  if (solution && write_grid(data, *solution, colors))
+    header.flags |= has_grid;
+
+  header.summary_size = summary.size();
+  header.data_size = data.size();
+
+  std::string buf;
+  write_header(buf, header);
+  os.write(buf.data(), buf.size());
+  os.write(summary.data(), summary.size());
+  os.write(data.data(), data.size());
+  return os;
+}
+
+nbn_format::Header nbn_format::read_header(ByteReader& reader)
+{
+  if (!std::equal(std::begin(magic), std::end(magic),
+                  reader.bytes(sizeof(magic))))
+    throw InvalidPuzzleFile("nbn_format::read_header: "
+                            "not a binary puzzle file");
+
+  Header header;
+  header.version = reader.u16();
+  if (header.version > version)
+    throw UnsupportedFeature("nbn_format::read_header: binary puzzle "
+                             "version " + std::to_string(header.version)
+                             + " is not supported");
+
+  header.flags = reader.u16();
+  std::uint32_t size = reader.u32();
+  header.width = reader.u32();
+  header.height = reader.u32();
+  header.num_colors = reader.u32();
+  header.summary_size = reader.u32();
+  header.data_size = reader.u32();
+
+  //skip any fields added by later versions
+  if (size < header_size)
+    throw InvalidPuzzleFile("nbn_format::read_header: invalid header size");
+  reader.skip(size - header_size);
+
+  //grids index their cells with an int
+  constexpr unsigned max_int = std::numeric_limits<int>::max();
+  if (header.width > max_int || header.height > max_int
+      || std::uint64_t(header.width) * header.height > max_int)
+    throw InvalidPuzzleFile("nbn_format::read_header: "
+                            "invalid puzzle dimensions");
+  return header;
+}
+
+void nbn_format::read_summary(ByteReader& reader, PuzzleSummary& summary)
+{
+  summary.title = reader.string();
+  summary.author = reader.string();
+  summary.collection = reader.string();
+  summary.id = reader.string();
+}
+
+void nbn_format::read_clues(ByteReader& reader, Puzzle::ClueContainer& clues,
+                            std::size_t count,
+                            const std::vector<Color>& colors,
+                            const Color* single_color)
+{
+  //every line takes at least one byte, so a bad count fails here
+  //rather than in the allocation
+  if (count > reader.remaining())
+    throw std::out_of_range("nbn_format::read_clues: too many clue lines");
+  clues.reserve(count);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    std::uint64_t length = reader.varint();
+    if (length > reader.remaining())
+      throw std::out_of_range("nbn_format::read_clues: too many clues");
+
+    Puzzle::ClueSequence seq(static_cast<std::size_t>(length));
+    for (auto& clue : seq) {
+      std::uint64_t value = reader.varint();
+      if (value > static_cast<unsigned>(std::numeric_limits<int>::max()))
+        throw InvalidPuzzleFile("nbn_format::read_clues: "
+                                "clue value out of range");
+      clue.value = static_cast<int>(value);
+
+      if (single_color) {
+        clue.color = *single_color;
+      } else {
+        std::uint64_t index = reader.varint();
+        if (index >= colors.size())
+          throw InvalidPuzzleFile("nbn_format::read_clues: "
+                                  "invalid color index");
+        clue.color = colors[index];
+      }
+    }
+    clues.push_back(std::move(seq));
+  }
+}
+
+void nbn_format::read_grid(ByteReader& reader, PuzzleGrid& grid,
+                           const std::vector<Color>& colors)
+{
+  unsigned bits = bits_per_cell(colors.size());
+  std::uint64_t num_cells
+    = static_cast<std::uint64_t>(grid.width()) * grid.height();
+  const unsigned char* data = reinterpret_cast<const unsigned char*>
+    (reader.bytes(static_cast<std::size_t>((num_cells * bits + 7) / 8)));
+
+  unsigned mask = (1u << bits) - 1;
+  unsigned accum = 0, num_bits = 0;
+  for (int y = 0; y < grid.height(); ++y) {
+    for (int x = 0; x < grid.width(); ++x) {
+      while (num_bits < bits) {
+        accum |= static_cast<unsigned>(*data++) << num_bits;
+        num_bits += 8;
+      }
+      unsigned code = accum & mask;
+      accum >>= bits;
+      num_bits -= bits;
+
+      PuzzleCell& cell = grid.at(x, y);
+      if (code == 1) {
+        cell.state = PuzzleCell::State::crossed_out;
+      } else if (code >= 2) {
+        if (code - 2 >= colors.size())
+          throw InvalidPuzzleFile("nbn_format::read_grid: "
+                                  "invalid color index");
+        cell.state = PuzzleCell::State::filled;
+        cell.color = colors[code - 2];
+      }
+    }
+  }
+}
+
+unsigned nbn_format::bits_per_cell(std::size_t num_colors)
+{
+  unsigned bits = 1;
+  while ((std::size_t(1) << bits) < num_colors + 2)
+    ++bits;
+  return bits;
+}
+
+void nbn_format::read(const char* begin, const char* end,
+                      PuzzleBlueprint& blueprint)
+{
+  try {
+    ByteReader reader(begin, end);
+    Header header = read_header(reader);
+    if (reader.remaining() < std::uint64_t(header.summary_size)
+        + header.data_size)
+      throw InvalidPuzzleFile("nbn_format::read: file is truncated");
+
+    blueprint.width = header.width;
+    blueprint.height = header.height;
+
+    PuzzleSummary summary;
+    const char* summary_data = reader.bytes(header.summary_size);
+    ByteReader summary_reader(summary_data,
+                              summary_data + header.summary_size);
+    read_summary(summary_reader, summary);
+    const std::string* values[] = { &summary.title, &summary.author,
+                                    &summary.collection, &summary.id };
+    for (std::size_t i = 0; i < 4; ++i)
+      if (!values[i]->empty())
+        blueprint.properties[summary_properties[i]] = *values[i];
+
+    const char* data_block = reader.bytes(header.data_size);
+    ByteReader data(data_block, data_block + header.data_size);
+    std::uint64_t num_properties = data.varint();
+    for (std::uint64_t i = 0; i < num_properties; ++i) {
+      std::string name = data.string();
+      blueprint.properties[name] = data.string();
+    }
+
+    //palette entries are kept in file order for the index lookups
+    if (header.num_colors > data.remaining())
+      throw InvalidPuzzleFile("nbn_format::read: too many colors");
+    std::vector<Color> colors;
+    colors.reserve(header.num_colors);
+    blueprint.palette = ColorPalette();
+    for (std::uint32_t i = 0; i < header.num_colors; ++i) {
+      std::string name = data.string();
+      int r = data.u8(), g = data.u8(), b = data.u8();
+      char symbol = static_cast<char>(data.u8());
+      colors.emplace_back(r, g, b);
+      blueprint.palette.add(colors.back(), name, symbol);
+    }
+
+    const Color* single_color = nullptr;
+    if (header.flags & single_clue_color) {
+      std::uint64_t index = data.varint();
+      if (index >= colors.size())
+        throw InvalidPuzzleFile("nbn_format::read: invalid color index");
+      single_color = &colors[index];
+    }
+
+    read_clues(data, blueprint.row_clues, header.height, colors,
+               single_color);
+    read_clues(data, blueprint.col_clues, header.width, colors,
+               single_color);
+
+    if (header.flags & has_grid) {
+      //check the packed cells are all there before allocating the grid
+      std::uint64_t num_cells = std::uint64_t(header.width) * header.height;
+      if ((num_cells * bits_per_cell(colors.size()) + 7) / 8
+          > data.remaining())
+        throw InvalidPuzzleFile("nbn_format::read: grid is truncated");
+
+      PuzzleGrid& grid = (header.flags & progress_grid)
+        ? blueprint.grid : blueprint.solution;
+      grid = PuzzleGrid(blueprint.width, blueprint.height);
+      read_grid(data, grid, colors);
+    }
+  } catch (const std::out_of_range& e) {
+    throw InvalidPuzzleFile(std::string("nbn_format::read: "
+                                        "invalid puzzle data (")
+                            + e.what() + ")");
+  }
+}
+
+void nbn_format::skim(const char* begin, const char* end,
+                      PuzzleSummary& summary)
+{
+  try {
+    ByteReader reader(begin, end);
+    Header header = read_header(reader);
+    summary.width = header.width;
+    summary.height = header.height;
+    summary.is_multicolor = header.num_colors > 2;
+
+    const char* summary_data = reader.bytes(header.summary_size);
+    ByteReader summary_reader(summary_data,
+                              summary_data + header.summary_size);
+    read_summary(summary_reader, summary);
+  } catch (const std::exception&) { } //ignore file errors
+}
+
+/*
+ * Reads just the header and summary block from the stream.
+ */
+std::istream& nbn_format::skim(std::istream& is, PuzzleSummary& summary)
+{
+  char header[header_size];
+  if (!is.read(header, header_size))
+    return is;
+
+  std::vector<char> buffer(header, header + header_size);
+  try {
+    ByteReader reader(header, header + header_size);
+    reader.skip(8);
+    std::uint32_t size = reader.u32();
+    reader.skip(12);
+    std::uint32_t summary_size = reader.u32();
+
+    //don't trust sizes that would mean reading an unreasonable amount
+    if (size >= header_size
+        && size - header_size + summary_size <= max_skim_size) {
+      buffer.resize(size + summary_size);
+      is.read(buffer.data() + header_size, buffer.size() - header_size);
+      buffer.resize(header_size + is.gcount());
+    }
+  } catch (const std::exception&) { }
+
+  skim(buffer.data(), buffer.data() + buffer.size(), summary);
+  return is;
+}
@@ -21,6 +21,7 @@
 #ifndef NONNY_PUZZLE_IO_HPP
 #define NONNY_PUZZLE_IO_HPP
 
+#include <cstddef>
 #include <iosfwd>
 #include <stdexcept>
 #include <string>
@@ -40,16 +41,49 @@ public:
     : std::logic_error(what_arg) { }
 };
 
-enum class PuzzleFormat { non, g, mk, nin, png };
+enum class PuzzleFormat { non, g, mk, nin, nbn, png };
 
-// Read or write puzzles from/to a stream
-std::ostream& write_puzzle(std::ostream& os, Puzzle puzzle,
+// Determine a file's format from its extension, defaulting to .non
+PuzzleFormat puzzle_format(const std::string& filename);
+
+// Does a file have the extension of a puzzle format (ignoring case)?
+bool is_puzzle_file(const std::string& filename);
+
+/*
+ * Read or write puzzles from/to a stream. PNG images are converted
+ * into puzzles using the default ImageImportOptions, and writing a
+ * puzzle to PNG draws an image of its grid.
+ */
+std::ostream& write_puzzle(std::ostream& os, const Puzzle& puzzle,
                            PuzzleFormat fmt = PuzzleFormat::non);
 std::istream& read_puzzle(std::istream& is, Puzzle& puzzle,
                           PuzzleFormat fmt = PuzzleFormat::non);
 
-// Collect summary information but don't actually load the puzzle
+// Read a puzzle from a block of memory
+void read_puzzle(const char* data, std::size_t size, Puzzle& puzzle,
+                 PuzzleFormat fmt = PuzzleFormat::non);
+
+/*
+ * Read a puzzle from a file, mapping it into memory where possible.
+ * Returns false if the file could not be opened.
+ */
+bool read_puzzle_file(const std::string& filename, Puzzle& puzzle,
+                      PuzzleFormat fmt = PuzzleFormat::non);
+
+/*
+ * Collect summary information but don't actually load the puzzle. For
+ * an image, only the size of the puzzle it would become is found.
+ */
 std::istream& skim_puzzle(std::istream& is, PuzzleSummary& summary,
                           PuzzleFormat fmt = PuzzleFormat::non);
+void skim_puzzle(const char* data, std::size_t size, PuzzleSummary& summary,
+                 PuzzleFormat fmt = PuzzleFormat::non);
+
+/*
+ * Collect summary information from a file, reading only as much of it
+ * as is needed. Returns false if the file could not be opened.
+ */
+bool skim_puzzle_file(const std::string& filename, PuzzleSummary& summary,
+                      PuzzleFormat fmt = PuzzleFormat::non);
 
 #endif
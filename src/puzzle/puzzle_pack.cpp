@@ -0,0 +1,293 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "puzzle/puzzle_pack.hpp"
+
+#include <algorithm>
+#include <experimental/filesystem>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "utility/binary_io.hpp"
+#include "utility/utility.hpp"
+
+namespace stdfs = std::experimental::filesystem;
+
+/*
+ * A pack file consists of an 8-byte header (magic number and version),
+ * the puzzles themselves in .nbn format, the index, and a 24-byte
+ * footer giving the location of the index:
+ *
+ *   offset  size  field
+ *        0     8  offset of the index
+ *        8     8  size of the index
+ *       16     4  number of entries
+ *       20     4  footer magic number
+ *
+ * Each index entry holds the offset, length, and clue hash of a
+ * puzzle, followed by its dimensions, a multicolor flag, and the
+ * name, title, author, collection, and id as length-prefixed strings.
+ */
+const char pack_magic[4] = { 'N', 'P', 'K', '\x1a' };
+const char pack_footer_magic[4] = { 'N', 'P', 'K', 'I' };
+constexpr unsigned pack_version = 1;
+constexpr std::size_t pack_header_size = 8;
+constexpr std::size_t pack_footer_size = 24;
+
+// Entries take at least this many bytes in the index
+constexpr std::size_t min_entry_size = 34;
+
+PuzzlePack::PuzzlePack(const std::string& filename)
+  : m_filename(filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open())
+    throw std::runtime_error("PuzzlePack::PuzzlePack: could not open "
+                             "pack file " + filename);
+
+  read_index(file);
+}
+
+void PuzzlePack::read_index(std::istream& is)
+{
+  char header[pack_header_size];
+  if (!is.read(header, pack_header_size)
+      || !std::equal(std::begin(pack_magic), std::end(pack_magic), header))
+    throw InvalidPuzzleFile("PuzzlePack::read_index: not a pack file");
+
+  ByteReader header_reader(header + 4, header + pack_header_size);
+  unsigned version = header_reader.u16();
+  if (version > pack_version)
+    throw UnsupportedFeature("PuzzlePack::read_index: pack version "
+                             + std::to_string(version)
+                             + " is not supported");
+
+  is.seekg(0, std::ios::end);
+  std::uint64_t file_size = is.tellg();
+  if (file_size < pack_header_size + pack_footer_size)
+    throw InvalidPuzzleFile("PuzzlePack::read_index: pack is truncated");
+
+  char footer[pack_footer_size];
+  is.seekg(file_size - pack_footer_size);
+  if (!is.read(footer, pack_footer_size)
+      || !std::equal(std::begin(pack_footer_magic),
+                     std::end(pack_footer_magic), footer + 20))
+    throw InvalidPuzzleFile("PuzzlePack::read_index: pack has no index");
+
+  ByteReader footer_reader(footer, footer + pack_footer_size);
+  std::uint64_t index_offset = footer_reader.u64();
+  std::uint64_t index_size = footer_reader.u64();
+  std::uint32_t count = footer_reader.u32();
+
+  std::uint64_t index_end = file_size - pack_footer_size;
+  if (index_offset < pack_header_size || index_offset > index_end
+      || index_size != index_end - index_offset
+      || count > index_size / min_entry_size)
+    throw InvalidPuzzleFile("PuzzlePack::read_index: invalid index");
+
+  std::vector<char> index(static_cast<std::size_t>(index_size));
+  is.seekg(index_offset);
+  if (!is.read(index.data(), index.size()))
+    throw InvalidPuzzleFile("PuzzlePack::read_index: pack is truncated");
+
+  try {
+    ByteReader reader(index.data(), index.data() + index.size());
+    m_entries.resize(count);
+    for (auto& entry : m_entries) {
+      entry.offset = reader.u64();
+      entry.length = reader.u32();
+      entry.clue_hash = reader.u64();
+      std::uint32_t width = reader.u32();
+      std::uint32_t height = reader.u32();
+      if (width > std::numeric_limits<int>::max()
+          || height > std::numeric_limits<int>::max())
+        throw InvalidPuzzleFile("PuzzlePack::read_index: "
+                                "invalid puzzle dimensions");
+      entry.summary.width = width;
+      entry.summary.height = height;
+      entry.summary.is_multicolor = reader.u8() != 0;
+      entry.name = reader.string();
+      entry.summary.title = reader.string();
+      entry.summary.author = reader.string();
+      entry.summary.collection = reader.string();
+      entry.summary.id = reader.string();
+
+      if (entry.offset < pack_header_size
+          || entry.offset + entry.length > index_offset)
+        throw InvalidPuzzleFile("PuzzlePack::read_index: "
+                                "invalid puzzle location");
+    }
+  } catch (const std::out_of_range&) {
+    throw InvalidPuzzleFile("PuzzlePack::read_index: index is truncated");
+  }
+}
+
+void PuzzlePack::load(std::size_t index, Puzzle& puzzle) const
+{
+  if (index >= m_entries.size())
+    throw std::out_of_range("PuzzlePack::load: invalid puzzle index");
+
+  std::ifstream file(m_filename, std::ios::binary);
+  if (!file.is_open())
+    throw std::runtime_error("PuzzlePack::load: could not open "
+                             "pack file " + m_filename);
+
+  const PackEntry& entry = m_entries[index];
+  std::vector<char> data(entry.length);
+  file.seekg(entry.offset);
+  if (!file.read(data.data(), data.size()))
+    throw InvalidPuzzleFile("PuzzlePack::load: pack is truncated");
+
+  read_puzzle(data.data(), data.size(), puzzle, PuzzleFormat::nbn);
+}
+
+PuzzlePackWriter::PuzzlePackWriter(const std::string& filename)
+  : m_filename(filename), m_file(filename, std::ios::binary)
+{
+  if (!m_file.is_open())
+    throw std::runtime_error("PuzzlePackWriter::PuzzlePackWriter: "
+                             "could not create pack file " + filename);
+
+  std::string header(pack_magic, sizeof(pack_magic));
+  put_u16(header, pack_version);
+  put_u16(header, 0);
+  m_file.write(header.data(), header.size());
+  m_offset = header.size();
+}
+
+void PuzzlePackWriter::add(const std::string& name, const Puzzle& puzzle)
+{
+  std::ostringstream ss;
+  write_puzzle(ss, puzzle, PuzzleFormat::nbn);
+  std::string data = ss.str();
+  if (data.size() > std::numeric_limits<std::uint32_t>::max())
+    throw std::length_error("PuzzlePackWriter::add: puzzle is too large");
+
+  PackEntry entry;
+  entry.name = name;
+  entry.offset = m_offset;
+  entry.length = data.size();
+  entry.clue_hash = clue_hash(puzzle);
+  entry.summary = make_summary(puzzle);
+
+  m_file.write(data.data(), data.size());
+  m_offset += data.size();
+  m_entries.push_back(std::move(entry));
+}
+
+void PuzzlePackWriter::close()
+{
+  std::string index;
+  for (const auto& entry : m_entries) {
+    put_u64(index, entry.offset);
+    put_u32(index, entry.length);
+    put_u64(index, entry.clue_hash);
+    put_u32(index, entry.summary.width);
+    put_u32(index, entry.summary.height);
+    put_u8(index, entry.summary.is_multicolor ? 1 : 0);
+    put_string(index, entry.name);
+    put_string(index, entry.summary.title);
+    put_string(index, entry.summary.author);
+    put_string(index, entry.summary.collection);
+    put_string(index, entry.summary.id);
+  }
+
+  std::string footer;
+  put_u64(footer, m_offset);
+  put_u64(footer, index.size());
+  put_u32(footer, m_entries.size());
+  footer.append(pack_footer_magic, sizeof(pack_footer_magic));
+
+  m_file.write(index.data(), index.size());
+  m_file.write(footer.data(), footer.size());
+  m_file.close();
+  if (!m_file)
+    throw std::runtime_error("PuzzlePackWriter::close: error writing "
+                             "pack file " + m_filename);
+}
+
+/*
+ * 64-bit FNV-1a hash over the dimensions and the value and color of
+ * every clue.
+ */
+std::uint64_t clue_hash(const Puzzle& puzzle)
+{
+  std::string bytes;
+  put_u32(bytes, puzzle.width());
+  put_u32(bytes, puzzle.height());
+  for (const auto* clues : { &puzzle.row_clues(), &puzzle.col_clues() }) {
+    for (const auto& seq : *clues) {
+      put_u32(bytes, seq.size());
+      for (const auto& clue : seq) {
+        put_u32(bytes, clue.value);
+        put_u32(bytes, (clue.color.red() << 16) | (clue.color.green() << 8)
+                | clue.color.blue());
+      }
+    }
+  }
+  return fnv1a_hash(bytes.data(), bytes.size());
+}
+
+bool is_pack_file(const std::string& path)
+{
+  std::string extension = stdfs::path(path).extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 to_lower);
+  return extension == ".npk";
+}
+
+std::string pack_entry_path(const std::string& pack_filename,
+                            std::size_t index)
+{
+  return pack_filename + "#" + std::to_string(index);
+}
+
+bool split_pack_entry_path(const std::string& path,
+                           std::string& pack_filename, std::size_t& index)
+{
+  auto pos = path.rfind('#');
+  if (pos == std::string::npos || pos + 1 == path.size()
+      || !is_pack_file(path.substr(0, pos)))
+    return false;
+
+  std::size_t value = 0;
+  for (auto it = path.begin() + pos + 1; it != path.end(); ++it) {
+    if (*it < '0' || *it > '9')
+      return false;
+    value = value * 10 + (*it - '0');
+  }
+
+  pack_filename = path.substr(0, pos);
+  index = value;
+  return true;
+}
+
+std::string puzzle_path_stem(const std::string& path)
+{
+  std::string pack_filename;
+  std::size_t index;
+  if (split_pack_entry_path(path, pack_filename, index))
+    return stdfs::path(pack_filename).stem().string()
+      + "#" + std::to_string(index);
+  else
+    return stdfs::path(path).stem().string();
+}
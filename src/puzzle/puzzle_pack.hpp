@@ -0,0 +1,108 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_PUZZLE_PACK_HPP
+#define NONNY_PUZZLE_PACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "puzzle/puzzle_summary.hpp"
+
+class Puzzle;
+
+/*
+ * Index entry describing one puzzle in a pack file.
+ */
+struct PackEntry {
+  std::string name; //name of the file the puzzle was packed from
+  PuzzleSummary summary;
+  std::uint64_t offset = 0;
+  std::uint32_t length = 0;
+  std::uint64_t clue_hash = 0;
+};
+
+/*
+ * Read access to a pack file, which holds many puzzles in the binary
+ * .nbn format followed by an index. Opening a pack reads only the
+ * index, and each puzzle can then be loaded on its own.
+ */
+class PuzzlePack {
+public:
+  PuzzlePack() = default;
+
+  // Opens the pack and reads its index, throwing on failure
+  explicit PuzzlePack(const std::string& filename);
+
+  const std::string& filename() const { return m_filename; }
+  const std::vector<PackEntry>& entries() const { return m_entries; }
+  std::size_t size() const { return m_entries.size(); }
+
+  // Load the puzzle with the given index
+  void load(std::size_t index, Puzzle& puzzle) const;
+private:
+  void read_index(std::istream& is);
+
+  std::string m_filename;
+  std::vector<PackEntry> m_entries;
+};
+
+/*
+ * Writes puzzles to a new pack file. The index is written by close(),
+ * which must be called once all puzzles have been added.
+ */
+class PuzzlePackWriter {
+public:
+  explicit PuzzlePackWriter(const std::string& filename);
+
+  void add(const std::string& name, const Puzzle& puzzle);
+  void close();
+
+  const std::vector<PackEntry>& entries() const { return m_entries; }
+private:
+  std::string m_filename;
+  std::ofstream m_file;
+  std::uint64_t m_offset = 0;
+  std::vector<PackEntry> m_entries;
+};
+
+// Hash of a puzzle's dimensions and clues, for spotting duplicates
+std::uint64_t clue_hash(const Puzzle& puzzle);
+
+/*
+ * Puzzles inside a pack are referred to by paths of the form
+ * "collection.npk#12", where the number is the index of the puzzle.
+ */
+bool is_pack_file(const std::string& path);
+std::string pack_entry_path(const std::string& pack_filename,
+                            std::size_t index);
+bool split_pack_entry_path(const std::string& path,
+                           std::string& pack_filename, std::size_t& index);
+
+/*
+ * Returns the stem of a puzzle file's name, for use as an identifier
+ * when a puzzle has no id or title. Puzzles in a pack get the stem of
+ * the pack followed by their index.
+ */
+std::string puzzle_path_stem(const std::string& path);
+
+#endif
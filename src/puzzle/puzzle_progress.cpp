@@ -38,14 +38,16 @@ void PuzzleProgress::store_progress(const Puzzle& puzzle, unsigned time,
     m_cur_time = time;
 
   //reset progress state and then store progress or solution as needed
-  m_progress = PuzzleGrid();
-  PuzzleGrid* grid = update_solution ? &m_solution : &m_progress;
-  *grid = PuzzleGrid(puzzle.width(), puzzle.height());
-  for (int y = 0; y != puzzle.height(); ++y) {
-    for (int x = 0; x != puzzle.width(); ++x) {
-      grid->at(x, y) = puzzle[x][y];
-    }
-  }
+  if (update_solution) {
+    m_progress = PuzzleGrid();
+    m_solution = puzzle.grid();
+  } else
+    m_progress = puzzle.grid();
+}
+
+void PuzzleProgress::set_state(int x, int y, const PuzzleCell& cell)
+{
+  m_progress.at(x, y) = cell;
 }
 
 void PuzzleProgress::restore_progress(Puzzle& puzzle) const
@@ -85,9 +87,9 @@ std::ostream& operator<<(std::ostream& os, const PuzzleProgress& prog)
   write_time(os, prog.m_cur_time, true) << "\"\n";
 
   if (prog.m_completed)
-    os << "solution\n" << prog.solution() << "\n";
+    os << "packed_solution " << pack_grid(prog.solution()) << "\n";
 
-  os << "progress\n" << prog.state() << "\n";
+  os << "packed_progress " << pack_grid(prog.state()) << "\n";
   return os;
 }
 
@@ -107,7 +109,11 @@ std::istream& operator>>(std::istream& is, PuzzleProgress& prog)
       prog.m_best_time = string_to_time(p.second);
     else if (p.first == "time")
       prog.m_cur_time = string_to_time(p.second);
-    else if (p.first == "solution")
+    else if (p.first == "packed_solution")
+      prog.m_solution = unpack_grid(p.second);
+    else if (p.first == "packed_progress")
+      prog.m_progress = unpack_grid(p.second);
+    else if (p.first == "solution") //older saves store text grids
       is >> prog.m_solution;
     else if (p.first == "progress")
       is >> prog.m_progress;
@@ -65,6 +65,13 @@ public:
   // Restore saved solution
   void restore_solution(Puzzle& puzzle) const;
 
+  // Use a solution found elsewhere, such as one stored in a puzzle file
+  void set_solution(const PuzzleGrid& grid) { m_solution = grid; }
+
+  // Change the saved time or a single saved cell, as when replaying a journal
+  void set_current_time(unsigned time) { m_cur_time = time; }
+  void set_state(int x, int y, const PuzzleCell& cell);
+
   std::string filename() const { return m_filename; }
   bool is_complete() const { return m_completed; }
   unsigned best_time() const { return m_best_time; }
@@ -19,3 +19,23 @@
 /* Written by Gregory Kikola <gkikola@gmail.com>. */
 
 #include "puzzle/puzzle_summary.hpp"
+
+#include "puzzle/puzzle.hpp"
+
+PuzzleSummary make_summary(const Puzzle& puzzle)
+{
+  PuzzleSummary summary;
+  const std::string* value;
+  if ( (value = puzzle.find_property("title")) )
+    summary.title = *value;
+  if ( (value = puzzle.find_property("by")) )
+    summary.author = *value;
+  if ( (value = puzzle.find_property("collection")) )
+    summary.collection = *value;
+  if ( (value = puzzle.find_property("id")) )
+    summary.id = *value;
+  summary.width = puzzle.width();
+  summary.height = puzzle.height();
+  summary.is_multicolor = puzzle.is_multicolor();
+  return summary;
+}
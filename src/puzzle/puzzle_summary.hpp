@@ -23,6 +23,8 @@
 
 #include <string>
 
+class Puzzle;
+
 /*
  * Holds puzzle metadata.
  */
@@ -36,4 +38,7 @@ struct PuzzleSummary {
   bool is_multicolor = false;
 };
 
+// Collect the summary information of a loaded puzzle
+PuzzleSummary make_summary(const Puzzle& puzzle);
+
 #endif
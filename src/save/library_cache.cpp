@@ -0,0 +1,417 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "save/library_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <experimental/filesystem>
+#include <stdexcept>
+#include <system_error>
+#include "puzzle/puzzle_grid.hpp"
+#include "puzzle/puzzle_pack.hpp"
+#include "save/save_manager.hpp"
+#include "settings/game_settings.hpp"
+#include "utility/atomic_file.hpp"
+#include "utility/binary_io.hpp"
+
+namespace stdfs = std::experimental::filesystem;
+
+/*
+ * A cache file begins with a magic number, version, entry count, and
+ * the directory it describes. Each entry is stored as its name and
+ * the length of its data, so the names can be read without decoding
+ * the entries:
+ *
+ *   name         length-prefixed string
+ *   length       varint
+ *   file stamp   u64 size, u64 modification time
+ *   save stamp   u64 size, u64 modification time
+ *   clue hash    u64
+ *   flags        u8 (1 = multicolor, 2 = complete)
+ *   dimensions   varint width, varint height
+ *   times        varint best time, varint current time
+ *   strings      title, author, collection, id
+ *   thumbnail    varint width, varint height, u8 palette size,
+ *                palette as RGB triples, then one byte per pixel
+ */
+const char cache_magic[4] = { 'N', 'M', 'C', '\x1a' };
+constexpr unsigned cache_version = 1;
+const std::string cache_extension = ".nmc";
+
+void encode_entry(std::string& buf, const LibraryEntry& entry);
+LibraryEntry decode_entry(ByteReader& reader);
+void put_stamp(std::string& buf, const FileStamp& stamp);
+FileStamp read_stamp(ByteReader& reader);
+std::string cache_name(const std::string& dir);
+
+FileStamp file_stamp(const std::string& path)
+{
+  std::string pack_filename;
+  std::size_t pack_index;
+  stdfs::path p;
+  if (split_pack_entry_path(path, pack_filename, pack_index))
+    p = pack_filename;
+  else
+    p = path;
+
+  FileStamp stamp;
+  std::error_code ec;
+  auto size = stdfs::file_size(p, ec);
+  if (ec)
+    return stamp;
+  auto time = stdfs::last_write_time(p, ec);
+  if (ec)
+    return stamp;
+
+  stamp.size = size;
+  stamp.time = time.time_since_epoch().count();
+  return stamp;
+}
+
+FileStamp progress_stamp(const std::string& save_file)
+{
+  FileStamp stamp = file_stamp(save_file);
+  if (save_file.empty())
+    return stamp;
+
+  //changes appended to the journal don't touch the save file itself
+  FileStamp journal = file_stamp(SaveManager::journal_filename(save_file));
+  stamp.size += journal.size;
+  stamp.time = std::max(stamp.time, journal.time);
+  return stamp;
+}
+
+const Color* PuzzleThumbnail::at(int x, int y) const
+{
+  unsigned value = pixels[y * width + x];
+  if (value == 0 || value > palette.size())
+    return nullptr;
+  return &palette[value - 1];
+}
+
+PuzzleThumbnail make_thumbnail(const PuzzleGrid& grid)
+{
+  PuzzleThumbnail thumbnail;
+  if (grid.width() <= 0 || grid.height() <= 0)
+    return thumbnail;
+
+  //scale large grids down, keeping their shape
+  int size = std::max(grid.width(), grid.height());
+  if (size > PuzzleThumbnail::max_size) {
+    thumbnail.width = std::max(1, grid.width()
+                               * PuzzleThumbnail::max_size / size);
+    thumbnail.height = std::max(1, grid.height()
+                                * PuzzleThumbnail::max_size / size);
+  } else {
+    thumbnail.width = grid.width();
+    thumbnail.height = grid.height();
+  }
+
+  thumbnail.pixels.resize(thumbnail.width * thumbnail.height);
+  for (int y = 0; y < thumbnail.height; ++y) {
+    for (int x = 0; x < thumbnail.width; ++x) {
+      const PuzzleCell& cell = grid.at(x * grid.width() / thumbnail.width,
+                                       y * grid.height() / thumbnail.height);
+      if (cell.state != PuzzleCell::State::filled)
+        continue;
+
+      auto it = std::find(thumbnail.palette.begin(),
+                          thumbnail.palette.end(), cell.color);
+      if (it == thumbnail.palette.end()) {
+        if (thumbnail.palette.size() == 255) //out of room, use last color
+          --it;
+        else
+          it = thumbnail.palette.insert(it, cell.color);
+      }
+      thumbnail.pixels[y * thumbnail.width + x]
+        = static_cast<std::uint8_t>(it - thumbnail.palette.begin() + 1);
+    }
+  }
+
+  return thumbnail;
+}
+
+LibraryCache::LibraryCache(const GameSettings& settings,
+                           const std::string& dir)
+  : m_dir(dir)
+{
+  if (dir.empty())
+    return;
+
+  m_filename = settings.library_cache_dir();
+  m_filename += settings.filesystem_separator();
+  m_filename += cache_name(dir);
+
+  m_file.open(m_filename);
+  try {
+    read_names();
+  } catch (const std::exception&) { //start over if the cache is damaged
+    m_offsets.clear();
+    m_changed = true;
+  }
+}
+
+bool LibraryCache::find(const std::string& path, const FileStamp& stamp,
+                        const SaveManager& save_mgr, LibraryEntry& entry)
+{
+  std::string name = stdfs::path(path).filename().string();
+
+  auto update = m_updates.find(name);
+  if (update != m_updates.end()) {
+    entry = update->second;
+  } else {
+    auto offset = m_offsets.find(name);
+    if (offset == m_offsets.end())
+      return false;
+
+    if (m_used.insert(name).second)
+      ++m_num_used_offsets;
+
+    try {
+      const char* data = m_file.data() + offset->second.first;
+      ByteReader reader(data, data + offset->second.second);
+      entry = decode_entry(reader);
+    } catch (const std::exception&) {
+      return false;
+    }
+  }
+
+  if (stamp.size == 0 || entry.file_stamp != stamp)
+    return false;
+  if (save_mgr.is_save_queued(path)) //progress is about to change
+    return false;
+
+  std::string collection, id;
+  SaveManager::progress_key(entry.summary, path, collection, id);
+  std::string save_file = save_mgr.find_progress_file(path, collection, id);
+  return progress_stamp(save_file) == entry.save_stamp;
+}
+
+void LibraryCache::store(const std::string& path, const LibraryEntry& entry)
+{
+  std::string name = stdfs::path(path).filename().string();
+  m_updates[name] = entry;
+  m_used.insert(name);
+  m_changed = true;
+}
+
+void LibraryCache::write()
+{
+  if (m_filename.empty())
+    return;
+  //nothing new, and no entries to drop
+  if (!m_changed && m_num_used_offsets == m_offsets.size())
+    return;
+
+  std::string entries;
+  std::uint32_t count = 0;
+  for (const auto& name : m_used) {
+    std::string data;
+    auto update = m_updates.find(name);
+    if (update != m_updates.end()) {
+      encode_entry(data, update->second);
+    } else {
+      auto offset = m_offsets.find(name);
+      if (offset == m_offsets.end())
+        continue;
+      data.assign(m_file.data() + offset->second.first,
+                  offset->second.second);
+    }
+
+    put_string(entries, name);
+    put_varint(entries, data.size());
+    entries += data;
+    ++count;
+  }
+
+  std::string header(cache_magic, sizeof(cache_magic));
+  put_u16(header, cache_version);
+  put_u16(header, 0);
+  put_u32(header, count);
+  put_string(header, m_dir);
+
+  std::error_code ec;
+  stdfs::path dir = stdfs::path(m_filename).parent_path();
+  stdfs::create_directories(dir, ec);
+
+  try {
+    write_file_atomic(m_filename, header + entries);
+  } catch (const std::runtime_error&) {
+    return;
+  }
+
+  //everything in memory is now on disk
+  m_file.open(m_filename);
+  m_offsets.clear();
+  m_updates.clear();
+  m_used.clear();
+  m_num_used_offsets = 0;
+  m_changed = false;
+  try {
+    read_names();
+  } catch (const std::exception&) {
+    m_offsets.clear();
+  }
+  for (const auto& entry : m_offsets)
+    m_used.insert(entry.first);
+  m_num_used_offsets = m_offsets.size();
+}
+
+void LibraryCache::read_names()
+{
+  if (!m_file.is_open() || m_file.size() == 0)
+    return;
+
+  ByteReader reader(m_file.data(), m_file.data() + m_file.size());
+  if (std::memcmp(reader.bytes(sizeof(cache_magic)), cache_magic,
+                  sizeof(cache_magic)) != 0)
+    throw std::runtime_error("LibraryCache::read_names: not a cache file");
+  if (reader.u16() != cache_version)
+    throw std::runtime_error("LibraryCache::read_names: "
+                             "unsupported cache version");
+  reader.u16();
+  std::uint32_t count = reader.u32();
+  if (reader.string() != m_dir) //another directory with the same hash
+    throw std::runtime_error("LibraryCache::read_names: "
+                             "cache is for a different directory");
+
+  for (std::uint32_t i = 0; i < count; ++i) {
+    std::string name = reader.string();
+    std::uint64_t length = reader.varint();
+    if (length > reader.remaining())
+      throw std::out_of_range("LibraryCache::read_names: "
+                              "cache file is truncated");
+    std::size_t offset = reader.position() - m_file.data();
+    reader.skip(length);
+    m_offsets[name] = std::make_pair(offset, std::size_t(length));
+  }
+}
+
+void encode_entry(std::string& buf, const LibraryEntry& entry)
+{
+  put_stamp(buf, entry.file_stamp);
+  put_stamp(buf, entry.save_stamp);
+  put_u64(buf, entry.clue_hash);
+
+  unsigned flags = 0;
+  if (entry.summary.is_multicolor)
+    flags |= 1;
+  if (entry.is_complete)
+    flags |= 2;
+  put_u8(buf, flags);
+
+  put_varint(buf, entry.summary.width);
+  put_varint(buf, entry.summary.height);
+  put_varint(buf, entry.best_time);
+  put_varint(buf, entry.current_time);
+  put_string(buf, entry.summary.title);
+  put_string(buf, entry.summary.author);
+  put_string(buf, entry.summary.collection);
+  put_string(buf, entry.summary.id);
+
+  const PuzzleThumbnail& thumbnail = entry.thumbnail;
+  put_varint(buf, thumbnail.width);
+  put_varint(buf, thumbnail.height);
+  put_u8(buf, thumbnail.palette.size());
+  for (const auto& color : thumbnail.palette) {
+    put_u8(buf, color.red());
+    put_u8(buf, color.green());
+    put_u8(buf, color.blue());
+  }
+  buf.append(thumbnail.pixels.begin(), thumbnail.pixels.end());
+}
+
+LibraryEntry decode_entry(ByteReader& reader)
+{
+  LibraryEntry entry;
+  entry.file_stamp = read_stamp(reader);
+  entry.save_stamp = read_stamp(reader);
+  entry.clue_hash = reader.u64();
+
+  unsigned flags = reader.u8();
+  entry.summary.is_multicolor = flags & 1;
+  entry.is_complete = flags & 2;
+
+  std::uint64_t width = reader.varint();
+  std::uint64_t height = reader.varint();
+  std::uint64_t best_time = reader.varint();
+  std::uint64_t current_time = reader.varint();
+  if (width > 0xffff || height > 0xffff
+      || best_time > 0xffffffff || current_time > 0xffffffff)
+    throw std::out_of_range("decode_entry: value out of range");
+  entry.summary.width = width;
+  entry.summary.height = height;
+  entry.best_time = best_time;
+  entry.current_time = current_time;
+
+  entry.summary.title = reader.string();
+  entry.summary.author = reader.string();
+  entry.summary.collection = reader.string();
+  entry.summary.id = reader.string();
+
+  PuzzleThumbnail& thumbnail = entry.thumbnail;
+  std::uint64_t thumb_width = reader.varint();
+  std::uint64_t thumb_height = reader.varint();
+  if (thumb_width > PuzzleThumbnail::max_size
+      || thumb_height > PuzzleThumbnail::max_size)
+    throw std::out_of_range("decode_entry: thumbnail is too large");
+  thumbnail.width = thumb_width;
+  thumbnail.height = thumb_height;
+
+  unsigned palette_size = reader.u8();
+  for (unsigned i = 0; i < palette_size; ++i) {
+    int r = reader.u8();
+    int g = reader.u8();
+    int b = reader.u8();
+    thumbnail.palette.emplace_back(r, g, b);
+  }
+
+  std::size_t num_pixels = thumbnail.width * thumbnail.height;
+  const char* pixels = reader.bytes(num_pixels);
+  thumbnail.pixels.assign(pixels, pixels + num_pixels);
+  return entry;
+}
+
+void put_stamp(std::string& buf, const FileStamp& stamp)
+{
+  put_u64(buf, stamp.size);
+  put_u64(buf, static_cast<std::uint64_t>(stamp.time));
+}
+
+FileStamp read_stamp(ByteReader& reader)
+{
+  FileStamp stamp;
+  stamp.size = reader.u64();
+  stamp.time = static_cast<std::int64_t>(reader.u64());
+  return stamp;
+}
+
+// Name the cache file after a hash of the directory
+std::string cache_name(const std::string& dir)
+{
+  std::uint64_t hash = fnv1a_hash(dir.data(), dir.size());
+
+  const char* digits = "0123456789abcdef";
+  std::string name;
+  for (int shift = 60; shift >= 0; shift -= 4)
+    name += digits[(hash >> shift) & 0xf];
+  return name + cache_extension;
+}
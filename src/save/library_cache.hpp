@@ -0,0 +1,153 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_LIBRARY_CACHE_HPP
+#define NONNY_LIBRARY_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "color/color.hpp"
+#include "puzzle/puzzle_summary.hpp"
+#include "utility/mapped_file.hpp"
+
+class GameSettings;
+class PuzzleGrid;
+class SaveManager;
+
+/*
+ * Size and modification time of a file, used to tell whether cached
+ * information about it is still current. Both are zero if the file
+ * does not exist.
+ */
+struct FileStamp {
+  std::uint64_t size = 0;
+  std::int64_t time = 0;
+};
+
+// Get the stamp of a file, or of the pack holding a pack entry
+FileStamp file_stamp(const std::string& path);
+
+// Get the combined stamp of a save file and its progress journal
+FileStamp progress_stamp(const std::string& save_file);
+
+inline bool operator==(const FileStamp& l, const FileStamp& r);
+inline bool operator!=(const FileStamp& l, const FileStamp& r);
+
+/*
+ * Small picture of the user's progress on a puzzle, at most
+ * max_size cells on a side. Each pixel is 0 if empty or else one plus
+ * an index into the palette.
+ */
+struct PuzzleThumbnail {
+  static constexpr int max_size = 64;
+
+  int width = 0;
+  int height = 0;
+  std::vector<Color> palette;
+  std::vector<std::uint8_t> pixels;
+
+  const Color* at(int x, int y) const;
+};
+
+// Render a thumbnail of the filled cells in a puzzle grid
+PuzzleThumbnail make_thumbnail(const PuzzleGrid& grid);
+
+/*
+ * Everything the file browser shows about a puzzle file.
+ */
+struct LibraryEntry {
+  PuzzleSummary summary;
+  std::uint64_t clue_hash = 0;
+
+  bool is_complete = false;
+  unsigned best_time = 0;
+  unsigned current_time = 0;
+  PuzzleThumbnail thumbnail;
+
+  FileStamp file_stamp; //puzzle file the entry was loaded from
+  FileStamp save_stamp; //progress files, zero if there were none
+};
+
+/*
+ * Persistent cache of library entries for the puzzles in one
+ * directory or pack. The cache file lives in the user's cache
+ * directory and is memory-mapped when opened; only the entry names
+ * are read up front, and an entry is decoded when it is looked up.
+ *
+ * write() saves the entries that were looked up or stored since the
+ * cache was opened, so entries for files that have disappeared are
+ * dropped.
+ */
+class LibraryCache {
+public:
+  LibraryCache() = default;
+  LibraryCache(const GameSettings& settings, const std::string& dir);
+
+  LibraryCache(const LibraryCache&) = delete;
+  LibraryCache(LibraryCache&&) = default;
+  LibraryCache& operator=(const LibraryCache&) = delete;
+  LibraryCache& operator=(LibraryCache&&) & = default;
+
+  /*
+   * Look up an entry and check it against the current stamps of the
+   * puzzle file and its progress file. Returns false if there is no
+   * entry or it is out of date.
+   */
+  bool find(const std::string& path, const FileStamp& stamp,
+            const SaveManager& save_mgr, LibraryEntry& entry);
+
+  void store(const std::string& path, const LibraryEntry& entry);
+
+  // Save the cache if anything changed; failures are ignored
+  void write();
+
+private:
+  void read_names();
+
+  std::string m_dir;
+  std::string m_filename;
+  MappedFile m_file;
+  //location of each encoded entry in the mapped file
+  std::unordered_map<std::string, std::pair<std::size_t, std::size_t>>
+  m_offsets;
+  std::unordered_map<std::string, LibraryEntry> m_updates;
+  std::unordered_set<std::string> m_used;
+  std::size_t m_num_used_offsets = 0;
+  bool m_changed = false;
+};
+
+
+/* implementation */
+inline bool operator==(const FileStamp& l, const FileStamp& r)
+{
+  return l.size == r.size && l.time == r.time;
+}
+
+inline bool operator!=(const FileStamp& l, const FileStamp& r)
+{
+  return !(l == r);
+}
+
+#endif
@@ -21,25 +21,74 @@
 #include "save_manager.hpp"
 
 #include <algorithm>
+#include <ctime>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <sstream>
+#include <system_error>
+#include <vector>
 #include <experimental/filesystem>
+#include "config.h"
+#include "puzzle/puzzle_grid.hpp"
+#include "puzzle/puzzle_pack.hpp"
 #include "puzzle/puzzle_progress.hpp"
+#include "puzzle/puzzle_summary.hpp"
 #include "settings/game_settings.hpp"
+#include "utility/atomic_file.hpp"
+#include "utility/binary_io.hpp"
+#include "utility/mapped_file.hpp"
+#include "utility/trace.hpp"
 #include "utility/utility.hpp"
 
 namespace stdfs = std::experimental::filesystem;
 
 std::istream& scan_for_path(std::istream& is, std::string& path);
 std::string standardize(const std::string& name);
+bool read_index(const std::string& filename,
+                std::unordered_map<std::string, std::string>& files);
+std::string journal_header(std::uint64_t base_hash);
+void replay_journal(const std::string& filename, std::uint64_t base_hash,
+                    PuzzleProgress& prog);
+bool same_grid(const PuzzleGrid& l, const PuzzleGrid& r);
+char state_symbol(PuzzleCell::State state);
 
 constexpr int max_id_size = 32;
 constexpr int max_file_counter = 9999;
+const std::string index_filename = "index.nsi";
+const std::string index_header = "nonny-save-index 1";
+
+/*
+ * A progress journal starts with a header naming the hash of the save
+ * file it applies to, followed by one record per save:
+ *
+ *   save <wall clock time> <puzzle time>
+ *   cell <x> <y> <state> <color>
+ *   ...
+ *   end
+ *
+ * where the state is '.' (blank), '#' (filled), or 'x' (crossed out).
+ * A record without its end line was cut short and is ignored.
+ */
+const std::string journal_magic = "nonny-journal 1";
+const std::string journal_extension = ".nsj";
+constexpr std::size_t max_journal_ratio = 1; //relative to the save file
 
 SaveManager::SaveManager(GameSettings& settings)
   : m_settings(settings)
 {
+  m_save_thread = std::thread(&SaveManager::write_queued_saves, this);
+}
+
+SaveManager::~SaveManager()
+{
+  //the save thread finishes writing the queue before it exits
+  {
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
+    m_quit = true;
+  }
+  m_queue_changed.notify_all();
+  m_save_thread.join();
 }
 
 void SaveManager::load_progress(PuzzleProgress& prog,
@@ -47,76 +96,549 @@ void SaveManager::load_progress(PuzzleProgress& prog,
                                 const std::string& collection,
                                 const std::string& id) const
 {
-  std::string filename = find_save_file(path, collection, id);
-  std::ifstream file(filename);
+  NONNY_TRACE_SCOPE("SaveManager::load_progress");
+  //progress waiting to be written is newer than what is on disk
+  auto queued = queued_progress(path);
+  if (queued) {
+    prog = *queued;
+    return;
+  }
 
-  if (file.is_open()) {
-    file >> prog;
-  } else {
-    prog = PuzzleProgress(path);
+  std::string dir = collection_dir(collection);
+
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    std::string filename = find_save_file(path, dir, id, false);
+    if (filename.empty())
+      break;
+
+    MappedFile file(filename);
+    if (!file.is_open())
+      break;
+
+    std::string text(file.data(), file.size());
+    std::istringstream ss(text);
+    ss >> prog;
+    if (prog.filename() == path) {
+#ifdef NONNY_PROGRESS_JOURNAL
+      replay_journal(journal_filename(filename),
+                     fnv1a_hash(text.data(), text.size()), prog);
+#endif
+      return;
+    }
+
+    //save file belongs to another puzzle, so the index is out of date
+    std::lock_guard<std::mutex> lock(m_mutex);
+    rebuild_index(dir, collection_index(dir), true);
   }
+
+  prog = PuzzleProgress(path);
 }
 
 void SaveManager::save_progress(const PuzzleProgress& prog,
                                 const std::string& path,
                                 const std::string& collection,
-                                const std::string& id) const
+                                const std::string& id)
 {
-  std::string filename = find_save_file(path, collection, id);
+  NONNY_TRACE_SCOPE("SaveManager::save_progress");
+  queue_progress(std::make_shared<const PuzzleProgress>(prog),
+                 path, collection, id);
+  flush();
+}
 
-  //make sure directory exists, create it if not
-  stdfs::path p = stdfs::path(filename).remove_filename();
-  if (!p.empty() && !stdfs::exists(p))
-    stdfs::create_directories(p);
+void SaveManager::queue_progress(std::shared_ptr<const PuzzleProgress> prog,
+                                 const std::string& path,
+                                 const std::string& collection,
+                                 const std::string& id)
+{
+  std::string error;
+  {
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
 
-  std::ofstream file(filename);
+    //replace any save of the same puzzle that hasn't been written yet
+    auto it = m_queue.find(path);
+    if (it == m_queue.end()) {
+      m_queue_order.push_back(path);
+      it = m_queue.emplace(path, QueuedSave()).first;
+    }
+    it->second.progress = std::move(prog);
+    it->second.collection = collection;
+    it->second.id = id;
 
-  if (!file.is_open())
-    throw std::runtime_error("SaveManager::save_progress: "
-                             "could not save to file "
-                             + filename);
+    error.swap(m_save_error);
+  }
+  m_queue_changed.notify_all();
 
-  file << prog;
+  if (!error.empty())
+    throw std::runtime_error(error);
 }
 
-std::string SaveManager::find_save_file(const std::string& path,
-                                        std::string collection,
-                                        std::string id) const
+void SaveManager::flush()
 {
-  std::string std_dir = standardize(collection);
-  std::string std_id = standardize(id);
+  NONNY_TRACE_SCOPE("SaveManager::flush");
+  std::string error;
+  {
+    std::unique_lock<std::mutex> lock(m_queue_mutex);
+    m_queue_changed.wait(lock, [this]() {
+        return m_queue_order.empty() && m_writing_path.empty(); });
+    error.swap(m_save_error);
+  }
+
+  if (!error.empty())
+    throw std::runtime_error(error);
+}
 
+bool SaveManager::is_save_queued(const std::string& path) const
+{
+  return queued_progress(path) != nullptr;
+}
+
+std::string SaveManager::find_progress_file(const std::string& path,
+                                           const std::string& collection,
+                                           const std::string& id) const
+{
+  return find_save_file(path, collection_dir(collection), id, false);
+}
+
+void SaveManager::progress_key(const PuzzleSummary& summary,
+                               const std::string& path,
+                               std::string& collection, std::string& id)
+{
+  collection = summary.collection;
+  id = summary.id;
+  if (collection.empty())
+    collection = "Default";
+  if (id.empty()) {
+    if (summary.title.empty())
+      id = puzzle_path_stem(path);
+    else
+      id = summary.title;
+  }
+}
+
+std::string SaveManager::collection_dir(const std::string& collection) const
+{
+  std::string std_dir = standardize(collection);
   if (std_dir.empty())
     std_dir = "default";
+
+  std::string dir = m_settings.saved_progress_dir();
+  dir += m_settings.filesystem_separator();
+  dir += std_dir + m_settings.filesystem_separator();
+  return dir;
+}
+
+/*
+ * Look up the save file for a puzzle in the collection index. If there
+ * is none and create is true, a new, unused filename is chosen and
+ * recorded in the index; otherwise an empty string is returned.
+ */
+std::string SaveManager::find_save_file(const std::string& path,
+                                        const std::string& dir,
+                                        const std::string& id,
+                                        bool create) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  SaveIndex& index = collection_index(dir);
+
+  auto it = index.files.find(path);
+  if (it != index.files.end())
+    return dir + it->second;
+  else if (!create)
+    return "";
+
+  std::string std_id = standardize(id);
   if (std_id.empty())
     std_id = "untitled";
 
-  std::string expected_dir = m_settings.saved_progress_dir();
-  expected_dir += m_settings.filesystem_separator();
-  expected_dir += std_dir + m_settings.filesystem_separator();
+  //too many files with the same name, reuse the first one
+  std::string name = std_id + ".nsv";
 
-  int counter = 0;
-  while (counter < max_file_counter) {
-    std::string full_name = expected_dir;
-    if (counter == 0)
-      full_name += std_id + ".nsv";
-    else
-      full_name += std_id + std::to_string(counter) + ".nsv";
+  for (int counter = 0; counter < max_file_counter; ++counter) {
+    std::string candidate = std_id;
+    if (counter != 0)
+      candidate += std::to_string(counter);
+    candidate += ".nsv";
 
-    std::ifstream file(full_name);
-    if (file.is_open()) {
-      std::string name;
-      scan_for_path(file, name);
-      if (name == path)
-        return full_name;
-    } else
-      return full_name;
+    if (!index.used.count(candidate)) {
+      name = candidate;
+      break;
+    }
+  }
 
-    ++counter;
+  index.files[path] = name;
+  index.used.insert(name);
+  write_index(dir, index);
+  return dir + name;
+}
+
+/*
+ * Get the index for a collection directory, reading it from disk the
+ * first time. The mutex must be held by the caller.
+ */
+SaveManager::SaveIndex&
+SaveManager::collection_index(const std::string& dir) const
+{
+  auto it = m_indices.find(dir);
+  if (it != m_indices.end())
+    return it->second;
+
+  SaveIndex& index = m_indices[dir];
+  bool have_index = read_index(dir + index_filename, index.files);
+  rebuild_index(dir, index, !have_index);
+  return index;
+}
+
+/*
+ * Bring an index up to date with the save files in its directory.
+ * Entries for missing files are dropped, and files the index does not
+ * know about are scanned for their puzzle path. If rescan is true,
+ * every file is scanned. The index file is rewritten if anything
+ * changed.
+ */
+void SaveManager::rebuild_index(const std::string& dir, SaveIndex& index,
+                                bool rescan) const
+{
+  NONNY_TRACE_SCOPE("SaveManager::rebuild_index");
+  std::vector<std::string> on_disk;
+  std::error_code ec;
+  if (stdfs::is_directory(dir, ec)) {
+    for (const auto& file : stdfs::directory_iterator(dir, ec)) {
+      if (file.path().extension() == ".nsv"
+          && stdfs::is_regular_file(file.status()))
+        on_disk.push_back(file.path().filename().string());
+    }
   }
+  //prefer lower-numbered files if two claim the same puzzle
+  std::sort(on_disk.begin(), on_disk.end());
 
-  //too many files with the same name, reuse the first one
-  return expected_dir + std_id + ".nsv";
+  index.used.clear();
+  index.used.insert(on_disk.begin(), on_disk.end());
+
+  bool changed = false;
+  if (rescan && !index.files.empty()) {
+    index.files.clear();
+    changed = true;
+  }
+
+  std::unordered_set<std::string> indexed;
+  for (auto it = index.files.begin(); it != index.files.end(); ) {
+    if (index.used.count(it->second)) {
+      indexed.insert(it->second);
+      ++it;
+    } else {
+      it = index.files.erase(it);
+      changed = true;
+    }
+  }
+
+  for (const auto& name : on_disk) {
+    if (indexed.count(name))
+      continue;
+
+    std::ifstream file(dir + name);
+    std::string path;
+    scan_for_path(file, path);
+    if (!path.empty() && !index.files.count(path))
+      index.files[path] = name;
+    changed = true;
+  }
+
+  if (changed)
+    write_index(dir, index);
+}
+
+/*
+ * Replace the index file for a collection. Failure is ignored since
+ * the index can always be rebuilt.
+ */
+void SaveManager::write_index(const std::string& dir,
+                              const SaveIndex& index) const
+{
+  NONNY_TRACE_SCOPE("SaveManager::write_index");
+  std::string data = index_header + "\n";
+  for (const auto& entry : index.files)
+    data += entry.second + '\t' + entry.first + '\n';
+
+  try {
+    write_file_atomic(dir + index_filename, data);
+  } catch (const std::runtime_error&) {
+  }
+}
+
+std::shared_ptr<const PuzzleProgress>
+SaveManager::queued_progress(const std::string& path) const
+{
+  std::lock_guard<std::mutex> lock(m_queue_mutex);
+  auto it = m_queue.find(path);
+  if (it != m_queue.end())
+    return it->second.progress;
+  else if (!m_writing_path.empty() && m_writing_path == path)
+    return m_writing.progress;
+  else
+    return nullptr;
+}
+
+/*
+ * Body of the save thread. Queued progress is written in the order it
+ * was first queued, each save going to a temporary file that then
+ * replaces the old save file.
+ */
+void SaveManager::write_queued_saves()
+{
+  NONNY_TRACE_SCOPE("SaveManager::write_queued_saves");
+  std::unique_lock<std::mutex> lock(m_queue_mutex);
+  while (true) {
+    m_queue_changed.wait(lock, [this]() {
+        return m_quit || !m_queue_order.empty(); });
+    if (m_queue_order.empty())
+      return;
+
+    std::string path = m_queue_order.front();
+    m_queue_order.pop_front();
+    auto it = m_queue.find(path);
+    QueuedSave save = std::move(it->second);
+    m_queue.erase(it);
+    m_writing_path = path;
+    m_writing = save;
+    lock.unlock();
+
+    std::string error;
+    try {
+      std::string dir = collection_dir(save.collection);
+
+      //make sure directory exists, create it if not
+      stdfs::path p = stdfs::path(dir);
+      if (!p.empty() && !stdfs::exists(p))
+        stdfs::create_directories(p);
+
+      std::string filename = find_save_file(path, dir, save.id, true);
+      try {
+        write_progress(path, filename, save.progress);
+      } catch (const std::runtime_error&) {
+        throw std::runtime_error("could not save to file " + filename);
+      }
+    } catch (const std::exception& e) {
+      error = "SaveManager::save_progress: ";
+      error += e.what();
+    }
+
+    lock.lock();
+    if (!error.empty())
+      m_save_error = error;
+    m_writing_path.clear();
+    m_writing = QueuedSave();
+    m_queue_changed.notify_all();
+  }
+}
+
+/*
+ * Write progress from the save thread, either as a journal record or
+ * as a complete save file.
+ */
+void SaveManager::write_progress(const std::string& path,
+                                 const std::string& filename,
+                                 std::shared_ptr<const PuzzleProgress> prog)
+{
+  NONNY_TRACE_SCOPE("SaveManager::write_progress");
+#ifdef NONNY_PROGRESS_JOURNAL
+  if (append_to_journal(path, filename, prog))
+    return;
+#endif
+
+  std::ostringstream ss;
+  ss << *prog;
+  std::string text = ss.str();
+  write_file_atomic(filename, text);
+
+  //the new save file includes everything that was in the journal
+  std::error_code ec;
+  stdfs::remove(journal_filename(filename), ec);
+
+#ifdef NONNY_PROGRESS_JOURNAL
+  JournalState& state = m_journals[path];
+  state.save_file = filename;
+  state.written = std::move(prog);
+  state.base_hash = fnv1a_hash(text.data(), text.size());
+  state.base_size = text.size();
+  state.journal_size = 0;
+#else
+  (void)path;
+#endif
+}
+
+/*
+ * Record the cells that changed since the last write of this puzzle.
+ * Returns false if a complete save file has to be written instead:
+ * the puzzle hasn't been written yet this session, something other
+ * than the cells and time changed, or the journal is too large.
+ */
+bool SaveManager::append_to_journal(const std::string& path,
+                                    const std::string& filename,
+                                    std::shared_ptr<const PuzzleProgress> prog)
+{
+  NONNY_TRACE_SCOPE("SaveManager::append_to_journal");
+  auto it = m_journals.find(path);
+  if (it == m_journals.end())
+    return false;
+
+  JournalState& state = it->second;
+  const PuzzleProgress& old = *state.written;
+  if (state.save_file != filename
+      || old.filename() != prog->filename()
+      || old.is_complete() != prog->is_complete()
+      || old.best_time() != prog->best_time()
+      || old.state().width() != prog->state().width()
+      || old.state().height() != prog->state().height()
+      || !same_grid(old.solution(), prog->solution()))
+    return false;
+
+  std::ostringstream record;
+  if (state.journal_size == 0)
+    record << journal_header(state.base_hash) << "\n";
+  record << "save " << std::time(nullptr) << " "
+         << prog->current_time() << "\n";
+
+  const PuzzleGrid& grid = prog->state();
+  for (int y = 0; y != grid.height(); ++y) {
+    for (int x = 0; x != grid.width(); ++x) {
+      const PuzzleCell& cell = grid.at(x, y);
+      if (cell != old.state().at(x, y))
+        record << "cell " << x << " " << y << " "
+               << state_symbol(cell.state) << " " << cell.color << "\n";
+    }
+  }
+  record << "end\n";
+
+  std::string data = record.str();
+  if (state.journal_size + data.size()
+      > state.base_size * max_journal_ratio)
+    return false;
+
+  //start a new journal from scratch in case an old one was left behind
+  if (state.journal_size == 0)
+    write_file_atomic(journal_filename(filename), data);
+  else
+    append_file_synced(journal_filename(filename), data);
+
+  state.journal_size += data.size();
+  state.written = std::move(prog);
+  return true;
+}
+
+std::string SaveManager::journal_filename(const std::string& save_file)
+{
+  stdfs::path p(save_file);
+  return p.replace_extension(journal_extension).string();
+}
+
+std::string journal_header(std::uint64_t base_hash)
+{
+  std::ostringstream ss;
+  ss << journal_magic << " " << std::hex << base_hash;
+  return ss.str();
+}
+
+/*
+ * Apply the complete records of a journal to progress loaded from the
+ * save file with the given hash. A journal written for a different
+ * version of the save file is ignored.
+ */
+void replay_journal(const std::string& filename, std::uint64_t base_hash,
+                    PuzzleProgress& prog)
+{
+  std::ifstream file(filename);
+  std::string line;
+  if (!std::getline(file, line) || line != journal_header(base_hash))
+    return;
+
+  struct Change {
+    int x, y;
+    PuzzleCell cell;
+  };
+  std::vector<Change> changes;
+  unsigned time = 0;
+  bool in_record = false;
+
+  const PuzzleGrid& grid = prog.state();
+  while (std::getline(file, line)) {
+    std::istringstream ss(line);
+    std::string keyword;
+    ss >> keyword;
+
+    if (keyword == "save") {
+      long long wall_time;
+      if (!(ss >> wall_time >> time))
+        return;
+      changes.clear();
+      in_record = true;
+    } else if (keyword == "cell" && in_record) {
+      Change change;
+      char symbol;
+      if (!(ss >> change.x >> change.y >> symbol >> change.cell.color))
+        return;
+      if (change.x < 0 || change.x >= grid.width()
+          || change.y < 0 || change.y >= grid.height())
+        return;
+
+      if (symbol == '#')
+        change.cell.state = PuzzleCell::State::filled;
+      else if (symbol == 'x')
+        change.cell.state = PuzzleCell::State::crossed_out;
+      else
+        change.cell.state = PuzzleCell::State::blank;
+      changes.push_back(change);
+    } else if (keyword == "end" && in_record) {
+      for (const auto& change : changes)
+        prog.set_state(change.x, change.y, change.cell);
+      prog.set_current_time(time);
+      in_record = false;
+    } else {
+      return;
+    }
+  }
+}
+
+bool same_grid(const PuzzleGrid& l, const PuzzleGrid& r)
+{
+  if (l.width() != r.width() || l.height() != r.height())
+    return false;
+
+  for (int y = 0; y != l.height(); ++y) {
+    for (int x = 0; x != l.width(); ++x) {
+      if (l.at(x, y) != r.at(x, y))
+        return false;
+    }
+  }
+  return true;
+}
+
+char state_symbol(PuzzleCell::State state)
+{
+  switch (state) {
+  case PuzzleCell::State::filled:
+    return '#';
+  case PuzzleCell::State::crossed_out:
+    return 'x';
+  default:
+    return '.';
+  }
+}
+
+bool read_index(const std::string& filename,
+                std::unordered_map<std::string, std::string>& files)
+{
+  std::ifstream file(filename);
+  std::string line;
+  if (!std::getline(file, line) || line != index_header)
+    return false;
+
+  while (std::getline(file, line)) {
+    auto tab = line.find('\t');
+    if (tab == std::string::npos || tab == 0)
+      return false;
+    files[line.substr(tab + 1)] = line.substr(0, tab);
+  }
+  return true;
 }
 
 std::istream& scan_for_path(std::istream& is, std::string& path)
@@ -21,20 +21,47 @@
 #ifndef NONNY_SAVE_MANAGER_HPP
 #define NONNY_SAVE_MANAGER_HPP
 
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 class GameSettings;
 class PuzzleProgress;
+struct PuzzleSummary;
 
 /*
  * Handles saving and loading of puzzle progress. Progress is saved
  * and loaded from a file whose filename and directory is based on the
  * name of the puzzle and the collection it belongs to, if any.
+ *
+ * Each collection directory has an index file mapping puzzle paths to
+ * save files. It is read the first time the collection is used,
+ * checked against the directory contents, and rewritten whenever a
+ * new save file is created. Progress may be loaded from several
+ * threads at once.
+ *
+ * Progress can also be queued and written by a background thread.
+ * Queued saves of the same puzzle are combined, and loading a puzzle
+ * with a queued save returns the queued progress.
+ *
+ * When built with NONNY_PROGRESS_JOURNAL, a puzzle saved more than
+ * once in a session has only its changed cells appended to a journal
+ * next to the save file. Loading replays the journal on top of the
+ * save file, and the save file is rewritten in full once the journal
+ * grows too large.
  */
 class SaveManager {
 public:
   explicit SaveManager(GameSettings& settings);
+  ~SaveManager();
   SaveManager(const SaveManager&) = delete;
   SaveManager(SaveManager&&) = delete;
 
@@ -48,14 +75,98 @@ public:
   void save_progress(const PuzzleProgress& prog,
                      const std::string& path,
                      const std::string& collection,
-                     const std::string& id) const;
+                     const std::string& id);
+
+  /*
+   * Queue a snapshot of puzzle progress to be written in the
+   * background. If an earlier queued save failed, its error is thrown
+   * here as a std::runtime_error.
+   */
+  void queue_progress(std::shared_ptr<const PuzzleProgress> prog,
+                      const std::string& path,
+                      const std::string& collection,
+                      const std::string& id);
+
+  /*
+   * Wait until all queued progress has been written. Throws a
+   * std::runtime_error if a queued save failed.
+   */
+  void flush();
+
+  // Check whether a puzzle has progress waiting to be written
+  bool is_save_queued(const std::string& path) const;
+
+  /*
+   * Get the name of the file holding a puzzle's saved progress, or an
+   * empty string if no progress has been saved.
+   */
+  std::string find_progress_file(const std::string& path,
+                                 const std::string& collection,
+                                 const std::string& id) const;
+
+  // Determine the collection and id a puzzle's progress is saved under
+  static void progress_key(const PuzzleSummary& summary,
+                           const std::string& path,
+                           std::string& collection, std::string& id);
+
+  // Get the name of the journal kept alongside a save file
+  static std::string journal_filename(const std::string& save_file);
+
+  const GameSettings& settings() const { return m_settings; }
 
 private:
+  struct QueuedSave {
+    std::shared_ptr<const PuzzleProgress> progress;
+    std::string collection;
+    std::string id;
+  };
+
+  struct JournalState {
+    std::string save_file;
+    std::shared_ptr<const PuzzleProgress> written; //progress now on disk
+    std::uint64_t base_hash = 0; //hash of the save file contents
+    std::size_t base_size = 0;
+    std::size_t journal_size = 0;
+  };
+
+  struct SaveIndex {
+    std::unordered_map<std::string, std::string> files; //path -> save file
+    std::unordered_set<std::string> used; //save files in the directory
+  };
+
+  std::string collection_dir(const std::string& collection) const;
   std::string find_save_file(const std::string& path,
-                             std::string collection,
-                             std::string id) const;
+                             const std::string& dir,
+                             const std::string& id,
+                             bool create) const;
+  SaveIndex& collection_index(const std::string& dir) const;
+  void rebuild_index(const std::string& dir, SaveIndex& index,
+                     bool rescan) const;
+  void write_index(const std::string& dir, const SaveIndex& index) const;
+  std::shared_ptr<const PuzzleProgress>
+  queued_progress(const std::string& path) const;
+  void write_queued_saves();
+  void write_progress(const std::string& path, const std::string& filename,
+                      std::shared_ptr<const PuzzleProgress> prog);
+  bool append_to_journal(const std::string& path,
+                         const std::string& filename,
+                         std::shared_ptr<const PuzzleProgress> prog);
 
   GameSettings& m_settings;
+  mutable std::mutex m_mutex;
+  mutable std::map<std::string, SaveIndex> m_indices; //keyed by directory
+
+  mutable std::mutex m_queue_mutex;
+  std::condition_variable m_queue_changed;
+  std::map<std::string, QueuedSave> m_queue; //keyed by puzzle path
+  std::deque<std::string> m_queue_order;
+  std::string m_writing_path; //save being written, if any
+  QueuedSave m_writing;
+  std::string m_save_error;
+  bool m_quit = false;
+  std::thread m_save_thread;
+  //what the save thread last wrote for each puzzle, keyed by path
+  std::unordered_map<std::string, JournalState> m_journals;
 };
 
 #endif
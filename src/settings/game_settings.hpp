@@ -34,12 +34,23 @@ public:
   const std::string& save_dir() const { return m_save_dir; }
   char filesystem_separator() const { return m_separator; }
 
+  // Keep saved progress, saved puzzles, and the cache somewhere else
+  void set_save_dir(const std::string& dir) { m_save_dir = dir; }
+
   inline std::string font_dir() const;
   inline std::string image_dir() const;
   inline std::string puzzle_dir() const;
 
   inline std::string saved_progress_dir() const;
   inline std::string saved_puzzle_dir() const;
+  inline std::string library_cache_dir() const;
+
+  /*
+   * Frames per second to draw at most when the display does not limit
+   * the rate with vsync, or 0 for no limit
+   */
+  int max_frame_rate() const { return m_max_frame_rate; }
+  void set_max_frame_rate(int fps) { m_max_frame_rate = fps; }
 
 private:
   void find_directories();
@@ -47,6 +58,7 @@ private:
   std::string m_data_dir;
   std::string m_save_dir;
   char m_separator = '/';
+  int m_max_frame_rate = 60;
 };
 
 
@@ -76,4 +88,9 @@ inline std::string GameSettings::saved_puzzle_dir() const
   return save_dir() + m_separator + "puzzles";
 }
 
+inline std::string GameSettings::library_cache_dir() const
+{
+  return save_dir() + m_separator + "cache";
+}
+
 #endif
@@ -0,0 +1,365 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "solver/difficulty_rater.hpp"
+
+#include <algorithm>
+#include "puzzle/compressed_state.hpp"
+#include "solver/line_solver.hpp"
+
+namespace {
+  //cost of each cell deduced by a technique, and the extra cost of each
+  //probe or guess, which leads to more than the one cell it is made on
+  constexpr double cell_cost[num_techniques] = { 1.0, 3.0, 10.0, 10.0 };
+  constexpr double step_cost[num_techniques] = { 0.0, 0.0, 10.0, 25.0 };
+
+  //work done by each call to step(), so callers can rate incrementally
+  constexpr int lines_per_step = 16;
+
+  //cells probed each time the line solvers are stuck, before giving up
+  //and searching
+  constexpr int max_probes = 64;
+}
+
+double DifficultyRating::score() const
+{
+  if (num_cells == 0)
+    return 0.0;
+
+  double total = 0.0;
+  for (int i = 0; i < num_techniques; ++i)
+    total += cell_cost[i] * usage[i].cells + step_cost[i] * usage[i].steps;
+  return total / num_cells;
+}
+
+DifficultyRater::DifficultyRater(Puzzle& puzzle)
+  : m_puzzle(puzzle),
+    m_row_marked(puzzle.height(), 1),
+    m_col_marked(puzzle.width(), 1)
+{
+  m_rating.num_cells = puzzle.width() * puzzle.height();
+  for (int y = 0; y < puzzle.height(); ++y) {
+    for (int x = 0; x < puzzle.width(); ++x) {
+      if (puzzle.at(x, y).state == PuzzleCell::State::blank)
+        ++m_num_unknown;
+    }
+  }
+
+  for (const auto& entry : puzzle.palette()) {
+    if (entry.name != "background")
+      m_colors.push_back(entry.color);
+  }
+}
+
+bool DifficultyRater::step()
+{
+  switch (m_phase) {
+  case Phase::overlap:
+    step_overlap();
+    break;
+  case Phase::line_logic:
+    step_line_logic();
+    break;
+  case Phase::probing:
+    step_probing();
+    break;
+  case Phase::guessing:
+    step_guessing();
+    break;
+  case Phase::finished:
+    break;
+  }
+  return is_finished();
+}
+
+void DifficultyRater::operator()()
+{
+  while (!step()) { }
+}
+
+void DifficultyRater::step_overlap()
+{
+  for (int n = 0; n < lines_per_step; ++n) {
+    auto row = std::find(m_row_marked.begin(), m_row_marked.end(), 1);
+    auto col = std::find(m_col_marked.begin(), m_col_marked.end(), 1);
+    LineType type = LineType::row;
+    int index = 0;
+    if (row != m_row_marked.end()) {
+      index = row - m_row_marked.begin();
+      *row = 0;
+    } else if (col != m_col_marked.end()) {
+      type = LineType::column;
+      index = col - m_col_marked.begin();
+      *col = 0;
+    } else {
+      start_line_logic();
+      return;
+    }
+
+    int new_cells = 0;
+    if (!solve_line(index, type, false, new_cells)) {
+      finish(0);
+      return;
+    }
+    if (new_cells > 0)
+      record(Technique::overlap, new_cells);
+  }
+}
+
+void DifficultyRater::step_line_logic()
+{
+  int height = m_puzzle.height();
+  for (int n = 0; n < lines_per_step; ++n) {
+    if (m_next_pending == m_pending.size()) {
+      start_probing();
+      return;
+    }
+
+    int line = m_pending[m_next_pending++];
+    LineType type = line < height ? LineType::row : LineType::column;
+    int index = line < height ? line : line - height;
+
+    int new_cells = 0;
+    if (!solve_line(index, type, true, new_cells)) {
+      finish(0);
+      return;
+    }
+    if (new_cells > 0) {
+      //back to the easier technique
+      record(Technique::line_logic, new_cells);
+      m_phase = Phase::overlap;
+      return;
+    }
+  }
+}
+
+void DifficultyRater::step_probing()
+{
+  while (m_next_pending < m_pending.size()) {
+    int cell = m_pending[m_next_pending++];
+    int x = cell % m_puzzle.width(), y = cell / m_puzzle.width();
+    if (m_puzzle.at(x, y).state != PuzzleCell::State::blank)
+      continue;
+
+    PuzzleCell value;
+    int num_values = probe(x, y, value);
+    if (num_values == 0) {
+      finish(0);
+    } else if (num_values == 1) {
+      set_cell(x, y, value);
+      record(Technique::probing, 1);
+      m_phase = Phase::overlap;
+    }
+    return; //one probe per step
+  }
+
+  start_guessing();
+}
+
+void DifficultyRater::step_guessing()
+{
+  if (m_solver->step() || m_solver->num_solutions() > 1) {
+    m_rating[Technique::guessing].steps = m_solver->num_guesses();
+    finish(std::min(m_solver->num_solutions(), 2));
+  }
+}
+
+void DifficultyRater::start_line_logic()
+{
+  if (m_num_unknown == 0) {
+    finish(1);
+    return;
+  }
+
+  //queue every line that still has unknown cells
+  m_pending.clear();
+  m_next_pending = 0;
+  for (int y = 0; y < m_puzzle.height(); ++y) {
+    if (!m_puzzle.get_row(y).is_solved())
+      m_pending.push_back(y);
+  }
+  for (int x = 0; x < m_puzzle.width(); ++x) {
+    if (!m_puzzle.get_col(x).is_solved())
+      m_pending.push_back(m_puzzle.height() + x);
+  }
+  m_phase = Phase::line_logic;
+}
+
+void DifficultyRater::start_probing()
+{
+  int width = m_puzzle.width(), height = m_puzzle.height();
+  std::vector<int> row_unknown(height, 0), col_unknown(width, 0);
+  m_pending.clear();
+  m_next_pending = 0;
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      if (m_puzzle.at(x, y).state == PuzzleCell::State::blank) {
+        ++row_unknown[y];
+        ++col_unknown[x];
+        m_pending.push_back(y * width + x);
+      }
+    }
+  }
+
+  //cells in nearly finished lines are the likeliest to lead to a
+  //contradiction quickly
+  auto unknown = [&](int cell) {
+    return row_unknown[cell / width] + col_unknown[cell % width]; };
+  std::stable_sort(m_pending.begin(), m_pending.end(),
+                   [&](int a, int b) { return unknown(a) < unknown(b); });
+  if (m_pending.size() > static_cast<std::size_t>(max_probes))
+    m_pending.resize(max_probes);
+
+  m_phase = Phase::probing;
+}
+
+void DifficultyRater::start_guessing()
+{
+  m_rating[Technique::guessing].cells = m_num_unknown;
+  m_solver.reset(new Solver(m_puzzle));
+  m_phase = Phase::guessing;
+}
+
+void DifficultyRater::finish(int num_solutions)
+{
+  m_rating.num_solutions = num_solutions;
+  m_pending.clear();
+  m_phase = Phase::finished;
+}
+
+bool DifficultyRater::solve_line(int index, LineType type, bool complete,
+                                 int& new_cells)
+{
+  PuzzleLine line(m_puzzle, index, type);
+  LineSolver solver(line);
+  m_solved_line.clear();
+  if (complete ? !solver.solve_complete(m_solved_line)
+      : !solver.solve_fast(m_solved_line))
+    return false;
+
+  new_cells = 0;
+  for (int i = 0; i < line.size(); ++i) {
+    const PuzzleCell& cell = line[i];
+    const PuzzleCell& solved = m_solved_line[i];
+    if (solved.state == PuzzleCell::State::blank)
+      continue;
+
+    if (cell.state != PuzzleCell::State::blank) {
+      //known cells can only change if the line cannot be solved
+      if (cell.state != solved.state
+          || (cell.state == PuzzleCell::State::filled
+              && cell.color != solved.color))
+        return false;
+      continue;
+    }
+
+    if (solved.state == PuzzleCell::State::filled)
+      line.mark_cell(i, solved.color);
+    else
+      line.cross_out_cell(i);
+    ++new_cells;
+
+    if (type == LineType::row)
+      m_col_marked[i] = 1;
+    else
+      m_row_marked[i] = 1;
+  }
+  return true;
+}
+
+bool DifficultyRater::propagate()
+{
+  while (true) {
+    auto row = std::find(m_row_marked.begin(), m_row_marked.end(), 1);
+    auto col = std::find(m_col_marked.begin(), m_col_marked.end(), 1);
+    int new_cells = 0;
+    if (row != m_row_marked.end()) {
+      *row = 0;
+      if (!solve_line(row - m_row_marked.begin(), LineType::row, false,
+                      new_cells))
+        return false;
+    } else if (col != m_col_marked.end()) {
+      *col = 0;
+      if (!solve_line(col - m_col_marked.begin(), LineType::column, false,
+                      new_cells))
+        return false;
+    } else {
+      return true;
+    }
+  }
+}
+
+int DifficultyRater::probe(int x, int y, PuzzleCell& result)
+{
+  std::vector<PuzzleCell> values(1);
+  values[0].state = PuzzleCell::State::crossed_out;
+  for (const auto& color : m_colors) {
+    auto has_color = [&](const PuzzleClue& c) { return c.color == color; };
+    const auto& row = m_puzzle.row_clues(y);
+    const auto& col = m_puzzle.col_clues(x);
+    if (std::any_of(row.begin(), row.end(), has_color)
+        && std::any_of(col.begin(), col.end(), has_color)) {
+      PuzzleCell cell;
+      cell.state = PuzzleCell::State::filled;
+      cell.color = color;
+      values.push_back(cell);
+    }
+  }
+
+  CompressedState saved;
+  m_puzzle.copy_state(saved);
+  int num_consistent = 0;
+  for (const auto& value : values) {
+    set_cell(x, y, value);
+    bool consistent = propagate();
+    m_puzzle.load_state(saved);
+    clear_marks();
+
+    if (consistent) {
+      result = value;
+      if (++num_consistent > 1)
+        break;
+    }
+  }
+  return num_consistent;
+}
+
+void DifficultyRater::set_cell(int x, int y, const PuzzleCell& cell)
+{
+  if (cell.state == PuzzleCell::State::filled)
+    m_puzzle.mark_cell(x, y, cell.color);
+  else
+    m_puzzle.cross_out_cell(x, y);
+  m_row_marked[y] = 1;
+  m_col_marked[x] = 1;
+}
+
+void DifficultyRater::record(Technique t, int cells)
+{
+  ++m_rating[t].steps;
+  m_rating[t].cells += cells;
+  m_num_unknown -= cells;
+}
+
+void DifficultyRater::clear_marks()
+{
+  std::fill(m_row_marked.begin(), m_row_marked.end(), 0);
+  std::fill(m_col_marked.begin(), m_col_marked.end(), 0);
+}
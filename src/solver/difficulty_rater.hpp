@@ -0,0 +1,151 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_DIFFICULTY_RATER_HPP
+#define NONNY_DIFFICULTY_RATER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "color/color.hpp"
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_cell.hpp"
+#include "puzzle/puzzle_line.hpp"
+#include "solver/solver.hpp"
+
+/*
+ * Ways of deducing cells, from easiest to hardest.
+ */
+enum class Technique {
+  overlap,    //fast line solver
+  line_logic, //complete line solver
+  probing,    //trying each value of a cell and ruling out contradictions
+  guessing    //searching with backtracking
+};
+
+constexpr int num_techniques = 4;
+
+/*
+ * How often a technique was needed. A step is one line solved, probe
+ * or guess that produced new information, and cells counts the cells
+ * it settled. For guessing, cells counts every cell still unknown
+ * when the search began.
+ */
+struct TechniqueUsage {
+  int steps = 0;
+  int cells = 0;
+};
+
+/*
+ * The result of rating a puzzle.
+ */
+struct DifficultyRating {
+  TechniqueUsage usage[num_techniques];
+  int num_cells = 0;
+
+  // 0 if the puzzle has no solution, 2 if it has more than one
+  int num_solutions = 0;
+
+  const TechniqueUsage& operator[](Technique t) const
+  { return usage[static_cast<int>(t)]; }
+  TechniqueUsage& operator[](Technique t)
+  { return usage[static_cast<int>(t)]; }
+
+  /*
+   * Average cost of deducing a cell, where overlap costs 1 and harder
+   * techniques cost more. A puzzle solved by overlap alone scores 1.0.
+   */
+  double score() const;
+};
+
+/*
+ * Rates the difficulty of a puzzle by solving it the way a person
+ * would: with the easiest technique that makes progress, moving to a
+ * harder one only when the easier ones are stuck. The puzzle's
+ * current cells are taken as given, so clear it first to rate the
+ * whole puzzle. When finished, the puzzle holds a solution if it has
+ * one.
+ */
+class DifficultyRater {
+public:
+  explicit DifficultyRater(Puzzle& puzzle);
+
+  // Do a small amount of work, returns true if finished
+  bool step();
+
+  // Rate the whole puzzle, all at once
+  void operator()();
+
+  bool is_finished() const { return m_phase == Phase::finished; }
+
+  // The rating so far; only complete once finished
+  const DifficultyRating& rating() const { return m_rating; }
+
+private:
+  enum class Phase { overlap, line_logic, probing, guessing, finished };
+
+  void step_overlap();
+  void step_line_logic();
+  void step_probing();
+  void step_guessing();
+
+  void start_line_logic();
+  void start_probing();
+  void start_guessing();
+  void finish(int num_solutions);
+
+  /*
+   * Solve one line, marking the crossing lines of any new cells.
+   * Returns false on contradiction.
+   */
+  bool solve_line(int index, LineType type, bool complete, int& new_cells);
+
+  // Fast line solve the marked lines until nothing changes
+  bool propagate();
+
+  /*
+   * Try every value of a cell. Returns the number of values that do
+   * not lead to a contradiction, and the last such value in result.
+   */
+  int probe(int x, int y, PuzzleCell& result);
+
+  void set_cell(int x, int y, const PuzzleCell& cell);
+  void record(Technique t, int cells);
+  void clear_marks();
+
+  Puzzle& m_puzzle;
+  Phase m_phase = Phase::overlap;
+  DifficultyRating m_rating;
+  int m_num_unknown = 0;
+
+  // Lines that have changed since they were last solved
+  std::vector<char> m_row_marked;
+  std::vector<char> m_col_marked;
+
+  // Lines or cells waiting for the current phase
+  std::vector<int> m_pending;
+  std::size_t m_next_pending = 0;
+
+  std::vector<Color> m_colors;
+  std::vector<PuzzleCell> m_solved_line;
+  std::unique_ptr<Solver> m_solver;
+};
+
+#endif
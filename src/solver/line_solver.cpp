@@ -24,6 +24,7 @@
 #include "puzzle/puzzle.hpp"
 #include "puzzle/puzzle_line.hpp"
 #include "solver/block_sequence.hpp"
+#include "utility/trace.hpp"
 
 bool LineSolver::operator()()
 {
@@ -44,6 +45,7 @@ bool LineSolver::operator()()
 
 bool LineSolver::solve_fast(std::vector<PuzzleCell>& result)
 {
+  NONNY_TRACE_SCOPE("LineSolver::solve_fast");
   std::vector<BlockSequence> seqs;
   seqs.emplace_back(m_line);
   seqs.emplace_back(m_line);
@@ -63,6 +65,7 @@ bool LineSolver::solve_fast(std::vector<PuzzleCell>& result)
 
 bool LineSolver::solve_complete(std::vector<PuzzleCell>& result)
 {
+  NONNY_TRACE_SCOPE("LineSolver::solve_complete");
   BlockSequence blocks(m_line);
   if (!blocks.arrange_left())
     return false;
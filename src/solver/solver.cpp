@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <stdexcept>
 #include "solver/line_solver.hpp"
+#include "utility/trace.hpp"
 
 Solver::Solver(Puzzle& puzzle)
   : m_puzzle(puzzle),
@@ -34,6 +35,7 @@ Solver::Solver(Puzzle& puzzle)
 
 bool Solver::step()
 {
+  NONNY_TRACE_SCOPE("Solver::step");
   if (is_finished())
     return true;
   if (m_inconsistent)
@@ -63,6 +65,7 @@ bool Solver::step()
 
     if (index >= 0) { //found a line, send it to line solver
       PuzzleLine line(m_puzzle, index, type);
+      ++m_num_lines_solved;
       if (!solve_line(line, m_use_complete)) {
         //found a contradiction
         backtrack();
@@ -431,6 +434,15 @@ bool Solver::solve_line(PuzzleLine& line, bool complete)
     //and boost priority of changed perpendicular lines
     if (line[i] != m_solved_line[i]
         && m_solved_line[i].state != PuzzleCell::State::blank) {
+      //a known cell can only change if the line cannot be solved;
+      //overwriting it would let the crossing line change it back
+      if (line[i].state == PuzzleCell::State::filled
+          || (line[i].state == PuzzleCell::State::crossed_out
+              && m_solved_line[i].state == PuzzleCell::State::filled))
+        return false;
+      if (line[i].state == PuzzleCell::State::crossed_out)
+        continue;
+
       m_new_info_found = true;
 
       if (line.type() == LineType::row)
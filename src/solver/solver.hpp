@@ -72,6 +72,9 @@ public:
 
   int search_depth() const { return m_max_depth; }
 
+  // How many lines have been passed to the line solver?
+  long num_lines_solved() const { return m_num_lines_solved; }
+
   // Can the puzzle be solved one line at a time?
   inline bool is_line_solvable() const;
 
@@ -140,6 +143,7 @@ private:
 
   bool m_finished = false; //are we done?
   int m_num_guesses = 0; //how many guesses have we made?
+  long m_num_lines_solved = 0;
   int m_cur_depth = 0;
   int m_max_depth = 0;
   bool m_inconsistent = false; //is puzzle contradictory?
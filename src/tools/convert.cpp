@@ -0,0 +1,409 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Command-line tool for converting puzzles between file formats. Input
+ * files are streamed through a pipeline of parsing, checking, and
+ * writing stages, each of which runs on its own pool of threads and
+ * hands puzzles to the next through a bounded queue.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "puzzle/puzzle_pack.hpp"
+#include "solver/solver.hpp"
+#include "utility/bounded_queue.hpp"
+
+namespace stdfs = std::experimental::filesystem;
+
+const char usage[] =
+  "Usage: nonny-convert [OPTION]... EXTENSION OUTPUT_DIR PATH...\n"
+  "\n"
+  "Convert puzzle files, directories of puzzle files, and puzzle packs\n"
+  "to the format given by EXTENSION (.non, .g, .mk, .nin, .nbn, or\n"
+  ".png), writing them to OUTPUT_DIR. Directories are searched\n"
+  "recursively and their layout is kept in the output. Converting to\n"
+  ".png draws an image of each solution and implies --unique.\n"
+  "\n"
+  "Options:\n"
+  "  -j N          use N threads for each stage (default: one per core)\n"
+  "  -u, --update  skip puzzles whose output is newer than the input, and\n"
+  "                leave outputs alone if their contents would not change\n"
+  "  --unique      solve each puzzle and skip any that do not have\n"
+  "                exactly one solution\n"
+  "  -q, --quiet   only report errors\n";
+
+struct Options {
+  std::string extension;
+  PuzzleFormat format = PuzzleFormat::non;
+  stdfs::path output_dir;
+  std::vector<std::string> paths;
+  unsigned num_threads = 0;
+  bool update = false;
+  bool unique = false;
+  bool quiet = false;
+};
+
+/*
+ * A puzzle on its way through the pipeline. Puzzles come either from a
+ * file or from an entry in a pack.
+ */
+struct Job {
+  std::string name; //input shown in messages
+  std::string input;
+  std::shared_ptr<const PuzzlePack> pack;
+  std::size_t pack_index = 0;
+  stdfs::path output;
+  Puzzle puzzle;
+};
+
+typedef BoundedQueue<std::unique_ptr<Job>> JobQueue;
+
+struct Totals {
+  std::atomic<unsigned> converted{0};
+  std::atomic<unsigned> unchanged{0};
+  std::atomic<unsigned> rejected{0};
+  std::atomic<unsigned> errors{0};
+};
+
+std::mutex output_mutex;
+
+void report_error(const std::string& name, const std::string& message)
+{
+  std::lock_guard<std::mutex> lock(output_mutex);
+  std::cerr << "nonny-convert: " << name << ": " << message << "\n";
+}
+
+// Is the output at least as new as the input it was made from?
+bool is_up_to_date(const stdfs::path& input, const stdfs::path& output)
+{
+  std::error_code ec;
+  auto output_time = stdfs::last_write_time(output, ec);
+  if (ec)
+    return false;
+  auto input_time = stdfs::last_write_time(input, ec);
+  return !ec && output_time >= input_time;
+}
+
+// Does the file hold exactly the given data?
+bool has_contents(const stdfs::path& filename, const std::string& data)
+{
+  std::error_code ec;
+  auto size = stdfs::file_size(filename, ec);
+  if (ec || size != data.size())
+    return false;
+
+  std::ifstream file(filename.string(), std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+  return contents == data;
+}
+
+/*
+ * Queue a job for each puzzle under the given path. Outputs maps each
+ * output file to the input it is made from, so that inputs that would
+ * be written to the same file (like a.non and a.g) are reported
+ * instead of being written over each other by different threads.
+ */
+void find_jobs(const Options& opts, const std::string& path,
+               JobQueue& queue, Totals& totals,
+               std::map<std::string, std::string>& outputs)
+{
+  auto add_job = [&](std::unique_ptr<Job> job, const stdfs::path& input) {
+    job->output.replace_extension(opts.extension);
+    auto result = outputs.emplace(job->output.string(), job->name);
+    if (!result.second) {
+      report_error(job->name, "same output file as "
+                   + result.first->second + ": " + job->output.string());
+      ++totals.errors;
+    } else if (opts.update && is_up_to_date(input, job->output))
+      ++totals.unchanged;
+    else
+      queue.push(std::move(job));
+  };
+
+  if (is_pack_file(path)) {
+    auto pack = std::make_shared<const PuzzlePack>(path);
+    for (std::size_t i = 0; i < pack->size(); ++i) {
+      std::unique_ptr<Job> job(new Job);
+      job->name = pack_entry_path(path, i);
+      job->pack = pack;
+      job->pack_index = i;
+
+      //keep entry names from escaping the output directory
+      stdfs::path name(pack->entries()[i].name);
+      if (name.empty() || name.is_absolute()
+          || std::find(name.begin(), name.end(), "..") != name.end())
+        name = stdfs::path(path).stem().string() + std::to_string(i);
+      job->output = opts.output_dir / name;
+      add_job(std::move(job), path);
+    }
+  } else if (stdfs::is_directory(path)) {
+    for (const auto& entry : stdfs::recursive_directory_iterator(path)) {
+      if (!stdfs::is_regular_file(entry.path())
+          || !is_puzzle_file(entry.path().string()))
+        continue;
+
+      std::unique_ptr<Job> job(new Job);
+      job->name = job->input = entry.path().string();
+      std::string name = job->input.substr(path.size());
+      name.erase(0, name.find_first_not_of("/\\"));
+      job->output = opts.output_dir / name;
+      add_job(std::move(job), entry.path());
+    }
+  } else {
+    std::unique_ptr<Job> job(new Job);
+    job->name = job->input = path;
+    job->output = opts.output_dir / stdfs::path(path).filename();
+    add_job(std::move(job), path);
+  }
+}
+
+void parse_stage(JobQueue& in, JobQueue& out, Totals& totals)
+{
+  std::unique_ptr<Job> job;
+  while (in.pop(job)) {
+    try {
+      if (job->pack) {
+        job->pack->load(job->pack_index, job->puzzle);
+      } else if (!read_puzzle_file(job->input, job->puzzle,
+                                   puzzle_format(job->input))) {
+        throw std::runtime_error("could not open file");
+      }
+    } catch (const std::exception& e) {
+      report_error(job->name, e.what());
+      ++totals.errors;
+      continue;
+    }
+
+    if (!out.push(std::move(job)))
+      return;
+  }
+}
+
+/*
+ * Checks that each puzzle has a unique solution. The search stops as
+ * soon as a second solution turns up. If keep_solution is set, the
+ * solved grid is passed on with the puzzle.
+ */
+void check_stage(JobQueue& in, JobQueue& out, Totals& totals,
+                 bool keep_solution)
+{
+  std::unique_ptr<Job> job;
+  while (in.pop(job)) {
+    try {
+      Puzzle puzzle = job->puzzle;
+      puzzle.clear_all_cells();
+      Solver solver(puzzle);
+      while (!solver.step() && solver.num_solutions() < 2) { }
+
+      if (solver.num_solutions() != 1) {
+        report_error(job->name, solver.num_solutions() == 0
+                     ? "puzzle has no solution"
+                     : "puzzle has more than one solution");
+        ++totals.rejected;
+        continue;
+      }
+
+      if (keep_solution) {
+        solver.cycle_solution();
+        job->puzzle = std::move(puzzle);
+      }
+    } catch (const std::exception& e) {
+      report_error(job->name, e.what());
+      ++totals.errors;
+      continue;
+    }
+
+    if (!out.push(std::move(job)))
+      return;
+  }
+}
+
+void write_stage(const Options& opts, JobQueue& in, Totals& totals)
+{
+  std::unique_ptr<Job> job;
+  while (in.pop(job)) {
+    try {
+      std::ostringstream ss;
+      write_puzzle(ss, job->puzzle, opts.format);
+      std::string data = ss.str();
+
+      if (opts.update && has_contents(job->output, data)) {
+        ++totals.unchanged;
+        continue;
+      }
+
+      //another thread may create the same directory at the same time
+      std::error_code ec;
+      stdfs::create_directories(job->output.parent_path(), ec);
+
+      std::ofstream file(job->output.string(), std::ios::binary);
+      if (!file.is_open() || !file.write(data.data(), data.size()))
+        throw std::runtime_error("could not write " + job->output.string());
+      ++totals.converted;
+    } catch (const std::exception& e) {
+      report_error(job->name, e.what());
+      ++totals.errors;
+    }
+  }
+}
+
+// Run func on the given number of threads
+std::vector<std::thread> start_stage(unsigned num_threads,
+                                     std::function<void()> func)
+{
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < num_threads; ++i)
+    threads.emplace_back(func);
+  return threads;
+}
+
+void finish_stage(std::vector<std::thread>& threads, JobQueue& out)
+{
+  for (auto& thread : threads)
+    thread.join();
+  out.close();
+}
+
+int convert(const Options& opts)
+{
+  auto start_time = std::chrono::steady_clock::now();
+  unsigned num_threads = opts.num_threads;
+  if (num_threads == 0)
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  std::size_t capacity = 4 * num_threads;
+  JobQueue parse_queue(capacity), check_queue(capacity),
+    write_queue(capacity);
+  JobQueue& parsed = opts.unique ? check_queue : write_queue;
+  Totals totals;
+
+  auto parsers = start_stage(num_threads, [&]() {
+      parse_stage(parse_queue, parsed, totals); });
+  std::vector<std::thread> checkers;
+  if (opts.unique) {
+    checkers = start_stage(num_threads, [&]() {
+        check_stage(check_queue, write_queue, totals,
+                    opts.format == PuzzleFormat::png); });
+  }
+  auto writers = start_stage(num_threads, [&]() {
+      write_stage(opts, write_queue, totals); });
+
+  std::map<std::string, std::string> outputs;
+  for (const auto& path : opts.paths) {
+    try {
+      find_jobs(opts, path, parse_queue, totals, outputs);
+    } catch (const std::exception& e) {
+      report_error(path, e.what());
+      ++totals.errors;
+    }
+  }
+  parse_queue.close();
+
+  finish_stage(parsers, parsed);
+  if (opts.unique)
+    finish_stage(checkers, write_queue);
+  for (auto& thread : writers)
+    thread.join();
+
+  if (!opts.quiet) {
+    std::chrono::duration<double> elapsed
+      = std::chrono::steady_clock::now() - start_time;
+    std::cout << "Converted " << totals.converted << " puzzles";
+    if (totals.unchanged)
+      std::cout << ", " << totals.unchanged << " unchanged";
+    if (totals.rejected)
+      std::cout << ", " << totals.rejected << " without a unique solution";
+    if (totals.errors)
+      std::cout << ", " << totals.errors << " errors";
+    std::cout << " in " << elapsed.count() << " s\n";
+  }
+  return totals.errors || totals.rejected ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  Options opts;
+  std::vector<std::string> positional;
+  try {
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      if (args[i] == "-j" && i + 1 < args.size()) {
+        int n = std::atoi(args[++i].c_str());
+        if (n <= 0)
+          throw std::invalid_argument("nonny-convert: invalid thread count "
+                                      + args[i]);
+        opts.num_threads = n;
+      } else if (args[i] == "-u" || args[i] == "--update") {
+        opts.update = true;
+      } else if (args[i] == "--unique") {
+        opts.unique = true;
+      } else if (args[i] == "-q" || args[i] == "--quiet") {
+        opts.quiet = true;
+      } else if (args[i].size() > 1 && args[i][0] == '-') {
+        positional.clear();
+        break;
+      } else {
+        positional.push_back(args[i]);
+      }
+    }
+
+    if (positional.size() < 3) {
+      std::cerr << usage;
+      return 2;
+    }
+
+    opts.extension = positional[0];
+    if (opts.extension[0] != '.')
+      opts.extension.insert(0, ".");
+    if (!is_puzzle_file("puzzle" + opts.extension))
+      throw std::invalid_argument("nonny-convert: cannot convert to "
+                                  + opts.extension);
+    opts.format = puzzle_format(opts.extension);
+    if (opts.format == PuzzleFormat::png) //images show the solution
+      opts.unique = true;
+    opts.output_dir = positional[1];
+    opts.paths.assign(positional.begin() + 2, positional.end());
+
+    return convert(opts);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
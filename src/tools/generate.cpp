@@ -0,0 +1,269 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Command-line tool for generating random puzzles. Each worker thread
+ * runs its own generator and hands finished puzzles to the main thread,
+ * which writes them out. Every puzzle is generated from a seed derived
+ * from its number, so the output for a given seed does not depend on
+ * the number of threads or how they are scheduled.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_generator.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "utility/bounded_queue.hpp"
+
+namespace stdfs = std::experimental::filesystem;
+
+const char usage[] =
+  "Usage: nonny-generate [OPTION]... EXTENSION OUTPUT_DIR\n"
+  "\n"
+  "Generate random puzzles with exactly one solution in the format\n"
+  "given by EXTENSION (.non, .g, .mk, .nin, .nbn, or .png), writing them\n"
+  "to OUTPUT_DIR.\n"
+  "\n"
+  "Options:\n"
+  "  -n N             generate N puzzles (default: 100)\n"
+  "  -s WxH           puzzle size (default: 25x25)\n"
+  "  -d DENSITY       fraction of cells filled, between 0 and 1\n"
+  "                   (default: 0.5)\n"
+  "  -c N             use N foreground colors (default: 1)\n"
+  "  --noise SCALE    draw shapes about SCALE cells across (default: 4);\n"
+  "                   0 fills each cell independently, which needs a\n"
+  "                   density of about 0.6 or more\n"
+  "  --line-solvable  only keep puzzles that can be solved one line at\n"
+  "                   a time, without guessing\n"
+  "  --seed N         seed for the random number generator; the same\n"
+  "                   seed gives the same puzzles with any -j\n"
+  "  -j N             use N threads (default: one per core)\n"
+  "  -q, --quiet      only report errors\n";
+
+struct Options {
+  std::string extension;
+  PuzzleFormat format = PuzzleFormat::non;
+  stdfs::path output_dir;
+  GeneratorOptions generator;
+  int count = 100;
+  unsigned seed = 0;
+  unsigned num_threads = 0;
+  bool quiet = false;
+};
+
+struct Result {
+  int number = 0;
+  Puzzle puzzle;
+};
+
+typedef BoundedQueue<std::unique_ptr<Result>> ResultQueue;
+
+struct Totals {
+  std::atomic<long> candidates{0};
+  std::atomic<long> repairs{0};
+};
+
+int parse_int(const std::string& arg, int min_value)
+{
+  int n = std::atoi(arg.c_str());
+  if (n < min_value)
+    throw std::invalid_argument("nonny-generate: invalid number " + arg);
+  return n;
+}
+
+void generate_stage(const Options& opts, std::atomic<int>& next_number,
+                    ResultQueue& out, Totals& totals)
+{
+  PuzzleGenerator generate(opts.generator, opts.seed);
+  std::string size = std::to_string(opts.generator.width) + "x"
+    + std::to_string(opts.generator.height);
+
+  int number;
+  while ((number = next_number++) < opts.count) {
+    std::unique_ptr<Result> result(new Result);
+    result->number = number + 1;
+    generate.seed(opts.seed + number);
+    result->puzzle = generate();
+    result->puzzle.set_property("title", "Random " + size + " #"
+                                + std::to_string(result->number));
+    result->puzzle.set_property("by", "nonny-generate");
+
+    if (!out.push(std::move(result)))
+      break;
+  }
+
+  totals.candidates += generate.num_candidates();
+  totals.repairs += generate.num_repairs();
+}
+
+std::string output_name(const Options& opts, int number)
+{
+  std::string digits = std::to_string(number);
+  std::size_t width = std::to_string(opts.count).size();
+  if (digits.size() < width)
+    digits.insert(0, width - digits.size(), '0');
+  return std::to_string(opts.generator.width) + "x"
+    + std::to_string(opts.generator.height) + "-" + digits + opts.extension;
+}
+
+int generate(const Options& opts)
+{
+  auto start_time = std::chrono::steady_clock::now();
+  unsigned num_threads = opts.num_threads;
+  if (num_threads == 0)
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  std::error_code ec;
+  stdfs::create_directories(opts.output_dir, ec);
+  if (ec)
+    throw std::runtime_error("nonny-generate: could not create "
+                             + opts.output_dir.string());
+
+  ResultQueue queue(4 * num_threads);
+  std::atomic<int> next_number{0};
+  Totals totals;
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    workers.emplace_back([&]() {
+        generate_stage(opts, next_number, queue, totals); });
+  }
+
+  int written = 0, errors = 0;
+  std::unique_ptr<Result> result;
+  for (int i = 0; i < opts.count && queue.pop(result); ++i) {
+    stdfs::path filename = opts.output_dir
+      / output_name(opts, result->number);
+    try {
+      //the grid holds the solution, which only images should show
+      if (opts.format != PuzzleFormat::png)
+        result->puzzle.clear_all_cells();
+
+      std::ostringstream ss;
+      write_puzzle(ss, result->puzzle, opts.format);
+      std::string data = ss.str();
+
+      std::ofstream file(filename.string(), std::ios::binary);
+      if (!file.is_open() || !file.write(data.data(), data.size()))
+        throw std::runtime_error("could not write file");
+      ++written;
+    } catch (const std::exception& e) {
+      std::cerr << "nonny-generate: " << filename.string() << ": "
+                << e.what() << "\n";
+      ++errors;
+    }
+  }
+  queue.close();
+  for (auto& thread : workers)
+    thread.join();
+
+  if (!opts.quiet) {
+    std::chrono::duration<double> elapsed
+      = std::chrono::steady_clock::now() - start_time;
+    std::cout << "Generated " << written << " puzzles from "
+              << totals.candidates << " grids and " << totals.repairs
+              << " repairs";
+    if (errors)
+      std::cout << ", " << errors << " errors";
+    std::cout << " in " << elapsed.count() << " s\n";
+  }
+  return errors ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  Options opts;
+  opts.seed = std::random_device()();
+  std::vector<std::string> positional;
+  try {
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      bool has_value = i + 1 < args.size();
+      if (args[i] == "-n" && has_value) {
+        opts.count = parse_int(args[++i], 1);
+      } else if (args[i] == "-s" && has_value) {
+        std::string size = args[++i];
+        std::size_t x = size.find('x');
+        if (x == std::string::npos)
+          throw std::invalid_argument("nonny-generate: invalid size " + size);
+        opts.generator.width = parse_int(size.substr(0, x), 1);
+        opts.generator.height = parse_int(size.substr(x + 1), 1);
+      } else if (args[i] == "-d" && has_value) {
+        opts.generator.density = std::atof(args[++i].c_str());
+      } else if (args[i] == "-c" && has_value) {
+        opts.generator.num_colors = parse_int(args[++i], 1);
+      } else if (args[i] == "--noise" && has_value) {
+        opts.generator.noise_scale = parse_int(args[++i], 0);
+      } else if (args[i] == "--line-solvable") {
+        opts.generator.line_solvable = true;
+      } else if (args[i] == "--seed" && has_value) {
+        opts.seed = std::strtoul(args[++i].c_str(), nullptr, 10);
+      } else if (args[i] == "-j" && has_value) {
+        opts.num_threads = parse_int(args[++i], 1);
+      } else if (args[i] == "-q" || args[i] == "--quiet") {
+        opts.quiet = true;
+      } else if (args[i].size() > 1 && args[i][0] == '-') {
+        positional.clear();
+        break;
+      } else {
+        positional.push_back(args[i]);
+      }
+    }
+
+    if (positional.size() != 2) {
+      std::cerr << usage;
+      return 2;
+    }
+
+    opts.extension = positional[0];
+    if (opts.extension[0] != '.')
+      opts.extension.insert(0, ".");
+    if (!is_puzzle_file("puzzle" + opts.extension))
+      throw std::invalid_argument("nonny-generate: cannot write "
+                                  + opts.extension);
+    opts.format = puzzle_format(opts.extension);
+    if (opts.generator.num_colors > 1 && (opts.format == PuzzleFormat::mk
+                                          || opts.format == PuzzleFormat::nin))
+      throw std::invalid_argument("nonny-generate: " + opts.extension
+                                  + " files cannot hold multicolor puzzles");
+    opts.output_dir = positional[1];
+
+    //check the settings before starting any threads
+    PuzzleGenerator(opts.generator, opts.seed);
+
+    return generate(opts);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
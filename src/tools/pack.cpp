@@ -0,0 +1,181 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Command-line tool for creating, listing, and extracting puzzle pack
+ * files.
+ */
+
+#include <algorithm>
+#include <experimental/filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "puzzle/puzzle_pack.hpp"
+
+namespace stdfs = std::experimental::filesystem;
+
+const char usage[] =
+  "Usage: nonny-pack pack PACK_FILE PATH...\n"
+  "       nonny-pack unpack PACK_FILE DIRECTORY [EXTENSION]\n"
+  "       nonny-pack list PACK_FILE\n"
+  "\n"
+  "pack    Create PACK_FILE from puzzle files and directories of puzzle\n"
+  "        files. Directories are searched recursively.\n"
+  "unpack  Write every puzzle in PACK_FILE to DIRECTORY, in the format\n"
+  "        given by EXTENSION (default .non).\n"
+  "list    Show the contents of PACK_FILE.\n";
+
+/*
+ * Collect the puzzle files under a path, along with the names they
+ * will have in the pack (relative to the directory that was given).
+ */
+void find_puzzles(const stdfs::path& path,
+                  std::vector<std::pair<std::string, stdfs::path>>& files)
+{
+  if (stdfs::is_directory(path)) {
+    std::vector<std::pair<std::string, stdfs::path>> found;
+    for (const auto& entry : stdfs::recursive_directory_iterator(path)) {
+      std::string filename = entry.path().string();
+      if (stdfs::is_regular_file(entry.path()) && is_puzzle_file(filename)
+          && puzzle_format(filename) != PuzzleFormat::png) {
+        std::string name = filename.substr(path.string().size());
+        std::replace(name.begin(), name.end(), '\\', '/');
+        name.erase(0, name.find_first_not_of('/'));
+        found.emplace_back(name, entry.path());
+      }
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+  } else {
+    files.emplace_back(path.filename().string(), path);
+  }
+}
+
+int pack(const std::string& pack_filename,
+         const std::vector<std::string>& paths)
+{
+  std::vector<std::pair<std::string, stdfs::path>> files;
+  for (const auto& path : paths)
+    find_puzzles(path, files);
+
+  PuzzlePackWriter writer(pack_filename);
+  std::map<std::uint64_t, std::string> hashes;
+  int errors = 0;
+  for (const auto& file : files) {
+    Puzzle puzzle;
+    try {
+      if (!read_puzzle_file(file.second.string(), puzzle,
+                            puzzle_format(file.second.string())))
+        throw std::runtime_error("could not open file");
+    } catch (const std::exception& e) {
+      std::cerr << "nonny-pack: skipping " << file.second.string()
+                << ": " << e.what() << "\n";
+      ++errors;
+      continue;
+    }
+
+    writer.add(file.first, puzzle);
+    auto hash = writer.entries().back().clue_hash;
+    auto dup = hashes.find(hash);
+    if (dup != hashes.end())
+      std::cerr << "nonny-pack: warning: " << file.first
+                << " has the same clues as " << dup->second << "\n";
+    else
+      hashes[hash] = file.first;
+  }
+  writer.close();
+
+  std::cout << "Packed " << writer.entries().size() << " puzzles into "
+            << pack_filename << "\n";
+  return errors ? 1 : 0;
+}
+
+int unpack(const std::string& pack_filename, const std::string& dir,
+           std::string extension)
+{
+  if (extension.empty() || extension[0] != '.')
+    extension.insert(0, ".");
+  PuzzleFormat fmt = puzzle_format(extension);
+  if (fmt == PuzzleFormat::png)
+    throw std::runtime_error("nonny-pack: cannot unpack to " + extension);
+
+  PuzzlePack pack(pack_filename);
+  for (std::size_t i = 0; i < pack.size(); ++i) {
+    //keep entry names from escaping the output directory
+    stdfs::path name(pack.entries()[i].name);
+    if (name.empty() || name.is_absolute()
+        || std::find(name.begin(), name.end(), "..") != name.end())
+      name = "puzzle" + std::to_string(i);
+    stdfs::path dest = stdfs::path(dir) / name;
+    dest.replace_extension(extension);
+    stdfs::create_directories(dest.parent_path());
+
+    Puzzle puzzle;
+    pack.load(i, puzzle);
+
+    std::ofstream file(dest.string(), std::ios::binary);
+    if (!file.is_open())
+      throw std::runtime_error("nonny-pack: could not create "
+                               + dest.string());
+    write_puzzle(file, puzzle, fmt);
+  }
+
+  std::cout << "Unpacked " << pack.size() << " puzzles into "
+            << dir << "\n";
+  return 0;
+}
+
+int list(const std::string& pack_filename)
+{
+  PuzzlePack pack(pack_filename);
+  for (const auto& entry : pack.entries()) {
+    std::cout << entry.name << "\t" << entry.summary.width << "x"
+              << entry.summary.height << "\t"
+              << (entry.summary.is_multicolor ? "color" : "mono") << "\t"
+              << entry.summary.title << "\n";
+  }
+  return 0;
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  try {
+    if (args.size() >= 3 && args[0] == "pack")
+      return pack(args[1], std::vector<std::string>(args.begin() + 2,
+                                                    args.end()));
+    else if ((args.size() == 3 || args.size() == 4) && args[0] == "unpack")
+      return unpack(args[1], args[2], args.size() == 4 ? args[3] : ".non");
+    else if (args.size() == 2 && args[0] == "list")
+      return list(args[1]);
+
+    std::cerr << usage;
+    return 2;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
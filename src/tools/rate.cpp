@@ -0,0 +1,220 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+/*
+ * Command-line tool for rating the difficulty of puzzles. Each puzzle
+ * is solved by DifficultyRater and printed with its score and the
+ * number of cells each technique settled.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_io.hpp"
+#include "puzzle/puzzle_pack.hpp"
+#include "solver/difficulty_rater.hpp"
+
+namespace stdfs = std::experimental::filesystem;
+
+const char usage[] =
+  "Usage: nonny-rate [OPTION]... PATH...\n"
+  "\n"
+  "Rate the difficulty of puzzle files, directories of puzzle files, and\n"
+  "puzzle packs. For each puzzle, print its score followed by the cells\n"
+  "settled by overlap, by complete line logic, and by probing, and the\n"
+  "number of guesses needed. A score of 1.0 means the puzzle can be\n"
+  "solved by overlap alone; harder techniques raise the score.\n"
+  "\n"
+  "Options:\n"
+  "  -j N          use N threads (default: one per core)\n"
+  "  -s, --sort    list puzzles from easiest to hardest\n";
+
+struct Options {
+  std::vector<std::string> paths;
+  unsigned num_threads = 0;
+  bool sort = false;
+};
+
+struct Job {
+  std::string name;
+  std::shared_ptr<const PuzzlePack> pack;
+  std::size_t pack_index = 0;
+
+  bool ok = false;
+  std::string error;
+  DifficultyRating rating;
+};
+
+void find_jobs(const std::string& path, std::vector<Job>& jobs)
+{
+  if (is_pack_file(path)) {
+    auto pack = std::make_shared<const PuzzlePack>(path);
+    for (std::size_t i = 0; i < pack->size(); ++i) {
+      Job job;
+      job.name = pack_entry_path(path, i);
+      job.pack = pack;
+      job.pack_index = i;
+      jobs.push_back(std::move(job));
+    }
+  } else if (stdfs::is_directory(path)) {
+    std::vector<std::string> files;
+    for (const auto& entry : stdfs::recursive_directory_iterator(path)) {
+      if (stdfs::is_regular_file(entry.path())
+          && is_puzzle_file(entry.path().string()))
+        files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    for (auto& file : files) {
+      Job job;
+      job.name = std::move(file);
+      jobs.push_back(std::move(job));
+    }
+  } else {
+    Job job;
+    job.name = path;
+    jobs.push_back(std::move(job));
+  }
+}
+
+void rate(Job& job)
+{
+  try {
+    Puzzle puzzle;
+    if (job.pack)
+      job.pack->load(job.pack_index, puzzle);
+    else if (!read_puzzle_file(job.name, puzzle, puzzle_format(job.name)))
+      throw std::runtime_error("could not open file");
+
+    puzzle.clear_all_cells();
+    DifficultyRater rater(puzzle);
+    rater();
+    job.rating = rater.rating();
+    job.ok = true;
+  } catch (const std::exception& e) {
+    job.error = e.what();
+  }
+}
+
+void print(const Job& job)
+{
+  if (!job.ok) {
+    std::cerr << "nonny-rate: " << job.name << ": " << job.error << "\n";
+    return;
+  }
+
+  const DifficultyRating& r = job.rating;
+  std::printf("%6.2f %7d %7d %7d %7d  %s", r.score(),
+              r[Technique::overlap].cells, r[Technique::line_logic].cells,
+              r[Technique::probing].cells, r[Technique::guessing].steps,
+              job.name.c_str());
+  if (r.num_solutions == 0)
+    std::printf(" (no solution)");
+  else if (r.num_solutions > 1)
+    std::printf(" (not unique)");
+  std::printf("\n");
+}
+
+int run(const Options& opts)
+{
+  std::vector<Job> jobs;
+  int errors = 0;
+  for (const auto& path : opts.paths) {
+    try {
+      find_jobs(path, jobs);
+    } catch (const std::exception& e) {
+      std::cerr << "nonny-rate: " << path << ": " << e.what() << "\n";
+      ++errors;
+    }
+  }
+
+  unsigned num_threads = opts.num_threads;
+  if (num_threads == 0)
+    num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  std::atomic<std::size_t> next_job{0};
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&]() {
+        std::size_t index;
+        while ((index = next_job++) < jobs.size())
+          rate(jobs[index]);
+      });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  if (opts.sort) {
+    std::stable_sort(jobs.begin(), jobs.end(),
+                     [](const Job& a, const Job& b) {
+                       return a.rating.score() < b.rating.score(); });
+  }
+
+  std::printf("%6s %7s %7s %7s %7s  %s\n", "score", "overlap", "line",
+              "probing", "guesses", "puzzle");
+  for (const auto& job : jobs) {
+    print(job);
+    if (!job.ok)
+      ++errors;
+  }
+  return errors ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  Options opts;
+  try {
+    for (std::size_t i = 0; i < args.size(); ++i) {
+      if (args[i] == "-j" && i + 1 < args.size()) {
+        int n = std::atoi(args[++i].c_str());
+        if (n <= 0)
+          throw std::invalid_argument("nonny-rate: invalid thread count "
+                                      + args[i]);
+        opts.num_threads = n;
+      } else if (args[i] == "-s" || args[i] == "--sort") {
+        opts.sort = true;
+      } else if (args[i].size() > 1 && args[i][0] == '-') {
+        opts.paths.clear();
+        break;
+      } else {
+        opts.paths.push_back(args[i]);
+      }
+    }
+
+    if (opts.paths.empty()) {
+      std::cerr << usage;
+      return 2;
+    }
+
+    return run(opts);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
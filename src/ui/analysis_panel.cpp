@@ -21,6 +21,8 @@
 #include "ui/analysis_panel.hpp"
 
 #include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include <string>
 #include "color/color.hpp"
 #include "input/input_handler.hpp"
@@ -35,13 +37,32 @@ constexpr int text_spacing = 8;
 constexpr int preview_size = 256;
 constexpr int button_width = 150;
 constexpr unsigned solution_cycle_duration = 1000;
+constexpr int rating_steps_per_update = 8;
+
+//guesses make scores unbounded, so larger ones are shown as ">999.99"
+constexpr double max_shown_score = 999.99;
 
 AnalysisPanel::AnalysisPanel(const Font& font, const Puzzle& puzzle)
-  : m_puzzle(puzzle), m_solver(m_puzzle), m_font(font)
+  : m_puzzle(puzzle), m_solver(m_puzzle), m_font(font),
+    m_rating_puzzle(puzzle)
 {
   setup_buttons();
   calc_size();
   m_puzzle.clear_all_cells();
+  m_rating_puzzle.clear_all_cells();
+  m_rater.reset(new DifficultyRater(m_rating_puzzle));
+}
+
+bool AnalysisPanel::is_working() const
+{
+  return m_solver_running || !m_rater->is_finished();
+}
+
+unsigned AnalysisPanel::time_until_next_solution() const
+{
+  if (m_sol_cycle_time >= solution_cycle_duration)
+    return 0;
+  return solution_cycle_duration - m_sol_cycle_time;
 }
 
 void AnalysisPanel::update(unsigned ticks, InputHandler& input,
@@ -58,6 +79,10 @@ void AnalysisPanel::update(unsigned ticks, InputHandler& input,
     }
   }
 
+  for (int i = 0; i < rating_steps_per_update && !m_rater->is_finished();
+       ++i)
+    m_rater->step();
+
   if (m_solver.is_finished()) {
     m_sol_cycle_time += ticks;
     if (m_sol_cycle_time >= solution_cycle_duration) {
@@ -153,6 +178,38 @@ void AnalysisPanel::draw(Renderer& renderer, const Rect& region) const
     y += r.height() + text_spacing;
   }
 
+  //the breakdown is shown as it is gathered
+  const DifficultyRating& rating = m_rater->rating();
+  std::string score_str = "Difficulty: ?";
+  if (m_rater->is_finished() && rating.num_solutions != 1) {
+    score_str = "Difficulty: -";
+  } else if (m_rater->is_finished()) {
+    std::ostringstream ss;
+    ss << "Difficulty: " << std::fixed << std::setprecision(2);
+    if (rating.score() > max_shown_score)
+      ss << ">" << max_shown_score;
+    else
+      ss << rating.score();
+    score_str = ss.str();
+  }
+  r = renderer.draw_text(Point(x, y), m_font, score_str);
+  y += r.height() + text_spacing;
+
+  std::string cells_str[] = {
+    "Overlap: " + std::to_string(rating[Technique::overlap].cells)
+    + " cells",
+    "Line logic: " + std::to_string(rating[Technique::line_logic].cells)
+    + " cells",
+    "Probing: " + std::to_string(rating[Technique::probing].cells)
+    + " cells",
+    "Guessing: " + std::to_string(rating[Technique::guessing].steps)
+    + " guesses"
+  };
+  for (const auto& str : cells_str) {
+    r = renderer.draw_text(Point(x + text_spacing, y), m_font, str);
+    y += r.height() + text_spacing;
+  }
+
   m_preview.draw(renderer, region);
   m_solve_button.draw(renderer, region);
   m_close_button.draw(renderer, region);
@@ -209,6 +266,14 @@ void AnalysisPanel::calc_size()
   width = std::max(width, text_wd + 2 * panel_spacing);
   height += text_ht + panel_spacing;
 
+  m_font.text_size("Difficulty: >nnn.nn", &text_wd, &text_ht);
+  width = std::max(width, text_wd + 2 * panel_spacing);
+  height += text_ht + text_spacing;
+
+  m_font.text_size("Line logic: nnnnn cells", &text_wd, &text_ht);
+  width = std::max(width, text_wd + text_spacing + 2 * panel_spacing);
+  height += 4 * (text_ht + text_spacing);
+
   int preview_width = preview_size;
   int preview_height = preview_width
     * m_puzzle.height() / m_puzzle.width();
@@ -22,7 +22,9 @@
 #define NONNY_ANALYSIS_PANEL_HPP
 
 #include <functional>
+#include <memory>
 #include "puzzle/puzzle.hpp"
+#include "solver/difficulty_rater.hpp"
 #include "solver/solver.hpp"
 #include "ui/button.hpp"
 #include "ui/puzzle_preview.hpp"
@@ -49,6 +51,15 @@ public:
 
   void move(int x, int y) override;
 
+  // Is the solver or the difficulty rater still running?
+  bool is_working() const;
+
+  // Once solving is done, the panel cycles through the solutions
+  bool is_cycling_solutions() const { return m_solver.is_finished(); }
+  unsigned time_until_next_solution() const; //in milliseconds
+
+  long num_lines_solved() const { return m_solver.num_lines_solved(); }
+
 private:
   void setup_buttons();
   void calc_size();
@@ -59,6 +70,10 @@ private:
   Solver m_solver;
   const Font& m_font;
 
+  //the rating runs on its own copy while the panel is open
+  Puzzle m_rating_puzzle;
+  std::unique_ptr<DifficultyRater> m_rater;
+
   PuzzlePreview m_preview;
   Button m_solve_button;
   Button m_close_button;
@@ -43,6 +43,12 @@ public:
   virtual bool can_focus() const { return true; }
   virtual bool has_focus() const { return m_focused; }
 
+  /*
+   * Milliseconds until the control changes on its own, as a blinking
+   * cursor does, or -1 if it only changes in response to input.
+   */
+  virtual int time_until_update() const { return -1; }
+
 private:
   bool m_focused = false;
 };
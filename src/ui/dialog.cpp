@@ -137,6 +137,17 @@ void Dialog::move(int x, int y)
     c->scroll(x - old_x, y - old_y);
 }
 
+int Dialog::time_until_update() const
+{
+  int result = -1;
+  for (auto& c : m_controls) {
+    int t = c->time_until_update();
+    if (t >= 0 && (result < 0 || t < result))
+      result = t;
+  }
+  return result;
+}
+
 void Dialog::find_focus()
 {
   m_focused = std::find_if(m_controls.begin(), m_controls.end(),
@@ -48,6 +48,9 @@ public:
 
   void move(int x, int y) override;
 
+  // The soonest any control changes on its own; see Control
+  int time_until_update() const;
+
 protected:
   void find_focus();
   void give_focus();
@@ -21,12 +21,14 @@
 #include "ui/file_selection_panel.hpp"
 
 #include <algorithm>
-#include <fstream>
+#include <cstdint>
 #include <experimental/filesystem>
 #include "color/color.hpp"
 #include "input/input_handler.hpp"
 #include "puzzle/puzzle_io.hpp"
+#include "puzzle/puzzle_pack.hpp"
 #include "save/save_manager.hpp"
+#include "utility/trace.hpp"
 #include "utility/utility.hpp"
 #include "video/font.hpp"
 #include "video/renderer.hpp"
@@ -38,7 +40,6 @@ const Color background_color = default_colors::white;
 const Color foreground_color = default_colors::black;
 const Color selection_color = default_colors::blue;
 constexpr int spacing = 4;
-constexpr int max_puzzles_open = 9999;
 
 FileSelectionPanel::FileSelectionPanel(SaveManager& save_mgr,
                                        Font& filename_font, Font& info_font,
@@ -48,11 +49,18 @@ FileSelectionPanel::FileSelectionPanel(SaveManager& save_mgr,
     m_filename_font(filename_font),
     m_info_font(info_font),
     m_icon_texture(icons),
-    m_path(path)
+    m_path(path),
+    m_loader(save_mgr)
 {
   load_file_list();
 }
 
+FileSelectionPanel::~FileSelectionPanel()
+{
+  receive_puzzle_info();
+  m_cache.write();
+}
+
 void FileSelectionPanel::open_path(const std::string& path)
 {
   if (m_path != path) {
@@ -106,10 +114,9 @@ void FileSelectionPanel::update(unsigned ticks, InputHandler& input,
                                 const Rect& active_region)
 {
   if (!m_files.empty()) {
-    //see if we have new puzzle to read
-    if (m_num_puzzles_loaded < static_cast<int>(m_files.size())
-        && m_num_puzzles_loaded < max_puzzles_open)
-      load_puzzle_info();
+    //collect puzzle information loaded in the background
+    prioritize_visible(active_region);
+    receive_puzzle_info();
 
     //check for mouse click to select a file
     Point cursor = input.mouse_position();
@@ -221,18 +228,16 @@ void FileSelectionPanel::draw(Renderer& renderer, const Rect& region) const
       renderer.set_draw_color(foreground_color);
       renderer.draw_rect(dest);
 
-      auto prog = m_files[i].puzzle_progress;
-      if (prog && !prog->is_complete() && prog->current_time() == 0) {
+      const auto& info = m_files[i].puzzle_info;
+      if (m_files[i].is_loaded && !info->is_complete
+          && info->current_time == 0) {
         int wd = 0, ht = 0;
         m_filename_font.text_size("?", &wd, &ht);
         Point qmark_loc(x + icon_width / 2 - wd / 2,
                         y + icon_height / 2 - ht/ 2);
         renderer.draw_text(qmark_loc, m_filename_font, "?");
-      } else if (prog) {
-        if (prog->is_complete())
-          draw_progress(renderer, prog->solution(), dest);
-        else
-          draw_progress(renderer, prog->state(), dest);
+      } else if (m_files[i].is_loaded) {
+        draw_thumbnail(renderer, m_files[i], dest);
       }
     } else {
       renderer.copy_texture(m_icon_texture, src, dest);
@@ -253,41 +258,43 @@ void FileSelectionPanel::draw(Renderer& renderer, const Rect& region) const
 
     if (m_files[i].type == FileInfo::Type::puzzle_file) {
       if (m_files[i].puzzle_info) {
+        const PuzzleSummary& summary = m_files[i].puzzle_info->summary;
+        bool is_complete = m_files[i].is_loaded
+          && m_files[i].puzzle_info->is_complete;
+
         std::string title;
-        if (m_files[i].puzzle_info->title.empty())
+        if (summary.title.empty())
           title = "Untitled";
         else {
-          if (!m_files[i].puzzle_progress
-              || !m_files[i].puzzle_progress->is_complete())
+          if (!is_complete)
             title = "???";
           else
-            title = m_files[i].puzzle_info->title;
+            title = summary.title;
         }
-        if (!m_files[i].puzzle_info->author.empty())
-          title += " by " + m_files[i].puzzle_info->author;
+        if (!summary.author.empty())
+          title += " by " + summary.author;
         txt = renderer.draw_text(Point(x, y), m_info_font, title);
         y += txt.height();
 
-        std::string size = std::to_string(m_files[i].puzzle_info->width);
-        size += u8"\u00D7" + std::to_string(m_files[i].puzzle_info->height);
-        if (m_files[i].puzzle_info->is_multicolor)
+        std::string size = std::to_string(summary.width);
+        size += u8"\u00D7" + std::to_string(summary.height);
+        if (summary.is_multicolor)
           size += " Multicolor";
         txt = renderer.draw_text(Point(x, y), m_info_font, size);
         x += txt.width();
 
-        if (m_files[i].puzzle_progress) {
+        if (m_files[i].is_loaded) {
           txt = renderer.draw_text(Point(x, y),
                                    m_info_font, "    Completed:");
           x += txt.width();
 
-          if (m_files[i].puzzle_progress->is_complete()) {
+          if (is_complete) {
             txt = renderer.draw_text(Point(x, y), m_info_font, " Yes");
             x += txt.width();
 
             std::string time_str = "    Best time: ";
             time_str
-              += time_to_string(m_files[i].puzzle_progress->best_time(),
-                                true);
+              += time_to_string(m_files[i].puzzle_info->best_time, true);
             renderer.draw_text(Point(x, y), m_info_font, time_str);
           } else {
             renderer.set_draw_color(default_colors::red);
@@ -305,31 +312,59 @@ void FileSelectionPanel::draw(Renderer& renderer, const Rect& region) const
   renderer.set_clip_rect();
 }
 
-void FileSelectionPanel::draw_progress(Renderer& renderer,
-                                       const PuzzleGrid& grid,
-                                       const Rect& area) const
+void FileSelectionPanel::draw_thumbnail(Renderer& renderer,
+                                        const FileInfo& file,
+                                        const Rect& area) const
 {
-  if (!grid.width() || !grid.height())
+  const PuzzleThumbnail& thumbnail = file.puzzle_info->thumbnail;
+  if (!thumbnail.width || !thumbnail.height)
+    return;
+
+  int pixel_size = area.width() / thumbnail.width;
+  if (area.height() / thumbnail.height < pixel_size)
+    pixel_size = area.height() / thumbnail.height;
+  if (pixel_size <= 0)
+    return;
+
+  Point start(area.x() + area.width() / 2 - pixel_size * thumbnail.width / 2,
+              area.y() + area.height() / 2
+              - pixel_size * thumbnail.height / 2);
+
+  //a puzzle too large for a texture is drawn one cell at a time
+  if (!renderer.can_create_texture(thumbnail.width, thumbnail.height)) {
+    RectBatch pixels;
+    for (int y = 0; y != thumbnail.height; ++y) {
+      for (int x = 0; x != thumbnail.width; ++x) {
+        const Color* color = thumbnail.at(x, y);
+        if (color)
+          pixels.add(*color, Rect(start.x() + x * pixel_size,
+                                  start.y() + y * pixel_size,
+                                  pixel_size, pixel_size));
+      }
+    }
+    renderer.fill_rects(pixels);
     return;
+  }
 
-  int pixel_size = area.width() / grid.width();
-  if (area.height() / grid.height() < pixel_size)
-    pixel_size = area.height() / grid.height();
-
-  Point start(area.x() + area.width() / 2 - pixel_size * grid.width() / 2,
-              area.y() + area.height() / 2 - pixel_size * grid.height() / 2);
-
-  for (int y = 0; y != grid.height(); ++y) {
-    for (int x = 0; x != grid.width(); ++x) {
-      if (grid.at(x, y).state == PuzzleCell::State::filled) {
-        Rect pixel(start.x() + x * pixel_size,
-                   start.y() + y * pixel_size,
-                   pixel_size, pixel_size);
-        renderer.set_draw_color(grid.at(x, y).color);
-        renderer.fill_rect(pixel);
+  //the texture is made once for each library entry
+  if (!file.thumbnail_texture || file.thumbnail_source != file.puzzle_info) {
+    std::vector<std::uint32_t> pixels(thumbnail.width * thumbnail.height, 0);
+    for (int y = 0; y != thumbnail.height; ++y) {
+      for (int x = 0; x != thumbnail.width; ++x) {
+        const Color* color = thumbnail.at(x, y);
+        if (color)
+          pixels[y * thumbnail.width + x] = to_rgba(*color);
       }
     }
+
+    file.thumbnail_texture = renderer.new_texture(thumbnail.width,
+                                                  thumbnail.height, pixels);
+    file.thumbnail_source = file.puzzle_info;
   }
+
+  Rect dest(start.x(), start.y(),
+            pixel_size * thumbnail.width, pixel_size * thumbnail.height);
+  renderer.copy_texture(*file.thumbnail_texture, Rect(), dest);
 }
 
 void FileSelectionPanel::select(int index)
@@ -367,9 +402,15 @@ void FileSelectionPanel::load_file_list()
   m_files.clear();
   m_selection = 0;
   m_is_selected = false;
-  m_num_puzzles_loaded = 0;
+  m_loader.clear();
 
-  if (!m_path.empty()) {
+  //keep what was learned about the previous directory
+  m_cache.write();
+  m_cache = LibraryCache(m_save_mgr.settings(), m_path);
+
+  if (is_pack_file(m_path) && stdfs::is_regular_file(m_path)) {
+    load_pack_file_list();
+  } else if (!m_path.empty()) {
     stdfs::path p(m_path);
 
     for (const auto& file : stdfs::directory_iterator(p)) {
@@ -378,19 +419,15 @@ void FileSelectionPanel::load_file_list()
       info.filename = file.path().filename().string();
       if (stdfs::is_directory(file))
         info.type = FileInfo::Type::directory;
-      else { //check for puzzle file
-        std::string extension = file.path().extension().string();
-        if (extension == ".non")
-          info.type = FileInfo::Type::puzzle_file;
-        else if (extension == ".g")
-          info.type = FileInfo::Type::puzzle_file;
-        else if (extension == ".mk")
-          info.type = FileInfo::Type::puzzle_file;
-        else if (extension == ".nin")
-          info.type = FileInfo::Type::puzzle_file;
-        else
-          info.type = FileInfo::Type::file;
-      }
+      else if (is_pack_file(info.full_path)) //packs are browsed like folders
+        info.type = FileInfo::Type::directory;
+      //most images are not puzzles, so they are listed as plain files
+      //and only imported when the user opens one
+      else if (is_puzzle_file(info.full_path)
+               && puzzle_format(info.full_path) != PuzzleFormat::png)
+        info.type = FileInfo::Type::puzzle_file;
+      else
+        info.type = FileInfo::Type::file;
       m_files.push_back(info);
     }
   }
@@ -398,6 +435,34 @@ void FileSelectionPanel::load_file_list()
   resize(entry_height() * 3, entry_height() * m_files.size());
 
   sort_files();
+  request_puzzle_info();
+}
+
+/*
+ * List the puzzles in a pack using only the information in its index.
+ */
+void FileSelectionPanel::load_pack_file_list()
+{
+  PuzzlePack pack;
+  try {
+    pack = PuzzlePack(m_path);
+  } catch (const std::exception&) { //show an unreadable pack as empty
+    return;
+  }
+
+  m_files.reserve(pack.size());
+  for (std::size_t i = 0; i < pack.size(); ++i) {
+    const PackEntry& entry = pack.entries()[i];
+    FileInfo info;
+    info.full_path = pack_entry_path(m_path, i);
+    info.filename = entry.name;
+    info.type = FileInfo::Type::puzzle_file;
+    auto summary = std::make_shared<LibraryEntry>();
+    summary->summary = entry.summary;
+    summary->clue_hash = entry.clue_hash;
+    info.puzzle_info = summary;
+    m_files.push_back(std::move(info));
+  }
 }
 
 bool
@@ -416,46 +481,68 @@ void FileSelectionPanel::sort_files()
   std::sort(m_files.begin(), m_files.end(), file_info_less_than);
 }
 
-void FileSelectionPanel::load_puzzle_info()
+/*
+ * Fill in entries that are current in the library cache, and have the
+ * loader read the rest.
+ */
+void FileSelectionPanel::request_puzzle_info()
 {
-  int index = m_num_puzzles_loaded;
-
-  auto summary = std::make_shared<PuzzleSummary>();
-  auto progress = std::make_shared<PuzzleProgress>();
-
-  std::string file_path = m_files[index].full_path;
-  std::ifstream sfile(file_path);
-  if (sfile.is_open()) {
-    std::string extension = stdfs::path(file_path).extension().string();
-    if (extension == ".non")
-      skim_puzzle(sfile, *summary, PuzzleFormat::non);
-    else if (extension == ".g")
-      skim_puzzle(sfile, *summary, PuzzleFormat::g);
-    else if (extension == ".mk")
-      skim_puzzle(sfile, *summary, PuzzleFormat::mk);
-    else if (extension == ".nin")
-      skim_puzzle(sfile, *summary, PuzzleFormat::nin);
-    else
-      skim_puzzle(sfile, *summary);
-  }
-  sfile.close();
-  m_files[index].puzzle_info = summary;
-
-  std::string collection = summary->collection;
-  std::string id = summary->id;
-  if (collection.empty())
-    collection = "Default";
-  if (id.empty()) {
-    if (summary->title.empty()) {
-      id = stdfs::path(m_files[index].full_path).stem().string();
-    } else
-      id = summary->title;
+  NONNY_TRACE_SCOPE("FileSelectionPanel::request_puzzle_info");
+  //every entry in a pack shares the pack's stamp
+  bool in_pack = is_pack_file(m_path);
+  FileStamp pack_stamp;
+  if (in_pack)
+    pack_stamp = file_stamp(m_path);
+
+  for (std::size_t i = 0; i < m_files.size(); ++i) {
+    FileInfo& file = m_files[i];
+    if (file.type != FileInfo::Type::puzzle_file)
+      continue;
+
+    FileStamp stamp = in_pack ? pack_stamp : file_stamp(file.full_path);
+    LibraryEntry entry;
+    if (m_cache.find(file.full_path, stamp, m_save_mgr, entry)) {
+      file.puzzle_info = std::make_shared<LibraryEntry>(std::move(entry));
+      file.is_loaded = true;
+    } else {
+      m_loader.request(i, file.full_path, file.puzzle_info);
+    }
   }
+}
+
+/*
+ * Have the loader work on the entries currently on screen first.
+ */
+void FileSelectionPanel::prioritize_visible(const Rect& visible_region)
+{
+  int min_y = visible_region.y() - m_boundary.y();
+  if (min_y < 0) min_y = 0;
+  int max_y = min_y + visible_region.height();
 
-  m_save_mgr.load_progress(*progress,
-                           m_files[index].full_path,
-                           collection, id);
-  m_files[index].puzzle_progress = progress;
+  std::size_t first = min_y / entry_height();
+  std::size_t last = max_y / entry_height() + 1;
+  m_loader.prioritize(first, std::min(last, m_files.size()));
+}
+
+bool FileSelectionPanel::is_loading() const
+{
+  return m_loader.is_busy() || m_loader.has_results();
+}
+
+void FileSelectionPanel::receive_puzzle_info()
+{
+  NONNY_TRACE_SCOPE("FileSelectionPanel::receive_puzzle_info");
+  auto results = m_loader.take_results();
+  for (auto& result : results) {
+    if (result.index < m_files.size()) {
+      FileInfo& file = m_files[result.index];
+      m_cache.store(file.full_path, *result.entry);
+      file.puzzle_info = std::move(result.entry);
+      file.is_loaded = true;
+    }
+  }
 
-  ++m_num_puzzles_loaded;
+  //save the cache once everything has been loaded
+  if (!results.empty() && !m_loader.is_busy())
+    m_cache.write();
 }
@@ -25,8 +25,8 @@
 #include <memory>
 #include <string>
 #include <vector>
-#include "puzzle/puzzle_progress.hpp"
-#include "puzzle/puzzle_summary.hpp"
+#include "puzzle/puzzle_info_loader.hpp"
+#include "save/library_cache.hpp"
 #include "ui/ui_panel.hpp"
 
 class Font;
@@ -43,6 +43,7 @@ public:
   FileSelectionPanel(SaveManager& save_mgr,
                      Font& filename_font, Font& info_font,
                      Texture& icons, const std::string& path = "");
+  ~FileSelectionPanel();
 
   void open_path(const std::string& path);
   void open_file(const std::string& file);
@@ -66,25 +67,35 @@ public:
               const Rect& active_region) override;
   void draw(Renderer& renderer, const Rect& region) const override;
 
+  // Is puzzle information still being loaded in the background?
+  bool is_loading() const;
+
 private:
-  void draw_progress(Renderer& renderer, const PuzzleGrid& grid,
-                     const Rect& area) const;
+  struct FileInfo;
+  void draw_thumbnail(Renderer& renderer, const FileInfo& file,
+                      const Rect& area) const;
   void select(int index);
   void make_selection_visible(const Rect& visible_region);
   int entry_height() const;
   void load_file_list();
+  void load_pack_file_list();
   void sort_files();
-  void load_puzzle_info();
+  void request_puzzle_info();
+  void prioritize_visible(const Rect& visible_region);
+  void receive_puzzle_info();
 
-  struct FileInfo;
   static bool file_info_less_than(const FileInfo& l, const FileInfo& r);
 
   struct FileInfo {
     std::string filename;
     std::string full_path;
     enum class Type { directory, file, puzzle_file } type = Type::file;
-    std::shared_ptr<PuzzleSummary> puzzle_info;
-    std::shared_ptr<PuzzleProgress> puzzle_progress;
+    std::shared_ptr<const LibraryEntry> puzzle_info;
+    bool is_loaded = false; //whether puzzle_info includes the progress
+
+    //thumbnail texture and the entry it was made from
+    mutable std::shared_ptr<Texture> thumbnail_texture;
+    mutable std::shared_ptr<const LibraryEntry> thumbnail_source;
   };
 
   SaveManager& m_save_mgr;
@@ -95,7 +106,8 @@ private:
   std::vector<FileInfo> m_files;
   int m_selection = 0;
   bool m_is_selected = false;
-  int m_num_puzzles_loaded = 0;
+  PuzzleInfoLoader m_loader;
+  LibraryCache m_cache;
 
   Callback m_file_open_callback;
   Callback m_file_sel_callback;
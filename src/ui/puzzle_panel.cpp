@@ -20,13 +20,16 @@
 
 #include "ui/puzzle_panel.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <queue>
 #include <string>
 #include "color/color.hpp"
 #include "input/input_handler.hpp"
 #include "puzzle/puzzle.hpp"
 #include "solver/line_solver.hpp"
+#include "utility/trace.hpp"
 #include "utility/utility.hpp"
 #include "video/font.hpp"
 #include "video/renderer.hpp"
@@ -160,14 +163,15 @@ void PuzzlePanel::update(unsigned ticks, InputHandler& input,
 
 void PuzzlePanel::draw(Renderer& renderer, const Rect& region) const
 {
+  NONNY_TRACE_SCOPE("PuzzlePanel::draw");
   if (m_puzzle) {
     renderer.set_clip_rect(region);
-    draw_cells(renderer);
-    draw_grid_lines(renderer);
-    draw_selection(renderer);
+    draw_cells(renderer, region);
+    draw_grid_lines(renderer, region);
+    draw_selection(renderer, region);
     draw_errors(renderer);
     draw_hints(renderer);
-    draw_clues(renderer);
+    draw_clues(renderer, region);
 
     renderer.set_clip_rect();
   }
@@ -216,59 +220,130 @@ void PuzzlePanel::calc_grid_pos()
 int PuzzlePanel::row_clue_width(int row) const
 {
   int width = 0;
-  for (auto clue : m_puzzle->row_clues(row)) {
-    int text_wd, text_ht;
-    m_clue_font.text_size(std::to_string(clue.value), &text_wd, &text_ht);
-    width += text_wd + clue_spacing();
-  }
+  for (const auto& clue : clue_text(row, true))
+    width += clue.width + clue_spacing();
   return width;
 }
 
 int PuzzlePanel::col_clue_height(int col) const
 {
   int height = 0;
-  for (auto clue : m_puzzle->col_clues(col)) {
-    int text_wd, text_ht;
-    m_clue_font.text_size(std::to_string(clue.value), &text_wd, &text_ht);
-    height += text_ht + clue_spacing();
-  }
+  for (const auto& clue : clue_text(col, false))
+    height += clue.height + clue_spacing();
   return height;
 }
 
-void PuzzlePanel::draw_grid_lines(Renderer& renderer) const
+const PuzzlePanel::ClueLineText&
+PuzzlePanel::clue_text(int index, bool is_row) const
 {
-  renderer.set_draw_color(cell_border_color);
+  //the clue font follows the cell size, so zooming invalidates everything
+  if (m_clue_text_cell_size != m_cell_size
+      || static_cast<int>(m_row_clue_text.size()) != m_puzzle->height()
+      || static_cast<int>(m_col_clue_text.size()) != m_puzzle->width()) {
+    m_row_clue_text.assign(m_puzzle->height(), ClueLineText());
+    m_col_clue_text.assign(m_puzzle->width(), ClueLineText());
+    m_clue_text_cell_size = m_cell_size;
+  }
+
+  const auto& clues = (is_row
+                       ? m_puzzle->row_clues(index)
+                       : m_puzzle->col_clues(index));
+  ClueLineText& text = (is_row
+                        ? m_row_clue_text[index]
+                        : m_col_clue_text[index]);
+
+  //comparing the values is much cheaper than measuring the text again
+  bool changed = text.size() != clues.size();
+  for (std::size_t i = 0; !changed && i < clues.size(); ++i)
+    changed = text[i].value != clues[i].value;
+
+  if (changed) {
+    text.clear();
+    for (const auto& clue : clues) {
+      ClueText t { clue.value, std::to_string(clue.value), 0, 0 };
+      m_clue_font.text_size(t.text, &t.width, &t.height);
+      text.push_back(t);
+    }
+  }
+  return text;
+}
+
+void PuzzlePanel::visible_cells(const Rect& region, int* x0, int* y0,
+                                int* x1, int* y1) const
+{
+  //include cells whose borders are visible, even if their interiors
+  //are not
+  auto first = [this](int offset, int size) {
+    offset -= 2;
+    return offset < 0 ? 0 : std::min(size, offset / (m_cell_size + 1));
+  };
+  auto last = [this](int offset, int size) {
+    return offset < 0 ? 0 : std::min(size, offset / (m_cell_size + 1) + 1);
+  };
+
   int width = m_puzzle->width();
   int height = m_puzzle->height();
-  for (int x = 0; x <= width; ++x) {
-    Point start(m_grid_pos.x() + x * (m_cell_size + 1), m_grid_pos.y());
-    Point end(start.x(), m_grid_pos.y() + height * (m_cell_size + 1));
+  *x0 = first(region.x() - m_grid_pos.x(), width);
+  *y0 = first(region.y() - m_grid_pos.y(), height);
+  *x1 = last(region.x() + region.width() - m_grid_pos.x(), width);
+  *y1 = last(region.y() + region.height() - m_grid_pos.y(), height);
+}
+
+void PuzzlePanel::draw_grid_lines(Renderer& renderer,
+                                  const Rect& region) const
+{
+  int x0, y0, x1, y1;
+  visible_cells(region, &x0, &y0, &x1, &y1);
+  if (x0 == x1 || y0 == y1)
+    return;
+
+  //only the visible part of each line is drawn; every fifth is thick
+  std::vector<LineSegment> thin_lines;
+  std::vector<Rect> thick_lines;
+  int left = m_grid_pos.x() + x0 * (m_cell_size + 1);
+  int right = m_grid_pos.x() + x1 * (m_cell_size + 1);
+  int top = m_grid_pos.y() + y0 * (m_cell_size + 1);
+  int bottom = m_grid_pos.y() + y1 * (m_cell_size + 1);
+  for (int x = x0; x <= x1; ++x) {
+    Point start(m_grid_pos.x() + x * (m_cell_size + 1), top);
+    Point end(start.x(), bottom);
 
     if (x % 5 == 0)
-      renderer.draw_thick_line(start, end.y() - start.y(), 3, true);
+      thick_lines.push_back(Rect(start.x() - 1, top, 3, bottom - top + 1));
     else
-      renderer.draw_line(start, end);
+      thin_lines.push_back(LineSegment { start, end });
   }
-  for (int y = 0; y <= height; ++y) {
-    Point start(m_grid_pos.x(), m_grid_pos.y() + y * (m_cell_size + 1));
-    Point end(m_grid_pos.x() + width * (m_cell_size + 1), start.y());
+  for (int y = y0; y <= y1; ++y) {
+    Point start(left, m_grid_pos.y() + y * (m_cell_size + 1));
+    Point end(right, start.y());
 
     if (y % 5 == 0)
-      renderer.draw_thick_line(start, end.x() - start.x(), 3, false);
+      thick_lines.push_back(Rect(left, start.y() - 1, right - left + 1, 3));
     else
-      renderer.draw_line(start, end);
+      thin_lines.push_back(LineSegment { start, end });
   }
+
+  renderer.set_draw_color(cell_border_color);
+  renderer.draw_lines(thin_lines);
+  renderer.fill_rects(thick_lines);
 }
 
-void PuzzlePanel::draw_clues(Renderer& renderer) const
+void PuzzlePanel::draw_clues(Renderer& renderer, const Rect& region) const
 {
   constexpr double finished_fade = 0.33;
 
+  //clues are drawn for the rows and columns in view
+  int x0, y0, x1, y1;
+  visible_cells(region, &x0, &y0, &x1, &y1);
+
   int x, y;
-  for (int i = 0; i < m_puzzle->width(); ++i) {
+  for (int i = x0; i < x1; ++i) {
+    const auto& clues = m_puzzle->col_clues(i);
+    const auto& text = clue_text(i, false);
     x = m_grid_pos.x() + i * (m_cell_size + 1);
     y = m_grid_pos.y() - col_clue_height(i);
-    for (auto clue : m_puzzle->col_clues(i)) {
+    for (std::size_t n = 0; n < clues.size(); ++n) {
+      const auto& clue = clues[n];
       Color color;
       if (clue.state == PuzzleClue::State::finished) {
         color = clue.color.fade(finished_fade);
@@ -279,20 +354,20 @@ void PuzzlePanel::draw_clues(Renderer& renderer) const
       //Color bg_color = default_colors::white;
       //if (m_color != default_colors::black && color == m_color)
       //  bg_color = Color(192, 192, 192);
-      std::string value = std::to_string(clue.value);
-      int wd, ht;
-      m_clue_font.text_size(value, &wd, &ht);
-      Point pos(x + (m_cell_size + 1) / 2 - wd / 2, y);
-      renderer.draw_text(pos, m_clue_font, value);
+      Point pos(x + (m_cell_size + 1) / 2 - text[n].width / 2, y);
+      renderer.draw_text(pos, m_clue_font, text[n].text);
       //renderer.draw_text_with_bg(pos, m_clue_font, value, bg_color);
-      y += ht + clue_spacing();
+      y += text[n].height + clue_spacing();
     }
   }
 
-  for (int j = 0; j < m_puzzle->height(); ++j) {
+  for (int j = y0; j < y1; ++j) {
+    const auto& clues = m_puzzle->row_clues(j);
+    const auto& text = clue_text(j, true);
     x = m_grid_pos.x() - row_clue_width(j);
     y = m_grid_pos.y() + j * (m_cell_size + 1);
-    for (auto clue : m_puzzle->row_clues(j)) {
+    for (std::size_t n = 0; n < clues.size(); ++n) {
+      const auto& clue = clues[n];
       Color color;
       if (clue.state == PuzzleClue::State::finished) {
         color = clue.color.fade(finished_fade);
@@ -303,34 +378,35 @@ void PuzzlePanel::draw_clues(Renderer& renderer) const
       //Color bg_color = default_colors::white;
       //if (m_color != default_colors::black && color == m_color)
       //  bg_color = Color(192, 192, 192);
-      std::string value = std::to_string(clue.value);
-      int wd, ht;
-      m_clue_font.text_size(value, &wd, &ht);
-      Point pos(x, y + (m_cell_size + 1) / 2 - ht / 2);
-      renderer.draw_text(pos, m_clue_font, value);
+      Point pos(x, y + (m_cell_size + 1) / 2 - text[n].height / 2);
+      renderer.draw_text(pos, m_clue_font, text[n].text);
       //renderer.draw_text_with_bg(pos, m_clue_font, value, bg_color);
-      x += wd + clue_spacing();
+      x += text[n].width + clue_spacing();
     }
   }
 }
 
-void PuzzlePanel::draw_cells(Renderer& renderer) const
+void PuzzlePanel::draw_cells(Renderer& renderer, const Rect& region) const
 {
-  int index = 0;
-  for (int y = 0; y < m_puzzle->height(); ++y) {
-    for (int x = 0; x < m_puzzle->width(); ++x, ++index) {
-      draw_cell(renderer, x, y, (*m_puzzle)[x][y].state,
-                m_prev_cell_state[index], (*m_puzzle)[x][y].color,
-                m_cell_time[index]);
+  int x0, y0, x1, y1;
+  visible_cells(region, &x0, &y0, &x1, &y1);
+
+  for (int y = y0; y < y1; ++y) {
+    int index = y * m_puzzle->width() + x0;
+    for (int x = x0; x < x1; ++x, ++index) {
+      add_cell(m_cell_batch, x, y, (*m_puzzle)[x][y].state,
+               m_prev_cell_state[index], (*m_puzzle)[x][y].color,
+               m_cell_time[index]);
     }
   }
+  draw_cell_batch(renderer, m_cell_batch);
 }
 
-void PuzzlePanel::draw_cell(Renderer& renderer, int x, int y,
-                            PuzzleCell::State state,
-                            PuzzleCell::State prev_state,
-                            const Color& color,
-                            unsigned animation_time) const
+void PuzzlePanel::add_cell(CellBatch& batch, int x, int y,
+                           PuzzleCell::State state,
+                           PuzzleCell::State prev_state,
+                           const Color& color,
+                           unsigned animation_time) const
 {
   int src_cell_size = m_cell_texture.height() / 3;
   Rect dest(m_grid_pos.x() + x * (m_cell_size + 1) + 1,
@@ -339,12 +415,11 @@ void PuzzlePanel::draw_cell(Renderer& renderer, int x, int y,
   Rect src(0, 0, src_cell_size, src_cell_size);
 
   if (x % 2 != y % 2)
-    renderer.set_draw_color(lightly_shaded_cell_color);
+    batch.backgrounds.add(lightly_shaded_cell_color, dest);
   else if (x % 2 == 0)
-    renderer.set_draw_color(shaded_cell_color);
+    batch.backgrounds.add(shaded_cell_color, dest);
   else
-    renderer.set_draw_color(blank_cell_color);
-  renderer.fill_rect(dest);
+    batch.backgrounds.add(blank_cell_color, dest);
 
   //change size of square based on time elapsed
   if (state != prev_state) {
@@ -367,25 +442,34 @@ void PuzzlePanel::draw_cell(Renderer& renderer, int x, int y,
     }
   }
 
-  if (state == PuzzleCell::State::filled) {
-    renderer.set_draw_color(color);
-    renderer.fill_rect(dest);
-  } else if (state == PuzzleCell::State::crossed_out) {
-    renderer.copy_texture(m_cell_texture, src, dest);
-  }
+  if (state == PuzzleCell::State::filled)
+    batch.fills.add(color, dest);
+  else if (state == PuzzleCell::State::crossed_out)
+    batch.crosses.push_back(TexturedQuad { src, dest });
 
   if (state == PuzzleCell::State::blank
       && animation_time < cell_animation_duration) {
-    if (prev_state == PuzzleCell::State::filled) {
-      renderer.set_draw_color(color);
-      renderer.fill_rect(dest);
-    } else if (prev_state == PuzzleCell::State::crossed_out) {
-      renderer.copy_texture(m_cell_texture, src, dest);
-    }
+    if (prev_state == PuzzleCell::State::filled)
+      batch.fills.add(color, dest);
+    else if (prev_state == PuzzleCell::State::crossed_out)
+      batch.crosses.push_back(TexturedQuad { src, dest });
   }
 }
 
-void PuzzlePanel::draw_selection(Renderer& renderer) const
+void PuzzlePanel::draw_cell_batch(Renderer& renderer,
+                                  CellBatch& batch) const
+{
+  renderer.fill_rects(batch.backgrounds);
+  renderer.fill_rects(batch.fills);
+  renderer.copy_texture(m_cell_texture, batch.crosses);
+
+  batch.backgrounds.clear();
+  batch.fills.clear();
+  batch.crosses.clear();
+}
+
+void PuzzlePanel::draw_selection(Renderer& renderer,
+                                 const Rect& region) const
 {
   if (m_selected) {
     Rect cell(m_grid_pos.x() + m_selection_x * (m_cell_size + 1),
@@ -409,18 +493,20 @@ void PuzzlePanel::draw_selection(Renderer& renderer) const
   if ((m_mouse_dragging || m_kb_dragging)
       && m_draw_tool != DrawTool::paint
       && m_draw_tool != DrawTool::fill) {
-    if (m_drag_marks)
-      renderer.set_draw_color(m_color);
-    else
-      renderer.set_draw_color(default_colors::white);
-    auto fn = [this, &renderer](int x, int y) {
+    int x0, y0, x1, y1;
+    visible_cells(region, &x0, &y0, &x1, &y1);
+    auto fn = [this, x0, y0, x1, y1](int x, int y) {
+      if (x < x0 || x >= x1 || y < y0 || y >= y1)
+        return;
+
       auto state = (m_drag_marks
                     ? PuzzleCell::State::filled
                     : PuzzleCell::State::blank);
-      draw_cell(renderer, x, y, state, state,
-                m_color, cell_animation_duration);
+      add_cell(m_cell_batch, x, y, state, state,
+               m_color, cell_animation_duration);
     };
     for_each_point_on_selection(fn);
+    draw_cell_batch(renderer, m_cell_batch);
   }
 }
 
@@ -431,21 +517,23 @@ void PuzzlePanel::draw_errors(Renderer& renderer) const
 void PuzzlePanel::draw_hints(Renderer& renderer) const
 {
   int src_size = m_cell_texture.height() / 3;
+  std::vector<TexturedQuad> quads;
   Rect dest, src;
   src = Rect(src_size, src_size, src_size, src_size);
   for (int j : m_hinted_rows) {
     dest = Rect(m_grid_pos.x() - m_cell_size,
                 m_grid_pos.y() + j * (m_cell_size + 1),
                 m_cell_size, m_cell_size);
-    renderer.copy_texture(m_cell_texture, src, dest);
+    quads.push_back(TexturedQuad { src, dest });
   }
   src = Rect(src_size * 2, src_size, src_size, src_size);
   for (int i : m_hinted_cols) {
     dest = Rect(m_grid_pos.x() + i * (m_cell_size + 1),
                 m_grid_pos.y() - m_cell_size,
                 m_cell_size, m_cell_size);
-    renderer.copy_texture(m_cell_texture, src, dest);
+    quads.push_back(TexturedQuad { src, dest });
   }
+  renderer.copy_texture(m_cell_texture, quads);
 }
 
 void PuzzlePanel::move(int x, int y)
@@ -461,9 +549,12 @@ void PuzzlePanel::move(int x, int y)
 
 void PuzzlePanel::update_cells(unsigned ticks)
 {
+  m_animating_cells = false;
   for (auto& time : m_cell_time) {
-    if (time < cell_animation_duration)
+    if (time < cell_animation_duration) {
       time += ticks;
+      m_animating_cells = true;
+    }
   }
 }
 
@@ -472,6 +563,7 @@ void PuzzlePanel::set_cell(int x, int y, PuzzleCell::State state)
   int index = x + y * m_puzzle->width();
   m_prev_cell_state[index] = (*m_puzzle)[x][y].state;
   m_cell_time[index] = 0;
+  m_animating_cells = true;
 
   if (m_prev_cell_state[index] != state)
     m_has_state_changed = true;
@@ -24,6 +24,7 @@
 #include <functional>
 #include <list>
 #include <set>
+#include <string>
 #include <vector>
 #include "color/color_palette.hpp"
 #include "puzzle/compressed_state.hpp"
@@ -31,6 +32,7 @@
 #include "puzzle/puzzle_cell.hpp"
 #include "ui/ui_panel.hpp"
 #include "video/point.hpp"
+#include "video/render_batch.hpp"
 
 class Font;
 class InputHandler;
@@ -87,18 +89,44 @@ public:
 
   void move(int x, int y);
 
+  // Is the panel zooming, being dragged over, or animating cells?
+  inline bool is_animating() const;
+
 private:
   void calc_grid_pos();
   int row_clue_width(int row) const;
   int col_clue_height(int col) const;
   int clue_spacing() const { return m_cell_size / 3; }
-  void draw_grid_lines(Renderer& renderer) const;
-  void draw_clues(Renderer& renderer) const;
-  void draw_cells(Renderer& renderer) const;
-  void draw_cell(Renderer& renderer, int x, int y,
-                 PuzzleCell::State state, PuzzleCell::State prev_state,
-                 const Color& color, unsigned animation_time) const;
-  void draw_selection(Renderer& renderer) const;
+
+  //clue numbers as drawn, with their sizes in the clue font
+  struct ClueText {
+    int value;
+    std::string text;
+    int width;
+    int height;
+  };
+  typedef std::vector<ClueText> ClueLineText;
+  const ClueLineText& clue_text(int index, bool is_row) const;
+
+  //find the cells [x0, x1) by [y0, y1) that overlap the region
+  void visible_cells(const Rect& region, int* x0, int* y0,
+                     int* x1, int* y1) const;
+
+  void draw_grid_lines(Renderer& renderer, const Rect& region) const;
+  void draw_clues(Renderer& renderer, const Rect& region) const;
+  void draw_cells(Renderer& renderer, const Rect& region) const;
+
+  //cells are drawn in batches of three layers, one on top of the other
+  struct CellBatch {
+    RectBatch backgrounds;
+    RectBatch fills;
+    std::vector<TexturedQuad> crosses;
+  };
+  void add_cell(CellBatch& batch, int x, int y,
+                PuzzleCell::State state, PuzzleCell::State prev_state,
+                const Color& color, unsigned animation_time) const;
+  void draw_cell_batch(Renderer& renderer, CellBatch& batch) const;
+  void draw_selection(Renderer& renderer, const Rect& region) const;
   void draw_errors(Renderer& renderer) const;
   void draw_hints(Renderer& renderer) const;
 
@@ -147,6 +175,12 @@ private:
   Color m_color;
   std::vector<unsigned> m_cell_time;
   std::vector<PuzzleCell::State> m_prev_cell_state;
+  mutable CellBatch m_cell_batch; //reused between frames
+
+  //text of the clues, rebuilt for lines whose clues have changed
+  mutable std::vector<ClueLineText> m_row_clue_text;
+  mutable std::vector<ClueLineText> m_col_clue_text;
+  mutable int m_clue_text_cell_size = 0; //zoom level of the clue text
   int m_cell_size = 32;
   int m_target_cell_size = 32;
   int m_zoom_target_x = 0;
@@ -165,6 +199,7 @@ private:
   std::list<CompressedState> m_state_history;
   std::list<CompressedState>::iterator m_cur_state;
   bool m_has_state_changed = true;
+  bool m_animating_cells = false;
 
   //Hints
   std::set<int> m_hinted_rows;
@@ -239,4 +274,10 @@ inline void PuzzlePanel::generalized_cell_at_point(const Point&p,
     *y = (p.y() - m_grid_pos.y() - 1) / (m_cell_size + 1);
 }
 
+inline bool PuzzlePanel::is_animating() const
+{
+  return m_animating_cells || m_cell_size != m_target_cell_size
+    || m_mouse_dragging || m_kb_dragging;
+}
+
 #endif
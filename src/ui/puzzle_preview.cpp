@@ -21,8 +21,12 @@
 #include "ui/puzzle_preview.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <vector>
 #include "puzzle/puzzle.hpp"
+#include "video/render_batch.hpp"
 #include "video/renderer.hpp"
+#include "video/texture.hpp"
 
 void PuzzlePreview::update(unsigned ticks, InputHandler& input,
                            const Rect& active_region)
@@ -52,22 +56,59 @@ void PuzzlePreview::draw(Renderer& renderer, const Rect& region) const
                 m_boundary.y() + m_boundary.height() / 2
                 - pixel_size * m_puzzle->height() / 2);
 
-    //draw the "pixels"
-    for (int y = 0; y < m_puzzle->height(); ++y) {
-      for (int x = 0; x < m_puzzle->width(); ++x) {
-        auto cell = (*m_puzzle)[x][y];
+    //draw the "pixels", from a texture unless the puzzle is too large
+    //for one
+    if (pixel_size > 0 && renderer.can_create_texture(p_width, p_height)) {
+      update_texture(renderer);
+      Rect dest(start.x(), start.y(),
+                pixel_size * p_width, pixel_size * p_height);
+      renderer.copy_texture(*m_texture, Rect(), dest);
+    } else if (pixel_size > 0) {
+      draw_cells(renderer, start, pixel_size);
+    }
 
-        if (cell.state == PuzzleCell::State::filled) {
-          renderer.set_draw_color(cell.color);
+    renderer.set_clip_rect();
+  }
+}
 
-          Rect r(start.x() + x * pixel_size,
-                 start.y() + y * pixel_size,
-                 pixel_size, pixel_size);
-          renderer.fill_rect(r);
-        }
+void PuzzlePreview::draw_cells(Renderer& renderer, const Point& start,
+                               int pixel_size) const
+{
+  //one batch per color
+  RectBatch pixels;
+  for (int y = 0; y < m_puzzle->height(); ++y) {
+    for (int x = 0; x < m_puzzle->width(); ++x) {
+      const auto& cell = (*m_puzzle)[x][y];
+
+      if (cell.state == PuzzleCell::State::filled) {
+        Rect r(start.x() + x * pixel_size,
+               start.y() + y * pixel_size,
+               pixel_size, pixel_size);
+        pixels.add(cell.color, r);
       }
     }
+  }
+  renderer.fill_rects(pixels);
+}
 
-    renderer.set_clip_rect();
+void PuzzlePreview::update_texture(Renderer& renderer) const
+{
+  int width = m_puzzle->width();
+  int height = m_puzzle->height();
+  if (m_texture && m_texture_revision == m_puzzle->grid_revision()
+      && m_texture->width() == width && m_texture->height() == height)
+    return;
+
+  //unfilled cells are transparent to show the background
+  std::vector<std::uint32_t> pixels(width * height, 0);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const auto& cell = (*m_puzzle)[x][y];
+      if (cell.state == PuzzleCell::State::filled)
+        pixels[y * width + x] = to_rgba(cell.color);
+    }
   }
+
+  m_texture = renderer.new_texture(width, height, pixels);
+  m_texture_revision = m_puzzle->grid_revision();
 }
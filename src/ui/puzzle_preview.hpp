@@ -21,9 +21,12 @@
 #ifndef NONNY_PUZZLE_PREVIEW_HPP
 #define NONNY_PUZZLE_PREVIEW_HPP
 
+#include <memory>
 #include "ui/ui_panel.hpp"
 
+class Point;
 class Puzzle;
+class Texture;
 
 /*
  * Displays an overview of a puzzle in progress.
@@ -33,7 +36,7 @@ public:
   PuzzlePreview() { }
   PuzzlePreview(const Puzzle& puzzle) { attach_puzzle(puzzle); }
 
-  void attach_puzzle(const Puzzle& puzzle) { m_puzzle = &puzzle; }
+  inline void attach_puzzle(const Puzzle& puzzle);
 
   using UIPanel::update; //make all update and draw overloads visible
   using UIPanel::draw;
@@ -42,7 +45,25 @@ public:
   void draw(Renderer& renderer, const Rect& region) const override;
 
 private:
+  // Draw the filled cells one rectangle at a time
+  void draw_cells(Renderer& renderer, const Point& start,
+                  int pixel_size) const;
+  void update_texture(Renderer& renderer) const;
+
   const Puzzle* m_puzzle = nullptr;
+
+  //the grid drawn one pixel per cell, redrawn when the grid changes
+  mutable std::shared_ptr<Texture> m_texture;
+  mutable unsigned m_texture_revision = 0;
 };
 
+
+/* implementation */
+
+inline void PuzzlePreview::attach_puzzle(const Puzzle& puzzle)
+{
+  m_puzzle = &puzzle;
+  m_texture.reset();
+}
+
 #endif
@@ -53,6 +53,7 @@ public:
 
   void smooth_scroll_up();
   void smooth_scroll_down();
+  bool is_smooth_scrolling() const { return m_smooth_scroll_amount != 0; }
 
 private:
   void center_panel_vert();
@@ -46,6 +46,13 @@ void TextBox::select_all()
   m_cursor = m_sel_length = m_text.size();
 }
 
+int TextBox::time_until_update() const
+{
+  if (!has_focus())
+    return -1;
+  return std::max(cursor_blink_duration - m_cursor_duration, 0);
+}
+
 void TextBox::update(unsigned ticks, InputHandler& input,
                      const Rect& active_region)
 {
@@ -43,6 +43,9 @@ public:
   void update(unsigned ticks, InputHandler& input,
               const Rect& active_region) override;
   void draw(Renderer& renderer, const Rect& region) const override;
+
+  // The cursor blinks while the box has focus
+  int time_until_update() const override;
 private:
   void calc_size();
   int pos_to_screen_coord(int pos) const;
@@ -0,0 +1,147 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "utility/atomic_file.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <experimental/filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include "config.h"
+
+#ifdef NONNY_HAVE_FSYNC
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stdfs = std::experimental::filesystem;
+
+void write_synced(const std::string& filename, const std::string& data,
+                  bool append, const std::string& caller);
+void sync_directory(const std::string& filename);
+
+void write_file_atomic(const std::string& filename, const std::string& data)
+{
+  std::string temp_filename = filename + ".tmp";
+  try {
+    write_synced(temp_filename, data, false, "write_file_atomic");
+  } catch (...) {
+    std::error_code ec;
+    stdfs::remove(temp_filename, ec);
+    throw;
+  }
+
+  std::error_code ec;
+  stdfs::rename(temp_filename, filename, ec);
+  if (ec) {
+    stdfs::remove(temp_filename, ec);
+    throw std::runtime_error("write_file_atomic: could not replace "
+                             + filename);
+  }
+
+  sync_directory(filename);
+}
+
+void append_file_synced(const std::string& filename, const std::string& data)
+{
+  write_synced(filename, data, true, "append_file_synced");
+}
+
+#ifdef NONNY_HAVE_FSYNC
+
+void write_synced(const std::string& filename, const std::string& data,
+                  bool append, const std::string& caller)
+{
+  int flags = O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC);
+  int fd = ::open(filename.c_str(), flags, 0644);
+  if (fd < 0)
+    throw std::runtime_error(caller + ": could not open "
+                             + filename + ": " + std::strerror(errno));
+
+  const char* pos = data.data();
+  std::size_t remaining = data.size();
+  while (remaining > 0) {
+    ssize_t written = ::write(fd, pos, remaining);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0) {
+      std::string error = std::strerror(errno);
+      ::close(fd);
+      throw std::runtime_error(caller + ": could not write "
+                               + filename + ": " + error);
+    }
+    pos += written;
+    remaining -= written;
+  }
+
+  //make sure the data is on disk before anything depends on it
+  if (::fsync(fd) != 0) {
+    std::string error = std::strerror(errno);
+    ::close(fd);
+    throw std::runtime_error(caller + ": could not sync "
+                             + filename + ": " + error);
+  }
+
+  if (::close(fd) != 0)
+    throw std::runtime_error(caller + ": could not close "
+                             + filename + ": " + std::strerror(errno));
+}
+
+/*
+ * Flush the directory entry so that the rename itself survives a
+ * crash. Failure here is not an error since the data is already safe.
+ */
+void sync_directory(const std::string& filename)
+{
+  std::string dir = stdfs::path(filename).parent_path().string();
+  if (dir.empty())
+    dir = ".";
+
+  int fd = ::open(dir.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    ::fsync(fd);
+    ::close(fd);
+  }
+}
+
+#else
+
+void write_synced(const std::string& filename, const std::string& data,
+                  bool append, const std::string& caller)
+{
+  auto mode = std::ios::binary | (append ? std::ios::app : std::ios::trunc);
+  std::ofstream file(filename, std::ios::out | mode);
+  if (!file.is_open())
+    throw std::runtime_error(caller + ": could not open " + filename);
+
+  file.write(data.data(), data.size());
+  file.close();
+  if (!file)
+    throw std::runtime_error(caller + ": could not write " + filename);
+}
+
+void sync_directory(const std::string&)
+{
+}
+
+#endif
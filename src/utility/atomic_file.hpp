@@ -0,0 +1,42 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_ATOMIC_FILE_HPP
+#define NONNY_ATOMIC_FILE_HPP
+
+#include <string>
+
+/*
+ * Replace the contents of a file so that a crash or failed write
+ * never leaves it truncated. The data is written to a temporary file
+ * in the same directory, flushed to the storage device, and then
+ * renamed over the original. Throws std::runtime_error on failure, in
+ * which case the original file is untouched.
+ */
+void write_file_atomic(const std::string& filename, const std::string& data);
+
+/*
+ * Append data to a file, creating it if needed, and flush it to the
+ * storage device before returning. Throws std::runtime_error on
+ * failure.
+ */
+void append_file_synced(const std::string& filename, const std::string& data);
+
+#endif
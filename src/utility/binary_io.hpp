@@ -0,0 +1,188 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_BINARY_IO_HPP
+#define NONNY_BINARY_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+/*
+ * Functions for building little-endian binary data in a byte buffer.
+ * Variable-length integers use the common base-128 encoding, with
+ * seven bits per byte and the high bit set on all but the last byte.
+ */
+inline void put_u8(std::string& buf, unsigned value);
+inline void put_u16(std::string& buf, unsigned value);
+inline void put_u32(std::string& buf, std::uint32_t value);
+inline void put_u64(std::string& buf, std::uint64_t value);
+inline void put_varint(std::string& buf, std::uint64_t value);
+
+// Writes a varint length followed by the contents of the string
+inline void put_string(std::string& buf, const std::string& s);
+
+// 64-bit FNV-1a hash of a block of bytes
+inline std::uint64_t fnv1a_hash(const char* data, std::size_t size);
+
+/*
+ * Reads little-endian binary data from a block of memory. Reading past
+ * the end of the block throws std::out_of_range, so data from an
+ * untrusted source can be read without checking sizes first.
+ */
+class ByteReader {
+public:
+  ByteReader(const char* begin, const char* end)
+    : m_pos(begin), m_end(end) { }
+
+  inline std::uint8_t u8();
+  inline std::uint16_t u16();
+  inline std::uint32_t u32();
+  inline std::uint64_t u64();
+  inline std::uint64_t varint();
+  inline std::string string();
+
+  // Returns a pointer to the next n bytes and skips over them
+  inline const char* bytes(std::size_t n);
+  void skip(std::size_t n) { bytes(n); }
+
+  const char* position() const { return m_pos; }
+  std::size_t remaining() const { return m_end - m_pos; }
+private:
+  inline std::uint64_t little_endian(std::size_t n);
+
+  const char* m_pos;
+  const char* m_end;
+};
+
+
+/* implementation */
+
+inline void put_u8(std::string& buf, unsigned value)
+{
+  buf.push_back(static_cast<char>(value & 0xff));
+}
+
+inline void put_u16(std::string& buf, unsigned value)
+{
+  put_u8(buf, value);
+  put_u8(buf, value >> 8);
+}
+
+inline void put_u32(std::string& buf, std::uint32_t value)
+{
+  put_u16(buf, value & 0xffff);
+  put_u16(buf, value >> 16);
+}
+
+inline void put_u64(std::string& buf, std::uint64_t value)
+{
+  put_u32(buf, static_cast<std::uint32_t>(value));
+  put_u32(buf, static_cast<std::uint32_t>(value >> 32));
+}
+
+inline void put_varint(std::string& buf, std::uint64_t value)
+{
+  while (value >= 0x80) {
+    put_u8(buf, static_cast<unsigned>(value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  put_u8(buf, static_cast<unsigned>(value));
+}
+
+inline void put_string(std::string& buf, const std::string& s)
+{
+  put_varint(buf, s.size());
+  buf += s;
+}
+
+inline std::uint64_t fnv1a_hash(const char* data, std::size_t size)
+{
+  std::uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+inline const char* ByteReader::bytes(std::size_t n)
+{
+  if (n > remaining())
+    throw std::out_of_range("ByteReader::bytes: unexpected end of data");
+
+  const char* result = m_pos;
+  m_pos += n;
+  return result;
+}
+
+inline std::uint64_t ByteReader::little_endian(std::size_t n)
+{
+  auto data = reinterpret_cast<const unsigned char*>(bytes(n));
+  std::uint64_t value = 0;
+  for (std::size_t i = n; i > 0; --i)
+    value = (value << 8) | data[i - 1];
+  return value;
+}
+
+inline std::uint8_t ByteReader::u8()
+{
+  return static_cast<std::uint8_t>(little_endian(1));
+}
+
+inline std::uint16_t ByteReader::u16()
+{
+  return static_cast<std::uint16_t>(little_endian(2));
+}
+
+inline std::uint32_t ByteReader::u32()
+{
+  return static_cast<std::uint32_t>(little_endian(4));
+}
+
+inline std::uint64_t ByteReader::u64()
+{
+  return little_endian(8);
+}
+
+inline std::uint64_t ByteReader::varint()
+{
+  std::uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    std::uint8_t byte = u8();
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return value;
+  }
+  throw std::out_of_range("ByteReader::varint: integer is too long");
+}
+
+inline std::string ByteReader::string()
+{
+  std::uint64_t length = varint();
+  if (length > remaining())
+    throw std::out_of_range("ByteReader::string: unexpected end of data");
+
+  const char* data = bytes(static_cast<std::size_t>(length));
+  return std::string(data, data + length);
+}
+
+#endif
@@ -0,0 +1,106 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_BOUNDED_QUEUE_HPP
+#define NONNY_BOUNDED_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+/*
+ * A first-in, first-out queue with a fixed capacity, for passing work
+ * between threads. push() waits while the queue is full and pop() waits
+ * while it is empty. Once close() has been called, push() fails and
+ * pop() returns false after the remaining items have been taken.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+  explicit BoundedQueue(std::size_t capacity)
+    : m_capacity(capacity ? capacity : 1) { }
+  BoundedQueue(const BoundedQueue&) = delete;
+
+  // Add an item, returning false if the queue has been closed
+  inline bool push(T item);
+
+  // Take the next item, returning false if the queue is closed and empty
+  inline bool pop(T& item);
+
+  // Stop accepting items and wake any waiting threads
+  inline void close();
+
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_not_full;
+  std::condition_variable m_not_empty;
+  std::deque<T> m_items;
+  std::size_t m_capacity;
+  bool m_closed = false;
+};
+
+
+/* implementation */
+
+template <typename T>
+inline bool BoundedQueue<T>::push(T item)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_full.wait(lock, [this]() {
+        return m_closed || m_items.size() < m_capacity; });
+    if (m_closed)
+      return false;
+    m_items.push_back(std::move(item));
+  }
+  m_not_empty.notify_one();
+  return true;
+}
+
+template <typename T>
+inline bool BoundedQueue<T>::pop(T& item)
+{
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_not_empty.wait(lock, [this]() {
+        return m_closed || !m_items.empty(); });
+    if (m_items.empty())
+      return false;
+    item = std::move(m_items.front());
+    m_items.pop_front();
+  }
+  m_not_full.notify_one();
+  return true;
+}
+
+template <typename T>
+inline void BoundedQueue<T>::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+  }
+  m_not_full.notify_all();
+  m_not_empty.notify_all();
+}
+
+#endif
@@ -0,0 +1,128 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "utility/mapped_file.hpp"
+
+#include <fstream>
+#include <utility>
+#include "config.h"
+
+#ifdef NONNY_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename)
+{
+  open(filename);
+}
+
+MappedFile::~MappedFile()
+{
+  close();
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+{
+  *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) &
+{
+  if (this != &other) {
+    close();
+    m_buffer = std::move(other.m_buffer);
+    m_size = other.m_size;
+    m_open = other.m_open;
+    m_mapped = other.m_mapped;
+    m_data = m_mapped ? other.m_data : m_buffer.data();
+
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_open = false;
+    other.m_mapped = false;
+  }
+  return *this;
+}
+
+void MappedFile::open(const std::string& filename)
+{
+  close();
+
+#ifdef NONNY_HAVE_MMAP
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+    m_size = static_cast<std::size_t>(st.st_size);
+    if (m_size == 0) { //can't map an empty file
+      m_open = true;
+    } else {
+      void* addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        m_data = static_cast<const char*>(addr);
+        m_mapped = true;
+        m_open = true;
+      }
+    }
+  }
+  ::close(fd);
+
+  if (m_open)
+    return;
+  m_size = 0;
+#endif
+
+  //fall back to reading the whole file
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open())
+    return;
+
+  file.seekg(0, std::ios::end);
+  auto length = file.tellg();
+  file.seekg(0, std::ios::beg);
+  if (length > 0) {
+    m_buffer.resize(static_cast<std::size_t>(length));
+    file.read(m_buffer.data(), length);
+    m_buffer.resize(static_cast<std::size_t>(file.gcount()));
+  }
+
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+  m_open = true;
+}
+
+void MappedFile::close()
+{
+#ifdef NONNY_HAVE_MMAP
+  if (m_mapped)
+    munmap(const_cast<char*>(m_data), m_size);
+#endif
+
+  m_buffer.clear();
+  m_data = nullptr;
+  m_size = 0;
+  m_open = false;
+  m_mapped = false;
+}
@@ -0,0 +1,128 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "utility/png_image.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include "config.h"
+
+void read_png_size(const char* data, std::size_t size,
+                   int& width, int& height)
+{
+  //the signature is followed by the IHDR chunk, whose data starts with
+  //the width and height as big-endian 32-bit numbers
+  static const char signature[] = "\x89PNG\r\n\x1a\n";
+  if (size < png_size_header_length
+      || std::memcmp(data, signature, 8) != 0
+      || std::memcmp(data + 12, "IHDR", 4) != 0)
+    throw std::runtime_error("::read_png_size: not a PNG image");
+
+  auto read_u32 = [data](std::size_t pos) {
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data)
+      + pos;
+    return static_cast<std::uint32_t>(p[0]) << 24
+      | static_cast<std::uint32_t>(p[1]) << 16
+      | static_cast<std::uint32_t>(p[2]) << 8
+      | static_cast<std::uint32_t>(p[3]);
+  };
+  std::uint32_t w = read_u32(16), h = read_u32(20);
+  if (w == 0 || h == 0 || w > 0x7fffffff || h > 0x7fffffff)
+    throw std::runtime_error("::read_png_size: invalid image size");
+  width = static_cast<int>(w);
+  height = static_cast<int>(h);
+}
+
+#ifdef NONNY_HAVE_PNG
+#include <png.h>
+
+//largest image that will be decoded, in pixels
+constexpr std::size_t max_png_pixels = std::size_t(1) << 27;
+
+bool has_png_support()
+{
+  return true;
+}
+
+RgbaImage decode_png(const char* data, std::size_t size)
+{
+  png_image png;
+  std::memset(&png, 0, sizeof(png));
+  png.version = PNG_IMAGE_VERSION;
+
+  if (!png_image_begin_read_from_memory(&png, data, size))
+    throw std::runtime_error(std::string("::decode_png: ") + png.message);
+
+  if (static_cast<std::size_t>(png.width) * png.height > max_png_pixels) {
+    png_image_free(&png);
+    throw std::runtime_error("::decode_png: image is too large");
+  }
+
+  png.format = PNG_FORMAT_RGBA;
+  RgbaImage image(png.width, png.height);
+  if (!png_image_finish_read(&png, nullptr, image.pixels.data(), 0,
+                             nullptr))
+    throw std::runtime_error(std::string("::decode_png: ") + png.message);
+
+  return image;
+}
+
+std::string encode_png(const RgbaImage& image)
+{
+  png_image png;
+  std::memset(&png, 0, sizeof(png));
+  png.version = PNG_IMAGE_VERSION;
+  png.width = image.width;
+  png.height = image.height;
+  png.format = PNG_FORMAT_RGBA;
+
+  //first find the size of the encoded image
+  png_alloc_size_t size = 0;
+  if (!png_image_write_to_memory(&png, nullptr, &size, 0,
+                                 image.pixels.data(), 0, nullptr))
+    throw std::runtime_error(std::string("::encode_png: ") + png.message);
+
+  std::string data(size, '\0');
+  if (!png_image_write_to_memory(&png, &data[0], &size, 0,
+                                 image.pixels.data(), 0, nullptr))
+    throw std::runtime_error(std::string("::encode_png: ") + png.message);
+  data.resize(size);
+
+  return data;
+}
+
+#else
+
+bool has_png_support()
+{
+  return false;
+}
+
+RgbaImage decode_png(const char*, std::size_t)
+{
+  throw std::runtime_error("::decode_png: built without PNG support");
+}
+
+std::string encode_png(const RgbaImage&)
+{
+  throw std::runtime_error("::encode_png: built without PNG support");
+}
+
+#endif
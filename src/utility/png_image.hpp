@@ -0,0 +1,73 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_PNG_IMAGE_HPP
+#define NONNY_PNG_IMAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * An image held in memory as 8-bit RGBA pixels, stored row by row
+ * with no padding between rows.
+ */
+struct RgbaImage {
+  RgbaImage() = default;
+  RgbaImage(int w, int h)
+    : width(w), height(h), pixels(static_cast<std::size_t>(w) * h * 4) { }
+
+  int width = 0;
+  int height = 0;
+  std::vector<std::uint8_t> pixels;
+};
+
+// Is PNG support available in this build?
+bool has_png_support();
+
+/*
+ * Decode a PNG image from memory, converting it to RGBA. Throws
+ * std::runtime_error if the data cannot be decoded or if the program
+ * was built without PNG support.
+ */
+RgbaImage decode_png(const char* data, std::size_t size);
+
+/*
+ * Bytes at the start of a PNG file that hold the image size; see
+ * read_png_size.
+ */
+constexpr std::size_t png_size_header_length = 24;
+
+/*
+ * Read the size of a PNG image from its header, without decoding it.
+ * This works even without PNG support. Throws std::runtime_error if
+ * the data does not start with a PNG header.
+ */
+void read_png_size(const char* data, std::size_t size,
+                   int& width, int& height);
+
+/*
+ * Encode an image in PNG format. Throws std::runtime_error on failure
+ * or if the program was built without PNG support.
+ */
+std::string encode_png(const RgbaImage& image);
+
+#endif
@@ -0,0 +1,118 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "utility/trace.hpp"
+
+#ifdef NONNY_TRACE
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace {
+  //buffers live until the program ends, so that a dump still sees the
+  //events of threads that have finished
+  std::mutex registry_mutex;
+  std::vector<std::unique_ptr<trace::ThreadBuffer>> buffers;
+  std::string output_file;
+  const std::int64_t start_time = trace::now();
+
+  void write_name(std::ostream& os, const char* name)
+  {
+    os << '"';
+    for (const char* c = name; *c; ++c) {
+      if (*c == '"' || *c == '\\')
+        os << '\\';
+      os << *c;
+    }
+    os << '"';
+  }
+
+  //Chrome expects times in microseconds
+  void write_time(std::ostream& os, std::int64_t ns)
+  {
+    os << ns / 1000 << '.' << static_cast<char>('0' + ns / 100 % 10)
+       << static_cast<char>('0' + ns / 10 % 10)
+       << static_cast<char>('0' + ns % 10);
+  }
+}
+
+trace::ThreadBuffer& trace::new_thread_buffer()
+{
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  int id = buffers.size() + 1;
+  buffers.push_back(std::make_unique<ThreadBuffer>(id));
+  return *buffers.back();
+}
+
+bool trace::ThreadBuffer::next_chunk()
+{
+  std::size_t chunk = m_count.load(std::memory_order_relaxed) / chunk_size;
+  if (chunk >= max_chunks)
+    return false;
+
+  m_chunks[chunk].reset(new Event[chunk_size]);
+  m_next = m_chunks[chunk].get();
+  m_chunk_end = m_next + chunk_size;
+  return true;
+}
+
+void trace::set_output_file(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  output_file = filename;
+}
+
+bool trace::dump()
+{
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  if (output_file.empty())
+    return false;
+
+  std::ofstream file(output_file);
+  if (!file.is_open())
+    return false;
+
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  long dropped = 0;
+  for (const auto& buffer : buffers) {
+    std::size_t count = buffer->size();
+    for (std::size_t i = 0; i < count; ++i) {
+      const Event& event = (*buffer)[i];
+      file << (first ? "\n" : ",\n") << "{\"name\":";
+      write_name(file, event.name);
+      file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id()
+           << ",\"ts\":";
+      write_time(file, std::max<std::int64_t>(event.start - start_time, 0));
+      file << ",\"dur\":";
+      write_time(file, event.end - event.start);
+      file << '}';
+      first = false;
+    }
+    dropped += buffer->num_dropped();
+  }
+  file << "\n],\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+
+  return static_cast<bool>(file);
+}
+
+#endif
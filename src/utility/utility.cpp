@@ -257,3 +257,98 @@ std::istream& read_time(std::istream& is, unsigned& time)
   time = result;
   return is;
 }
+
+namespace {
+  const char base64_digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  int base64_value(char c)
+  {
+    if (c >= 'A' && c <= 'Z')
+      return c - 'A';
+    else if (c >= 'a' && c <= 'z')
+      return c - 'a' + 26;
+    else if (c >= '0' && c <= '9')
+      return c - '0' + 52;
+    else if (c == '+')
+      return 62;
+    else if (c == '/')
+      return 63;
+    else
+      return -1;
+  }
+}
+
+std::string base64_encode(const std::string& data)
+{
+  std::string result;
+  result.reserve((data.size() + 2) / 3 * 4);
+
+  std::size_t pos = 0;
+  for (; pos + 3 <= data.size(); pos += 3) {
+    unsigned group = static_cast<unsigned char>(data[pos]) << 16
+      | static_cast<unsigned char>(data[pos + 1]) << 8
+      | static_cast<unsigned char>(data[pos + 2]);
+    result.push_back(base64_digits[(group >> 18) & 0x3f]);
+    result.push_back(base64_digits[(group >> 12) & 0x3f]);
+    result.push_back(base64_digits[(group >> 6) & 0x3f]);
+    result.push_back(base64_digits[group & 0x3f]);
+  }
+
+  //pad the last group
+  std::size_t left = data.size() - pos;
+  if (left > 0) {
+    unsigned group = static_cast<unsigned char>(data[pos]) << 16;
+    if (left == 2)
+      group |= static_cast<unsigned char>(data[pos + 1]) << 8;
+    result.push_back(base64_digits[(group >> 18) & 0x3f]);
+    result.push_back(base64_digits[(group >> 12) & 0x3f]);
+    result.push_back(left == 2 ? base64_digits[(group >> 6) & 0x3f] : '=');
+    result.push_back('=');
+  }
+
+  return result;
+}
+
+std::string base64_decode(const std::string& text)
+{
+  std::string result;
+  result.reserve(text.size() / 4 * 3);
+
+  unsigned group = 0;
+  int num_digits = 0, padding = 0;
+  for (char c : text) {
+    if (is_space(c))
+      continue;
+    if (c == '=') {
+      ++padding;
+      continue;
+    }
+
+    int value = base64_value(c);
+    if (value < 0 || padding > 0)
+      throw std::invalid_argument("::base64_decode: invalid base64 data");
+
+    group = (group << 6) | value;
+    if (++num_digits == 4) {
+      result.push_back(static_cast<char>((group >> 16) & 0xff));
+      result.push_back(static_cast<char>((group >> 8) & 0xff));
+      result.push_back(static_cast<char>(group & 0xff));
+      group = 0;
+      num_digits = 0;
+    }
+  }
+
+  if (num_digits == 1 || padding > 2
+      || (padding > 0 && num_digits + padding != 4))
+    throw std::invalid_argument("::base64_decode: invalid base64 data");
+
+  if (num_digits >= 2) {
+    group <<= 6 * (4 - num_digits);
+    result.push_back(static_cast<char>((group >> 16) & 0xff));
+    if (num_digits == 3)
+      result.push_back(static_cast<char>((group >> 8) & 0xff));
+  }
+
+  return result;
+}
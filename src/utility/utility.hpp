@@ -112,6 +112,13 @@ std::ostream& write_time(std::ostream& os, unsigned time,
                          bool show_fractional = false);
 std::istream& read_time(std::istream& is, unsigned& time);
 
+/*
+ * Encodes/decodes binary data as base64 text. Decoding ignores whitespace
+ * and throws std::invalid_argument if the text is not valid base64.
+ */
+std::string base64_encode(const std::string& data);
+std::string base64_decode(const std::string& text);
+
 
 /* implementation */
 
@@ -0,0 +1,56 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "video/asset_cache.hpp"
+
+#include "video/font.hpp"
+#include "video/texture.hpp"
+#include "video/video_system.hpp"
+
+AssetCache::AssetCache(VideoSystem& vs, Renderer& renderer,
+                       const std::string& font_dir,
+                       const std::string& image_dir)
+  : m_video(vs),
+    m_renderer(renderer),
+    m_font_dir(font_dir),
+    m_image_dir(image_dir)
+{
+}
+
+std::shared_ptr<Font> AssetCache::font(const std::string& filename,
+                                       int pt_size)
+{
+  auto& font = m_fonts[std::make_pair(filename, pt_size)];
+  if (!font) {
+    font = m_video.new_font(m_font_dir + filename, pt_size);
+    ++m_num_loads;
+  }
+  return font;
+}
+
+std::shared_ptr<Texture> AssetCache::image(const std::string& filename)
+{
+  auto& image = m_images[filename];
+  if (!image) {
+    image = m_video.load_image(m_renderer, m_image_dir + filename);
+    ++m_num_loads;
+  }
+  return image;
+}
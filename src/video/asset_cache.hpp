@@ -0,0 +1,70 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_ASSET_CACHE_HPP
+#define NONNY_ASSET_CACHE_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+class Font;
+class Renderer;
+class Texture;
+class VideoSystem;
+
+/*
+ * Shares fonts and images among the views. Each asset is loaded from
+ * disk the first time it is asked for and kept from then on, so views
+ * that are created again and again, such as the menu, do no disk I/O
+ * after their first appearance. Assets can also be loaded ahead of
+ * time by asking for them once at startup. Views share ownership of
+ * the assets they use with the cache.
+ *
+ * Filenames are relative to the font and image directories. Fonts
+ * are shared, so they must not be resized; a view that needs to resize
+ * a font should create its own.
+ */
+class AssetCache {
+public:
+  AssetCache(VideoSystem& vs, Renderer& renderer,
+             const std::string& font_dir, const std::string& image_dir);
+
+  AssetCache(const AssetCache&) = delete;
+  AssetCache& operator=(const AssetCache&) = delete;
+
+  std::shared_ptr<Font> font(const std::string& filename, int pt_size);
+  std::shared_ptr<Texture> image(const std::string& filename);
+
+  // Number of assets loaded from disk so far
+  int num_loads() const { return m_num_loads; }
+
+private:
+  VideoSystem& m_video;
+  Renderer& m_renderer;
+  std::string m_font_dir;
+  std::string m_image_dir;
+  std::map<std::pair<std::string, int>, std::shared_ptr<Font>> m_fonts;
+  std::map<std::string, std::shared_ptr<Texture>> m_images;
+  int m_num_loads = 0;
+};
+
+#endif
@@ -0,0 +1,50 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "video/render_batch.hpp"
+
+void RectBatch::add(const Color& color, const Rect& rect)
+{
+  //neighboring rectangles usually share a color, so check the last one
+  if (m_last >= m_groups.size() || m_groups[m_last].color != color) {
+    m_last = 0;
+    while (m_last < m_groups.size() && m_groups[m_last].color != color)
+      ++m_last;
+    if (m_last == m_groups.size())
+      m_groups.push_back(Group { color, std::vector<Rect>() });
+  }
+
+  m_groups[m_last].rects.push_back(rect);
+}
+
+void RectBatch::clear()
+{
+  for (auto& group : m_groups)
+    group.rects.clear();
+}
+
+bool RectBatch::empty() const
+{
+  for (const auto& group : m_groups) {
+    if (!group.rects.empty())
+      return false;
+  }
+  return true;
+}
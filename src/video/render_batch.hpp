@@ -0,0 +1,73 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_RENDER_BATCH_HPP
+#define NONNY_RENDER_BATCH_HPP
+
+#include <cstddef>
+#include <vector>
+#include "color/color.hpp"
+#include "video/point.hpp"
+#include "video/rect.hpp"
+
+/*
+ * Types for submitting many primitives to a Renderer at once. Drawing
+ * a large puzzle one cell at a time costs a draw call per cell, while
+ * a batch costs about one per color.
+ */
+
+// A straight line from start to end, both endpoints inclusive
+struct LineSegment {
+  Point start;
+  Point end;
+};
+
+// A region of a texture and where on the screen it should be drawn
+struct TexturedQuad {
+  Rect src;
+  Rect dest;
+};
+
+/*
+ * A list of filled rectangles grouped by color. The order in which
+ * the groups are drawn is unspecified, so rectangles that must appear
+ * on top of one another belong in separate batches. Clearing a batch
+ * keeps its storage for the next frame.
+ */
+class RectBatch {
+public:
+  struct Group {
+    Color color;
+    std::vector<Rect> rects;
+  };
+  typedef std::vector<Group>::const_iterator const_iterator;
+
+  void add(const Color& color, const Rect& rect);
+  void clear();
+  bool empty() const;
+
+  const_iterator begin() const { return m_groups.begin(); }
+  const_iterator end() const { return m_groups.end(); }
+private:
+  std::vector<Group> m_groups;
+  std::size_t m_last = 0; //group of the most recently added rectangle
+};
+
+#endif
@@ -24,6 +24,36 @@
 #include <cstddef>
 #include "video/font.hpp"
 #include "video/rect.hpp"
+#include "video/texture.hpp"
+
+void Renderer::draw_lines(const std::vector<LineSegment>& lines)
+{
+  for (const auto& line : lines)
+    draw_line(line.start, line.end);
+}
+
+void Renderer::fill_rects(const std::vector<Rect>& rects)
+{
+  for (const auto& rect : rects)
+    fill_rect(rect);
+}
+
+void Renderer::fill_rects(const RectBatch& batch)
+{
+  for (const auto& group : batch) {
+    if (!group.rects.empty()) {
+      set_draw_color(group.color);
+      fill_rects(group.rects);
+    }
+  }
+}
+
+void Renderer::copy_texture(const Texture& src,
+                            const std::vector<TexturedQuad>& quads)
+{
+  for (const auto& quad : quads)
+    copy_texture(src, quad.src, quad.dest);
+}
 
 void Renderer::draw_thick_line(const Point& start,
                                  int length, int thickness, bool vertical)
@@ -21,14 +21,25 @@
 #ifndef NONNY_RENDERER_HPP
 #define NONNY_RENDERER_HPP
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 #include "color/color.hpp"
+#include "video/render_batch.hpp"
 
 class Font;
 class Point;
 class Rect;
 class Texture;
 
+// Counts of the work a Renderer has been asked to do
+struct RenderStats {
+  long draw_calls = 0; //submissions to the graphics library
+  long text_draws = 0; //strings drawn
+  long texture_uploads = 0; //textures created from pixel data
+};
+
 /*
  * Responsible for all drawing operations. Provides basic primitives
  * which interface elements can use to draw themselves.
@@ -40,6 +51,9 @@ public:
 
   virtual void present() = 0;
 
+  // Does present wait for the display's vertical refresh?
+  virtual bool is_vsync_enabled() const = 0;
+
   virtual void clear() = 0;
   virtual void draw_point(const Point& point) = 0;
 
@@ -55,6 +69,17 @@ public:
   virtual void draw_dotted_rect(const Rect& rect);
   virtual void fill_rect(const Rect& rect) = 0;
 
+  /*
+   * Batched primitives. The lines and rectangles use the current draw
+   * color, except for a RectBatch, which sets the color of each group
+   * and leaves the draw color undefined afterward. The defaults draw
+   * one shape at a time; backends should override them with whatever
+   * their graphics library offers for drawing many shapes at once.
+   */
+  virtual void draw_lines(const std::vector<LineSegment>& lines);
+  virtual void fill_rects(const std::vector<Rect>& rects);
+  void fill_rects(const RectBatch& batch);
+
   virtual Rect draw_text(const Point& point, const Font& font,
                          const std::string& text) = 0;
   virtual Rect draw_text_with_bg(const Point& point, const Font& font,
@@ -67,12 +92,56 @@ public:
   virtual void copy_texture(const Texture& src,
                             const Rect& src_rect,
                             const Rect& dest_rect) = 0;
+  virtual void copy_texture(const Texture& src,
+                            const std::vector<TexturedQuad>& quads);
+
+  /*
+   * Create a texture from pixels in row order, packed as by to_rgba.
+   * Textures are drawn without smoothing, so that small images such
+   * as puzzle thumbnails can be scaled up sharply.
+   */
+  virtual std::unique_ptr<Texture>
+  new_texture(int width, int height,
+              const std::vector<std::uint32_t>& pixels) = 0;
+
+  // Is a texture of this size within the graphics library's limits?
+  virtual bool can_create_texture(int width, int height) const = 0;
 
   virtual void set_draw_color(const Color& color) = 0;
   virtual void set_clip_rect() = 0;
   virtual void set_clip_rect(const Rect& rect) = 0;
   virtual void set_viewport() = 0;
   virtual void set_viewport(const Rect& rect) = 0;
+
+  /*
+   * Read back everything drawn since the last present, in row order
+   * and packed as by to_rgba, so that frames can be compared. This is
+   * slow with most graphics hardware.
+   */
+  virtual std::vector<std::uint32_t> read_pixels(int* width,
+                                                 int* height) = 0;
+
+  // Work done since the renderer was created or the stats were reset
+  RenderStats& stats() { return m_stats; }
+  const RenderStats& stats() const { return m_stats; }
+  void reset_stats() { m_stats = RenderStats(); }
+
+private:
+  RenderStats m_stats;
 };
 
+// Pack a color into a pixel for Renderer::new_texture
+inline std::uint32_t to_rgba(const Color& color, int alpha = 255);
+
+
+/* implementation */
+
+inline std::uint32_t to_rgba(const Color& color, int alpha)
+{
+  return static_cast<std::uint32_t>(color.red()) << 24
+    | static_cast<std::uint32_t>(color.green()) << 16
+    | static_cast<std::uint32_t>(color.blue()) << 8
+    | static_cast<std::uint32_t>(alpha);
+}
+
 #endif
@@ -21,6 +21,7 @@
 #include "video/sdl/sdl_font.hpp"
 
 #include <stdexcept>
+#include "video/sdl/sdl_text_cache.hpp"
 
 SDLFont::SDLFont(const std::string& filename, int pt_size)
   : m_filename(filename), m_pt_size(pt_size)
@@ -30,6 +31,7 @@ SDLFont::SDLFont(const std::string& filename, int pt_size)
 
 SDLFont::~SDLFont()
 {
+  m_text_cache.reset();
   if (m_font)
     TTF_CloseFont(m_font);
 }
@@ -46,8 +48,22 @@ void SDLFont::text_size(const std::string& text,
   }
 }
 
+SDLTextCache& SDLFont::text_cache(SDL_Renderer* renderer,
+                                  RenderStats& stats) const
+{
+  if (!m_text_cache || m_text_cache->renderer() != renderer)
+    m_text_cache.reset(new SDLTextCache(renderer, m_font, stats));
+  return *m_text_cache;
+}
+
 void SDLFont::resize(int pt_size)
 {
+  //keep the rendered text when the size has not changed, since the
+  //puzzle panel asks for the clue size on every zoom frame
+  if (m_font && pt_size == m_pt_size)
+    return;
+
+  m_text_cache.reset();
   if (m_font)
     TTF_CloseFont(m_font);
   m_pt_size = pt_size;
@@ -21,10 +21,15 @@
 #ifndef NONNY_SDL_FONT_HPP
 #define NONNY_SDL_FONT_HPP
 
+#include <memory>
 #include <string>
+#include "SDL.h"
 #include "SDL_ttf.h"
 #include "video/font.hpp"
 
+class SDLTextCache;
+struct RenderStats;
+
 class SDLFont : public Font {
 public:
   SDLFont(const std::string& filename, int pt_size = 12);
@@ -36,8 +41,15 @@ public:
 
   TTF_Font* get_sdl_handle() const { return m_font; }
 
+  /*
+   * Rendered text for this font, created on first use. It is rebuilt
+   * when the font is resized or drawn with another renderer.
+   */
+  SDLTextCache& text_cache(SDL_Renderer* renderer, RenderStats& stats) const;
+
 private:
   TTF_Font* m_font = nullptr;
+  mutable std::unique_ptr<SDLTextCache> m_text_cache;
   std::string m_filename;
   int m_pt_size;
 };
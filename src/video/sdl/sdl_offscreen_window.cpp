@@ -0,0 +1,37 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "video/sdl/sdl_offscreen_window.hpp"
+
+#include "utility/sdl/sdl_error.hpp"
+
+SDLOffscreenWindow::SDLOffscreenWindow(const WindowSettings& ws)
+{
+  m_surface = SDL_CreateRGBSurface(0, ws.width, ws.height, 32,
+                                   0x00ff0000, 0x0000ff00,
+                                   0x000000ff, 0xff000000);
+  if (!m_surface)
+    throw SDLError("SDL_CreateRGBSurface");
+}
+
+SDLOffscreenWindow::~SDLOffscreenWindow()
+{
+  SDL_FreeSurface(m_surface);
+}
@@ -0,0 +1,44 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_SDL_OFFSCREEN_WINDOW_HPP
+#define NONNY_SDL_OFFSCREEN_WINDOW_HPP
+
+#include "SDL.h"
+#include "video/window.hpp"
+
+/*
+ * A window that exists only in memory, as a surface that a software
+ * renderer draws into. Only the size in the window settings is used.
+ */
+class SDLOffscreenWindow : public Window {
+public:
+  SDLOffscreenWindow(const WindowSettings& ws);
+  ~SDLOffscreenWindow();
+
+  int width() const override { return m_surface->w; }
+  int height() const override { return m_surface->h; }
+
+  SDL_Surface* get_sdl_handle() { return m_surface; }
+private:
+  SDL_Surface* m_surface;
+};
+
+#endif
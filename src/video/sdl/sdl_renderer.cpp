@@ -20,10 +20,16 @@
 
 #include "video/sdl/sdl_renderer.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
 #include <vector>
 #include "utility/sdl/sdl_error.hpp"
 #include "utility/utility.hpp"
 #include "video/sdl/sdl_font.hpp"
+#include "video/sdl/sdl_offscreen_window.hpp"
+#include "video/sdl/sdl_text_cache.hpp"
 #include "video/sdl/sdl_texture.hpp"
 #include "video/sdl/sdl_window.hpp"
 #include "video/point.hpp"
@@ -37,12 +43,26 @@ SDL_Rect rect_to_sdl_rect(const Rect& r)
 SDLRenderer::SDLRenderer(Window& window)
   : m_draw_color{0, 0, 0, 255}
 {
-  SDLWindow& swin = dynamic_cast<SDLWindow&>(window);
-  m_renderer = SDL_CreateRenderer(swin.get_sdl_handle(), -1,
-                                  SDL_RENDERER_ACCELERATED
-                                  | SDL_RENDERER_PRESENTVSYNC);
-  if (!m_renderer)
-    throw SDLError("SDL_CreateRenderer");
+  //offscreen windows have no display to accelerate them
+  auto offscreen = dynamic_cast<SDLOffscreenWindow*>(&window);
+  if (offscreen) {
+    m_renderer = SDL_CreateSoftwareRenderer(offscreen->get_sdl_handle());
+    if (!m_renderer)
+      throw SDLError("SDL_CreateSoftwareRenderer");
+  } else {
+    SDLWindow& swin = dynamic_cast<SDLWindow&>(window);
+    m_renderer = SDL_CreateRenderer(swin.get_sdl_handle(), -1,
+                                    SDL_RENDERER_ACCELERATED
+                                    | SDL_RENDERER_PRESENTVSYNC);
+    if (!m_renderer)
+      throw SDLError("SDL_CreateRenderer");
+  }
+
+  SDL_RendererInfo info;
+  if (SDL_GetRendererInfo(m_renderer, &info) == 0) {
+    m_max_texture_width = info.max_texture_width;
+    m_max_texture_height = info.max_texture_height;
+  }
 }
 
 SDLRenderer::~SDLRenderer()
@@ -50,15 +70,32 @@ SDLRenderer::~SDLRenderer()
   SDL_DestroyRenderer(m_renderer);
 }
 
+bool SDLRenderer::is_vsync_enabled() const
+{
+  //the driver may not honor the request for vsync
+  SDL_RendererInfo info;
+  if (SDL_GetRendererInfo(m_renderer, &info) != 0)
+    return false;
+  return (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+}
+
+void SDLRenderer::clear()
+{
+  SDL_RenderClear(m_renderer);
+  ++stats().draw_calls;
+}
+
 void SDLRenderer::draw_point(const Point& point)
 {
   SDL_RenderDrawPoint(m_renderer, point.x(), point.y());
+  ++stats().draw_calls;
 }
 
 void SDLRenderer::draw_line(const Point& point1, const Point& point2)
 {
   SDL_RenderDrawLine(m_renderer, point1.x(), point1.y(),
                      point2.x(), point2.y());
+  ++stats().draw_calls;
 }
 
 void SDLRenderer::draw_dotted_line(const Point& start,
@@ -73,18 +110,57 @@ void SDLRenderer::draw_dotted_line(const Point& start,
   }
 
   SDL_RenderDrawPoints(m_renderer, points.data(), points.size());
+  ++stats().draw_calls;
 }
 
 void SDLRenderer::draw_rect(const Rect& rect)
 {
   SDL_Rect srect = rect_to_sdl_rect(rect);
   SDL_RenderDrawRect(m_renderer, &srect);
+  ++stats().draw_calls;
 }
 
 void SDLRenderer::fill_rect(const Rect& rect)
 {
   SDL_Rect srect = rect_to_sdl_rect(rect);
   SDL_RenderFillRect(m_renderer, &srect);
+  ++stats().draw_calls;
+}
+
+void SDLRenderer::draw_lines(const std::vector<LineSegment>& lines)
+{
+  //SDL has no call for separate segments, but axis-aligned ones are
+  //just thin rectangles
+  m_rect_buffer.clear();
+  for (const auto& line : lines) {
+    int x1 = std::min(line.start.x(), line.end.x());
+    int y1 = std::min(line.start.y(), line.end.y());
+    int x2 = std::max(line.start.x(), line.end.x());
+    int y2 = std::max(line.start.y(), line.end.y());
+    if (x1 == x2 || y1 == y2)
+      m_rect_buffer.push_back(SDL_Rect { x1, y1, x2 - x1 + 1, y2 - y1 + 1 });
+    else
+      draw_line(line.start, line.end);
+  }
+
+  if (!m_rect_buffer.empty()) {
+    SDL_RenderFillRects(m_renderer, m_rect_buffer.data(),
+                        m_rect_buffer.size());
+    ++stats().draw_calls;
+  }
+}
+
+void SDLRenderer::fill_rects(const std::vector<Rect>& rects)
+{
+  m_rect_buffer.clear();
+  for (const auto& rect : rects)
+    m_rect_buffer.push_back(rect_to_sdl_rect(rect));
+
+  if (!m_rect_buffer.empty()) {
+    SDL_RenderFillRects(m_renderer, m_rect_buffer.data(),
+                        m_rect_buffer.size());
+    ++stats().draw_calls;
+  }
 }
 
 void SDLRenderer::set_draw_color(const Color& color)
@@ -105,16 +181,10 @@ Rect SDLRenderer::draw_text(const Point& point, const Font& font,
   if (!sdl_font)
     throw std::runtime_error("SDLRenderer::draw_text: "
                              "given Font is not an SDLFont");
-  SDL_Surface* surface
-    = TTF_RenderUTF8_Blended(sdl_font->get_sdl_handle(),
-                             text.c_str(),
-                             m_draw_color);
-  SDLTexture texture(m_renderer, surface);
-  SDL_FreeSurface(surface);
 
-  Rect dest_rect(point.x(), point.y(), texture.width(), texture.height());
-  copy_texture(texture, Rect(), dest_rect);
-  return dest_rect;
+  ++stats().text_draws;
+  return sdl_font->text_cache(m_renderer, stats()).draw(*this, point, text,
+                                                        m_draw_color);
 }
 
 Rect SDLRenderer::draw_text_with_bg(const Point& point, const Font& font,
@@ -128,17 +198,10 @@ Rect SDLRenderer::draw_text_with_bg(const Point& point, const Font& font,
 
   SDL_Color bg = { static_cast<Uint8>(bg_color.red()),
                    static_cast<Uint8>(bg_color.green()),
-                   static_cast<Uint8>(bg_color.blue()) };
-  SDL_Surface* surface
-    = TTF_RenderUTF8_Shaded(sdl_font->get_sdl_handle(),
-                            text.c_str(),
-                            m_draw_color, bg);
-  SDLTexture texture(m_renderer, surface);
-  SDL_FreeSurface(surface);
-
-  Rect dest_rect(point.x(), point.y(), texture.width(), texture.height());
-  copy_texture(texture, Rect(), dest_rect);
-  return dest_rect;
+                   static_cast<Uint8>(bg_color.blue()), 255 };
+  ++stats().text_draws;
+  return sdl_font->text_cache(m_renderer, stats()).draw(*this, point, text,
+                                                        m_draw_color, &bg);
 }
 
 void SDLRenderer::copy_texture(const Texture& src,
@@ -154,6 +217,86 @@ void SDLRenderer::copy_texture(const Texture& src,
   SDL_Rect* p_sr = src_rect ? &sr : NULL;
   SDL_Rect* p_dr = dest_rect ? &dr : NULL;
   SDL_RenderCopy(m_renderer, texture->get_sdl_handle(), p_sr, p_dr);
+  ++stats().draw_calls;
+}
+
+void SDLRenderer::copy_texture(const Texture& src,
+                               const std::vector<TexturedQuad>& quads)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+  const SDLTexture* texture = dynamic_cast<const SDLTexture*>(&src);
+  if (!texture)
+    throw std::runtime_error("SDLRenderer::copy: "
+                             "given Texture is not an SDLTexture");
+  if (quads.empty() || src.width() <= 0 || src.height() <= 0)
+    return;
+
+  //geometry ignores the texture's color and alpha modulation, so give
+  //it to the vertices to match what a single copy would draw
+  SDL_Texture* handle = texture->get_sdl_handle();
+  SDL_Color tint = { 255, 255, 255, 255 };
+  SDL_GetTextureColorMod(handle, &tint.r, &tint.g, &tint.b);
+  SDL_GetTextureAlphaMod(handle, &tint.a);
+
+  m_vertex_buffer.clear();
+  m_index_buffer.clear();
+  const float tex_width = src.width();
+  const float tex_height = src.height();
+  for (const auto& quad : quads) {
+    //an empty destination means the whole target, which only the
+    //single copy handles
+    if (!quad.dest) {
+      Renderer::copy_texture(src, quads);
+      return;
+    }
+
+    Rect sr = quad.src ? quad.src : Rect(0, 0, src.width(), src.height());
+    float u1 = sr.x() / tex_width;
+    float v1 = sr.y() / tex_height;
+    float u2 = (sr.x() + sr.width()) / tex_width;
+    float v2 = (sr.y() + sr.height()) / tex_height;
+    float x1 = quad.dest.x();
+    float y1 = quad.dest.y();
+    float x2 = quad.dest.x() + quad.dest.width();
+    float y2 = quad.dest.y() + quad.dest.height();
+
+    int base = m_vertex_buffer.size();
+    m_vertex_buffer.push_back(SDL_Vertex { { x1, y1 }, tint, { u1, v1 } });
+    m_vertex_buffer.push_back(SDL_Vertex { { x2, y1 }, tint, { u2, v1 } });
+    m_vertex_buffer.push_back(SDL_Vertex { { x2, y2 }, tint, { u2, v2 } });
+    m_vertex_buffer.push_back(SDL_Vertex { { x1, y2 }, tint, { u1, v2 } });
+    for (int i : { 0, 1, 2, 0, 2, 3 })
+      m_index_buffer.push_back(base + i);
+  }
+
+  SDL_RenderGeometry(m_renderer, handle,
+                     m_vertex_buffer.data(), m_vertex_buffer.size(),
+                     m_index_buffer.data(), m_index_buffer.size());
+  ++stats().draw_calls;
+#else
+  Renderer::copy_texture(src, quads);
+#endif
+}
+
+std::unique_ptr<Texture>
+SDLRenderer::new_texture(int width, int height,
+                         const std::vector<std::uint32_t>& pixels)
+{
+  if (width <= 0 || height <= 0
+      || pixels.size() != static_cast<std::size_t>(width) * height)
+    throw std::invalid_argument("SDLRenderer::new_texture: "
+                                "pixels do not match texture size");
+
+  ++stats().texture_uploads;
+  return std::make_unique<SDLTexture>(m_renderer, width, height,
+                                      pixels.data());
+}
+
+bool SDLRenderer::can_create_texture(int width, int height) const
+{
+  return width > 0 && height > 0
+    && (m_max_texture_width <= 0 || width <= m_max_texture_width)
+    && (m_max_texture_height <= 0 || height <= m_max_texture_height);
 }
 
 void SDLRenderer::set_clip_rect()
@@ -177,3 +320,31 @@ void SDLRenderer::set_viewport(const Rect& rect)
   SDL_Rect srect = rect_to_sdl_rect(rect);
   SDL_RenderSetViewport(m_renderer, &srect);
 }
+
+std::vector<std::uint32_t> SDLRenderer::read_pixels(int* width, int* height)
+{
+  //the read is relative to the viewport, so take in the whole target
+  SDL_Rect viewport;
+  SDL_RenderGetViewport(m_renderer, &viewport);
+  SDL_RenderSetViewport(m_renderer, NULL);
+
+  int w = 0, h = 0;
+  std::vector<std::uint32_t> pixels;
+  if (SDL_GetRendererOutputSize(m_renderer, &w, &h) == 0) {
+    pixels.resize(static_cast<std::size_t>(w) * h);
+    if (!pixels.empty()
+        && SDL_RenderReadPixels(m_renderer, NULL, SDL_PIXELFORMAT_RGBA8888,
+                                pixels.data(), w * sizeof(std::uint32_t))
+        != 0)
+      pixels.clear();
+  }
+  SDL_RenderSetViewport(m_renderer, &viewport);
+
+  if (w > 0 && h > 0 && pixels.empty())
+    throw SDLError("SDL_RenderReadPixels");
+  if (width)
+    *width = w;
+  if (height)
+    *height = h;
+  return pixels;
+}
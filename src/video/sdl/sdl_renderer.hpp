@@ -21,7 +21,10 @@
 #ifndef NONNY_SDL_RENDERER_HPP
 #define NONNY_SDL_RENDERER_HPP
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 #include "SDL.h"
 #include "video/renderer.hpp"
 
@@ -36,10 +39,11 @@ public:
   ~SDLRenderer();
 
   void present() override { SDL_RenderPresent(m_renderer); }
+  bool is_vsync_enabled() const override;
 
   void set_draw_color(const Color& color) override;
 
-  void clear() override { SDL_RenderClear(m_renderer); }
+  void clear() override;
   void draw_point(const Point& point) override;
 
   void draw_line(const Point& point1, const Point& point2) override;
@@ -49,6 +53,10 @@ public:
   void draw_rect(const Rect& rect) override;
   void fill_rect(const Rect& rect) override;
 
+  using Renderer::fill_rects;
+  void draw_lines(const std::vector<LineSegment>& lines) override;
+  void fill_rects(const std::vector<Rect>& rects) override;
+
   Rect draw_text(const Point& point, const Font& font,
                  const std::string& text) override;
   Rect draw_text_with_bg(const Point& point, const Font& font,
@@ -56,17 +64,33 @@ public:
 
   void copy_texture(const Texture& src,
                     const Rect& src_rect, const Rect& dest_rect) override;
+  void copy_texture(const Texture& src,
+                    const std::vector<TexturedQuad>& quads) override;
+
+  std::unique_ptr<Texture>
+  new_texture(int width, int height,
+              const std::vector<std::uint32_t>& pixels) override;
+  bool can_create_texture(int width, int height) const override;
 
   void set_clip_rect() override;
   void set_clip_rect(const Rect& rect) override;
   void set_viewport() override;
   void set_viewport(const Rect& rect) override;
 
+  std::vector<std::uint32_t> read_pixels(int* width, int* height) override;
+
   SDL_Renderer* get_sdl_handle() { return m_renderer; }
 
 private:
   SDL_Renderer* m_renderer;
   SDL_Color m_draw_color;
+  int m_max_texture_width = 0; //zero if there is no limit
+  int m_max_texture_height = 0;
+
+  //scratch space for batches, kept to avoid reallocating every frame
+  std::vector<SDL_Rect> m_rect_buffer;
+  std::vector<SDL_Vertex> m_vertex_buffer;
+  std::vector<int> m_index_buffer;
 };
 
 #endif
@@ -0,0 +1,233 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "video/sdl/sdl_text_cache.hpp"
+
+#include <algorithm>
+#include "video/point.hpp"
+#include "video/rect.hpp"
+#include "video/renderer.hpp"
+
+namespace {
+  //the atlas holds the printable ASCII characters
+  constexpr char first_glyph = ' ';
+  constexpr char last_glyph = '~';
+
+  //longer strings are cheaper to draw as a single cached texture
+  constexpr std::size_t max_atlas_length = 16;
+
+  constexpr std::size_t cache_capacity = 256;
+
+  const SDL_Color white = { 255, 255, 255, 255 };
+
+  // Render text in white; returns nullptr for text with no pixels
+  SDL_Surface* render_white(TTF_Font* font, const std::string& text)
+  {
+    if (text.empty())
+      return nullptr;
+    return TTF_RenderUTF8_Blended(font, text.c_str(), white);
+  }
+
+  int kerning(TTF_Font* font, char prev, char cur)
+  {
+#ifdef SDL_TTF_VERSION_ATLEAST
+#if SDL_TTF_VERSION_ATLEAST(2, 0, 14)
+    if (prev && TTF_GetFontKerning(font))
+      return TTF_GetFontKerningSizeGlyphs(font, prev, cur);
+#endif
+#endif
+    (void)font;
+    (void)prev;
+    (void)cur;
+    return 0;
+  }
+}
+
+SDLTextCache::SDLTextCache(SDL_Renderer* renderer, TTF_Font* font,
+                           RenderStats& stats)
+  : m_renderer(renderer), m_font(font), m_stats(stats),
+    m_line_height(TTF_FontHeight(font))
+{
+  build_atlas();
+}
+
+Rect SDLTextCache::draw(Renderer& target, const Point& point,
+                        const std::string& text, const SDL_Color& color,
+                        const SDL_Color* bg)
+{
+  if (text.empty())
+    return Rect(point.x(), point.y(), 0, 0);
+
+  bool atlas = use_atlas(text);
+  const SDLTexture* texture = atlas ? m_atlas.get() : &cached_texture(text);
+  int width = atlas ? atlas_width(text) : texture->width();
+  int height = atlas ? m_line_height : texture->height();
+  Rect dest(point.x(), point.y(), width, height);
+
+  if (bg) {
+    SDL_Rect r = { dest.x(), dest.y(), dest.width(), dest.height() };
+    SDL_SetRenderDrawColor(m_renderer, bg->r, bg->g, bg->b, 255);
+    SDL_RenderFillRect(m_renderer, &r);
+    ++m_stats.draw_calls;
+    SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, 255);
+  }
+
+  if (!texture->get_sdl_handle())
+    return dest;
+  SDL_SetTextureColorMod(texture->get_sdl_handle(),
+                         color.r, color.g, color.b);
+  if (atlas) {
+    glyph_quads(point.x(), point.y(), text);
+    target.copy_texture(*m_atlas, m_quads);
+  } else {
+    SDL_Rect r = { dest.x(), dest.y(), dest.width(), dest.height() };
+    SDL_RenderCopy(m_renderer, texture->get_sdl_handle(), nullptr, &r);
+    ++m_stats.draw_calls;
+  }
+  return dest;
+}
+
+void SDLTextCache::build_atlas()
+{
+  //render each glyph on its own, as the first character of a string
+  //would be, then pack them onto shelves one line high
+  int num_glyphs = last_glyph - first_glyph + 1;
+  std::vector<SDL_Surface*> surfaces(num_glyphs, nullptr);
+  m_glyphs.assign(num_glyphs, Glyph());
+
+  int max_width = 0;
+  for (int i = 0; i < num_glyphs; ++i) {
+    char ch = first_glyph + i;
+    Glyph& glyph = m_glyphs[i];
+    int minx = 0, maxx = 0, miny = 0, maxy = 0;
+    if (TTF_GlyphMetrics(m_font, ch, &minx, &maxx, &miny, &maxy,
+                         &glyph.advance) != 0)
+      glyph.advance = 0;
+    glyph.offset = std::min(minx, 0);
+
+    surfaces[i] = render_white(m_font, std::string(1, ch));
+    if (surfaces[i])
+      max_width = std::max(max_width, surfaces[i]->w);
+  }
+
+  int atlas_width = std::max(256, 16 * max_width);
+  int x = 0, y = 0;
+  for (int i = 0; i < num_glyphs; ++i) {
+    if (!surfaces[i])
+      continue;
+    if (x + surfaces[i]->w > atlas_width) {
+      x = 0;
+      y += m_line_height;
+    }
+    m_glyphs[i].src = SDL_Rect { x, y, surfaces[i]->w, surfaces[i]->h };
+    x += surfaces[i]->w;
+  }
+  int atlas_height = y + m_line_height;
+
+  SDL_Surface* atlas = SDL_CreateRGBSurface(0, atlas_width, atlas_height,
+                                            32, 0x00ff0000, 0x0000ff00,
+                                            0x000000ff, 0xff000000);
+  if (atlas) {
+    SDL_FillRect(atlas, nullptr, 0);
+    for (int i = 0; i < num_glyphs; ++i) {
+      if (!surfaces[i])
+        continue;
+      //copy the alpha channel as is instead of blending it
+      SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(surfaces[i], nullptr, atlas, &m_glyphs[i].src);
+    }
+    m_atlas.reset(new SDLTexture(m_renderer, atlas));
+    ++m_stats.texture_uploads;
+    SDL_SetTextureBlendMode(m_atlas->get_sdl_handle(), SDL_BLENDMODE_BLEND);
+    SDL_FreeSurface(atlas);
+  } else {
+    m_atlas.reset(new SDLTexture());
+  }
+
+  for (auto surface : surfaces) {
+    if (surface)
+      SDL_FreeSurface(surface);
+  }
+}
+
+bool SDLTextCache::use_atlas(const std::string& text) const
+{
+  if (text.size() > max_atlas_length || !m_atlas->get_sdl_handle())
+    return false;
+  return std::all_of(text.begin(), text.end(), [](char ch) {
+      return ch >= first_glyph && ch <= last_glyph; });
+}
+
+int SDLTextCache::atlas_width(const std::string& text) const
+{
+  int width = 0;
+  char prev = 0;
+  for (char ch : text) {
+    width += kerning(m_font, prev, ch) + m_glyphs[ch - first_glyph].advance;
+    prev = ch;
+  }
+  return width;
+}
+
+void SDLTextCache::glyph_quads(int x, int y, const std::string& text)
+{
+  m_quads.clear();
+  char prev = 0;
+  for (char ch : text) {
+    const Glyph& glyph = m_glyphs[ch - first_glyph];
+    x += kerning(m_font, prev, ch);
+    if (glyph.src.w > 0) {
+      TexturedQuad quad;
+      quad.src = Rect(glyph.src.x, glyph.src.y, glyph.src.w, glyph.src.h);
+      quad.dest = Rect(x + glyph.offset, y, glyph.src.w, glyph.src.h);
+      m_quads.push_back(quad);
+    }
+    x += glyph.advance;
+    prev = ch;
+  }
+}
+
+const SDLTexture& SDLTextCache::cached_texture(const std::string& text)
+{
+  auto it = m_cache_index.find(text);
+  if (it != m_cache_index.end()) {
+    m_cache.splice(m_cache.begin(), m_cache, it->second);
+    return *it->second->second;
+  }
+
+  if (m_cache.size() >= cache_capacity) {
+    m_cache_index.erase(m_cache.back().first);
+    m_cache.pop_back();
+  }
+
+  SDL_Surface* surface = render_white(m_font, text);
+  std::unique_ptr<SDLTexture> texture;
+  if (surface) {
+    texture.reset(new SDLTexture(m_renderer, surface));
+    ++m_stats.texture_uploads;
+    SDL_FreeSurface(surface);
+  } else {
+    texture.reset(new SDLTexture());
+  }
+
+  m_cache.emplace_front(text, std::move(texture));
+  m_cache_index[text] = m_cache.begin();
+  return *m_cache.front().second;
+}
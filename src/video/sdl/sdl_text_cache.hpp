@@ -0,0 +1,100 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_SDL_TEXT_CACHE_HPP
+#define NONNY_SDL_TEXT_CACHE_HPP
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "SDL.h"
+#include "SDL_ttf.h"
+#include "video/render_batch.hpp"
+#include "video/sdl/sdl_texture.hpp"
+
+class Point;
+class Rect;
+class Renderer;
+struct RenderStats;
+
+/*
+ * Keeps rendered text for one font on the GPU. Short strings of
+ * printable ASCII, such as clue numbers, are drawn glyph by glyph from
+ * an atlas texture built once for the font, with each string's glyphs
+ * submitted to the renderer as one list of textured quads. Anything
+ * else is rendered
+ * as a whole and kept in a least-recently-used cache of textures. Text
+ * is rendered in white and tinted with a color modulation when drawn,
+ * so one copy serves every color.
+ *
+ * The textures belong to the renderer, so the cache must be destroyed
+ * before the renderer is. Drawing and texture uploads are counted in
+ * the renderer's stats.
+ */
+class SDLTextCache {
+public:
+  SDLTextCache(SDL_Renderer* renderer, TTF_Font* font, RenderStats& stats);
+
+  SDLTextCache(const SDLTextCache&) = delete;
+  SDLTextCache& operator=(const SDLTextCache&) = delete;
+
+  SDL_Renderer* renderer() const { return m_renderer; }
+
+  /*
+   * Draw text in the given color, on a filled background if bg is
+   * given. Atlas glyphs are submitted through target, which must draw
+   * to the cache's renderer. Returns the area covered.
+   */
+  Rect draw(Renderer& target, const Point& point, const std::string& text,
+            const SDL_Color& color, const SDL_Color* bg = nullptr);
+
+private:
+  struct Glyph {
+    SDL_Rect src = SDL_Rect { 0, 0, 0, 0 };
+    int offset = 0; //from the pen position to the left edge of src
+    int advance = 0;
+  };
+
+  typedef std::pair<std::string, std::unique_ptr<SDLTexture>> CacheEntry;
+
+  void build_atlas();
+  bool use_atlas(const std::string& text) const;
+  int atlas_width(const std::string& text) const;
+  void glyph_quads(int x, int y, const std::string& text);
+  const SDLTexture& cached_texture(const std::string& text);
+
+  SDL_Renderer* m_renderer;
+  TTF_Font* m_font;
+  RenderStats& m_stats;
+  int m_line_height = 0;
+
+  std::unique_ptr<SDLTexture> m_atlas;
+  std::vector<Glyph> m_glyphs; //indexed by character - first_glyph
+  std::vector<TexturedQuad> m_quads; //reused from one draw to the next
+
+  std::list<CacheEntry> m_cache; //most recently used first
+  std::unordered_map<std::string, std::list<CacheEntry>::iterator>
+  m_cache_index;
+};
+
+#endif
@@ -20,6 +20,8 @@
 
 #include "video/sdl/sdl_texture.hpp"
 
+#include "utility/sdl/sdl_error.hpp"
+
 SDLTexture::SDLTexture(SDL_Renderer* renderer,
                        int width, int height)
 {
@@ -43,6 +45,25 @@ SDLTexture::SDLTexture(SDL_Renderer* renderer, SDL_Surface* surface)
   }
 }
 
+SDLTexture::SDLTexture(SDL_Renderer* renderer, int width, int height,
+                       const Uint32* pixels)
+{
+  m_texture = SDL_CreateTexture(renderer,
+                                SDL_PIXELFORMAT_RGBA8888,
+                                SDL_TEXTUREACCESS_STATIC,
+                                width, height);
+  if (!m_texture)
+    throw SDLError("SDL_CreateTexture");
+  m_width = width;
+  m_height = height;
+
+  SDL_UpdateTexture(m_texture, NULL, pixels, width * sizeof(Uint32));
+  SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+  SDL_SetTextureScaleMode(m_texture, SDL_ScaleModeNearest);
+#endif
+}
+
 SDLTexture::~SDLTexture()
 {
   if (m_texture)
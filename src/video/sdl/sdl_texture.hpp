@@ -30,6 +30,10 @@ public:
   SDLTexture(SDL_Renderer* renderer, int width, int height);
   SDLTexture(SDL_Renderer* renderer, SDL_Surface* surface);
 
+  // Static texture from 32-bit RGBA pixels, scaled without smoothing
+  SDLTexture(SDL_Renderer* renderer, int width, int height,
+             const Uint32* pixels);
+
   SDLTexture(const SDLTexture&) = delete;
   SDLTexture& operator=(const SDLTexture&) = delete;
 
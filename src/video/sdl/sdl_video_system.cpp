@@ -28,13 +28,18 @@
 #include "SDL_ttf.h"
 #include "utility/sdl/sdl_error.hpp"
 #include "video/sdl/sdl_font.hpp"
+#include "video/sdl/sdl_offscreen_window.hpp"
 #include "video/sdl/sdl_renderer.hpp"
 #include "video/sdl/sdl_texture.hpp"
 #include "video/sdl/sdl_window.hpp"
 
-SDLVideoSystem::SDLVideoSystem()
+SDLVideoSystem::SDLVideoSystem(Mode mode)
+  : m_mode(mode)
 {
-  if (SDL_Init(SDL_INIT_VIDEO) < 0)
+  //software rendering to a surface doesn't need the video subsystem,
+  //which would fail without a display
+  Uint32 subsystems = (mode == Mode::offscreen) ? 0 : SDL_INIT_VIDEO;
+  if (SDL_Init(subsystems) < 0)
     throw SDLError("SDL_Init");
 
   int img_flags = IMG_INIT_PNG | IMG_INIT_TIF;
@@ -60,6 +65,8 @@ SDLVideoSystem::~SDLVideoSystem()
 std::unique_ptr<Window>
 SDLVideoSystem::new_window(const WindowSettings& ws) const
 {
+  if (m_mode == Mode::offscreen)
+    return std::make_unique<SDLOffscreenWindow>(ws);
   return std::make_unique<SDLWindow>(ws);
 }
 
@@ -89,6 +96,7 @@ SDLVideoSystem::load_image(Renderer& renderer,
     = std::make_unique<SDLTexture>(sdl_renderer->get_sdl_handle(),
                                    surface);
   SDL_FreeSurface(surface);
+  ++renderer.stats().texture_uploads;
 
   return result;
 }
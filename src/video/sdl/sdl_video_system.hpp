@@ -32,7 +32,7 @@ class Font;
 
 class SDLVideoSystem : public VideoSystem {
 public:
-  SDLVideoSystem();
+  SDLVideoSystem(Mode mode = Mode::display);
   ~SDLVideoSystem();
 
   SDLVideoSystem(const SDLVideoSystem&) = delete;
@@ -45,6 +45,8 @@ public:
 
   std::unique_ptr<Texture>
   load_image(Renderer& renderer, const std::string& filename) const override;
+private:
+  Mode m_mode;
 };
 
 #endif
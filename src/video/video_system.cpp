@@ -27,10 +27,10 @@
 #include "video/sdl/sdl_video_system.hpp"
 #endif
 
-std::unique_ptr<VideoSystem> VideoSystem::create()
+std::unique_ptr<VideoSystem> VideoSystem::create(Mode mode)
 {
 #ifdef NONNY_VIDEO_SDL
-  return std::make_unique<SDLVideoSystem>();
+  return std::make_unique<SDLVideoSystem>(mode);
 #else
   throw std::runtime_error("VideoSystem::create: "
                            "video system not implemented");
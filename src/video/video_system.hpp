@@ -39,7 +39,13 @@ public:
   VideoSystem(const VideoSystem&) = delete;
   VideoSystem& operator=(const VideoSystem&) = delete;
 
-  static std::unique_ptr<VideoSystem> create();
+  /*
+   * Video systems either show windows on the display or draw into
+   * offscreen windows in memory, which need no display at all and
+   * are useful for testing and benchmarking.
+   */
+  enum class Mode { display, offscreen };
+  static std::unique_ptr<VideoSystem> create(Mode mode = Mode::display);
 
   virtual std::unique_ptr<Window>
   new_window(const WindowSettings& ws) const = 0;
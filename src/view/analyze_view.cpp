@@ -43,6 +43,16 @@ void AnalyzeView::update(unsigned ticks, InputHandler& input)
   m_panel->update(ticks, input);
 }
 
+unsigned AnalyzeView::time_until_update() const
+{
+  if (m_panel->is_working())
+    return 0;
+  else if (m_panel->is_cycling_solutions())
+    return m_panel->time_until_next_solution();
+  else
+    return no_timeout;
+}
+
 void AnalyzeView::draw(Renderer& renderer)
 {
   m_panel->draw(renderer);
@@ -57,7 +67,5 @@ void AnalyzeView::resize(int width, int height)
 
 void AnalyzeView::load_resources()
 {
-  std::string font_file = m_mgr.game_settings().font_dir()
-    + m_mgr.game_settings().filesystem_separator() + "FreeSans.ttf";
-  m_font = m_mgr.video_system().new_font(font_file, 24);
+  m_font = m_mgr.assets().font("FreeSans.ttf", 24);
 }
@@ -41,16 +41,19 @@ public:
   void update(unsigned ticks, InputHandler& input) override;
   void draw(Renderer& renderer) override;
   void resize(int width, int height) override;
+  unsigned time_until_update() const override;
 
   bool is_transparent() const override { return true; }
 
+  long num_lines_solved() const { return m_panel->num_lines_solved(); }
+
 private:
   void load_resources();
 
   Puzzle& m_puzzle;
 
   std::shared_ptr<AnalysisPanel> m_panel;
-  std::unique_ptr<Font> m_font;
+  std::shared_ptr<Font> m_font;
 };
 
 #endif
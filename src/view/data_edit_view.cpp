@@ -63,6 +63,15 @@ void DataEditView::update(unsigned ticks, InputHandler& input)
   m_dialog->update(ticks, input);
 }
 
+unsigned DataEditView::time_until_update() const
+{
+  //only the text box cursors change without input
+  int blink = m_dialog->time_until_update();
+  if (blink >= 0)
+    return blink;
+  return no_timeout;
+}
+
 void DataEditView::draw(Renderer& renderer)
 {
   m_dialog->draw(renderer);
@@ -76,9 +85,7 @@ void DataEditView::resize(int width, int height)
 
 void DataEditView::load_resources()
 {
-  std::string file = m_mgr.game_settings().font_dir()
-    + m_mgr.game_settings().filesystem_separator() + "FreeSans.ttf";
-  m_control_font = m_mgr.video_system().new_font(file, 24);
+  m_control_font = m_mgr.assets().font("FreeSans.ttf", 24);
 
   m_dialog = std::make_unique<OptionDialog>(*m_control_font,
                                             *m_control_font);
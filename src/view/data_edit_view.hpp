@@ -38,6 +38,7 @@ public:
   void update(unsigned ticks, InputHandler& input) override;
   void draw(Renderer& renderer) override;
   void resize(int width, int height) override;
+  unsigned time_until_update() const override;
 
   bool is_transparent() const override { return true; }
 
@@ -46,7 +47,7 @@ private:
 
   Puzzle& m_puzzle;
   std::unique_ptr<OptionDialog> m_dialog;
-  std::unique_ptr<Font> m_control_font;
+  std::shared_ptr<Font> m_control_font;
 };
 
 #endif
@@ -143,6 +143,21 @@ void FileView::update(unsigned ticks, InputHandler& input)
   }
 }
 
+unsigned FileView::time_until_update() const
+{
+  //keep updating until the puzzle information has been received
+  auto& panel
+    = dynamic_cast<const FileSelectionPanel&>(m_file_selection.main_panel());
+  if (panel.is_loading() || m_file_selection.is_smooth_scrolling())
+    return 0;
+
+  //wake up in time for the filename box's cursor to blink
+  int blink = m_filename_box->time_until_update();
+  if (blink >= 0)
+    return blink;
+  return no_timeout;
+}
+
 void FileView::draw(Renderer& renderer)
 {
   renderer.set_draw_color(background_color);
@@ -250,20 +265,12 @@ void FileView::load_resources()
 {
   using namespace std::placeholders;
 
-  const GameSettings& settings = m_mgr.game_settings();
-  VideoSystem& vs = m_mgr.video_system();
-
-  std::string font_file = settings.font_dir()
-    + settings.filesystem_separator() + "FreeSans.ttf";
-  std::string nav_texture_file = settings.image_dir()
-    + settings.filesystem_separator() + "nav.png";
-  std::string icon_texture_file = settings.image_dir()
-    + settings.filesystem_separator() + "file.png";
-  m_filename_font = vs.new_font(font_file, 18);
-  m_info_font = vs.new_font(font_file, 16);
-  m_control_font = vs.new_font(font_file, 24);
-  m_nav_texture = vs.load_image(m_mgr.renderer(), nav_texture_file);
-  m_file_icons_texture = vs.load_image(m_mgr.renderer(), icon_texture_file);
+  AssetCache& assets = m_mgr.assets();
+  m_filename_font = assets.font("FreeSans.ttf", 18);
+  m_info_font = assets.font("FreeSans.ttf", 16);
+  m_control_font = assets.font("FreeSans.ttf", 24);
+  m_nav_texture = assets.image("nav.png");
+  m_file_icons_texture = assets.image("file.png");
 
   m_menu_button = std::make_shared<ImageButton>(*m_nav_texture, 0);
   m_home_button = std::make_shared<ImageButton>(*m_nav_texture, 1);
@@ -55,6 +55,7 @@ public:
   void update(unsigned ticks, InputHandler& input) override;
   void draw(Renderer& renderer) override;
   void resize(int width, int height) override;
+  unsigned time_until_update() const override;
 
 private:
   void load_resources();
@@ -106,11 +107,11 @@ private:
 
   ScrollingPanel m_file_selection;
 
-  std::unique_ptr<Font> m_filename_font;
-  std::unique_ptr<Font> m_info_font;
-  std::unique_ptr<Font> m_control_font;
-  std::unique_ptr<Texture> m_nav_texture;
-  std::unique_ptr<Texture> m_file_icons_texture;
+  std::shared_ptr<Font> m_filename_font;
+  std::shared_ptr<Font> m_info_font;
+  std::shared_ptr<Font> m_control_font;
+  std::shared_ptr<Texture> m_nav_texture;
+  std::shared_ptr<Texture> m_file_icons_texture;
 
   std::string m_selected_path;
   bool m_need_path_change = false;
@@ -0,0 +1,200 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#include "view/frame_profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <stdexcept>
+#include "color/color.hpp"
+#include "video/font.hpp"
+#include "video/point.hpp"
+#include "video/rect.hpp"
+
+namespace {
+  constexpr std::size_t history_size = 240; //one pixel wide each
+  constexpr int graph_height = 100;
+  constexpr double ms_per_pixel = 0.5;
+  constexpr int margin = 4;
+}
+
+FrameProfiler::FrameProfiler()
+  : m_history(history_size)
+{
+  m_totals.solver_lines = 0;
+}
+
+void FrameProfiler::begin_frame(const RenderStats& stats)
+{
+  m_current = Frame();
+  m_start_stats = stats;
+  m_stage_start = Clock::now();
+}
+
+void FrameProfiler::end_stage(Stage stage)
+{
+  Clock::time_point now = Clock::now();
+  std::chrono::duration<double, std::milli> time = now - m_stage_start;
+  m_current.stage_ms[static_cast<int>(stage)] += time.count();
+  m_stage_start = now;
+}
+
+void FrameProfiler::end_frame(const RenderStats& stats, long solver_lines)
+{
+  m_current.draw_calls = stats.draw_calls - m_start_stats.draw_calls;
+  m_current.text_draws = stats.text_draws - m_start_stats.text_draws;
+
+  //the count starts over with each analysis
+  if (solver_lines < 0)
+    m_current.solver_lines = -1;
+  else if (m_prev_solver_lines < 0 || solver_lines < m_prev_solver_lines)
+    m_current.solver_lines = solver_lines;
+  else
+    m_current.solver_lines = solver_lines - m_prev_solver_lines;
+  m_prev_solver_lines = solver_lines;
+
+  for (int i = 0; i < num_stages; ++i)
+    m_totals.stage_ms[i] += m_current.stage_ms[i];
+  m_totals.draw_calls += m_current.draw_calls;
+  m_totals.text_draws += m_current.text_draws;
+  m_totals.solver_lines += std::max(m_current.solver_lines, 0L);
+  m_worst_ms = std::max(m_worst_ms, m_current.total_ms());
+
+  m_history[m_next] = m_current;
+  m_next = (m_next + 1) % m_history.size();
+  ++m_num_frames;
+
+  if (m_export) {
+    *m_export << m_num_frames;
+    for (double ms : m_current.stage_ms)
+      *m_export << ',' << ms;
+    *m_export << ',' << m_current.draw_calls
+              << ',' << m_current.text_draws
+              << ',' << m_current.solver_lines << '\n';
+  }
+}
+
+void FrameProfiler::export_to(const std::string& filename)
+{
+  m_export = std::make_unique<std::ofstream>(filename);
+  if (!m_export->is_open()) {
+    m_export.reset();
+    throw std::runtime_error("FrameProfiler::export_to: could not open "
+                             + filename);
+  }
+
+  *m_export << std::fixed << std::setprecision(3)
+            << "frame,events_ms,update_ms,draw_ms,present_ms,"
+            << "draw_calls,text_draws,solver_lines\n";
+}
+
+void FrameProfiler::draw(Renderer& renderer, const Font& font,
+                         int right, int top) const
+{
+  static const Color stage_colors[num_stages] = {
+    Color(0, 90, 200), Color(0, 160, 60), Color(230, 120, 0),
+    Color(150, 150, 150)
+  };
+
+  //averages over the frames in the graph
+  std::size_t count = std::min<std::size_t>(m_num_frames, m_history.size());
+  Frame mean;
+  long solving_frames = 0;
+  mean.solver_lines = 0;
+  for (std::size_t i = 1; i <= count; ++i) {
+    const Frame& frame
+      = m_history[(m_next + m_history.size() - i) % m_history.size()];
+    for (int stage = 0; stage < num_stages; ++stage)
+      mean.stage_ms[stage] += frame.stage_ms[stage] / count;
+    mean.draw_calls += frame.draw_calls;
+    mean.text_draws += frame.text_draws;
+    if (frame.solver_lines >= 0) {
+      mean.solver_lines += frame.solver_lines;
+      ++solving_frames;
+    }
+  }
+  if (count > 0) {
+    mean.draw_calls /= count;
+    mean.text_draws /= count;
+  }
+  if (solving_frames > 0)
+    mean.solver_lines /= solving_frames;
+
+  char buffer[128];
+  std::snprintf(buffer, sizeof(buffer),
+                "%.2f ms: events %.2f, update %.2f, draw %.2f, present %.2f",
+                mean.total_ms(), mean.time_ms(Stage::events),
+                mean.time_ms(Stage::update), mean.time_ms(Stage::draw),
+                mean.time_ms(Stage::present));
+  std::string times = buffer;
+  if (solving_frames > 0)
+    std::snprintf(buffer, sizeof(buffer),
+                  "draw calls %ld, text %ld, solver lines %ld",
+                  mean.draw_calls, mean.text_draws, mean.solver_lines);
+  else
+    std::snprintf(buffer, sizeof(buffer), "draw calls %ld, text %ld",
+                  mean.draw_calls, mean.text_draws);
+  std::string counts = buffer;
+
+  int times_width = 0, counts_width = 0, line_height = 0;
+  font.text_size(times, &times_width, &line_height);
+  font.text_size(counts, &counts_width, nullptr);
+  int width = std::max<int>({ static_cast<int>(history_size),
+        times_width, counts_width }) + 2 * margin;
+  int height = graph_height + 2 * line_height + 3 * margin;
+  Rect area(right - width, top, width, height);
+
+  renderer.set_draw_color(default_colors::white);
+  renderer.fill_rect(area);
+  renderer.set_draw_color(default_colors::black);
+  renderer.draw_rect(area);
+
+  //a stacked bar for each frame, oldest on the left
+  int graph_top = area.y() + margin;
+  int graph_bottom = graph_top + graph_height;
+  for (std::size_t i = 0; i < m_history.size(); ++i) {
+    const Frame& frame = m_history[(m_next + i) % m_history.size()];
+    int x = area.x() + margin + i;
+    int y = graph_bottom;
+    for (int stage = 0; stage < num_stages && y > graph_top; ++stage) {
+      int h = static_cast<int>(frame.stage_ms[stage] / ms_per_pixel + 0.5);
+      h = std::min(h, y - graph_top);
+      if (h > 0) {
+        y -= h;
+        m_bars.add(stage_colors[stage], Rect(x, y, 1, h));
+      }
+    }
+  }
+  renderer.fill_rects(m_bars);
+  m_bars.clear();
+
+  //mark the time available to each frame at 60 Hz
+  renderer.set_draw_color(default_colors::gray);
+  int frame_line = graph_bottom - static_cast<int>(1000.0 / 60 / ms_per_pixel);
+  renderer.draw_dotted_line(Point(area.x() + margin, frame_line),
+                            history_size - 1, false);
+
+  renderer.set_draw_color(default_colors::black);
+  int x = area.x() + margin;
+  int y = graph_bottom + margin;
+  renderer.draw_text(Point(x, y), font, times);
+  renderer.draw_text(Point(x, y + line_height), font, counts);
+}
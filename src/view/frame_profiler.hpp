@@ -0,0 +1,120 @@
+/* Nonny -- Play and create nonogram puzzles.
+ * Copyright (C) 2017 Gregory Kikola.
+ *
+ * This file is part of Nonny.
+ *
+ * Nonny is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nonny is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nonny.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Written by Gregory Kikola <gkikola@gmail.com>. */
+
+#ifndef NONNY_FRAME_PROFILER_HPP
+#define NONNY_FRAME_PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "video/render_batch.hpp"
+#include "video/renderer.hpp"
+
+class Font;
+
+/*
+ * Measures what each frame costs, split into the stages of the game
+ * loop, along with the drawing it did and any solver work. The most
+ * recent frames are kept for the profiling overlay, and every frame
+ * can also be written to a file for offline analysis.
+ */
+class FrameProfiler {
+public:
+  enum class Stage { events, update, draw, present };
+  static constexpr int num_stages = static_cast<int>(Stage::present) + 1;
+
+  struct Frame {
+    double stage_ms[num_stages] = { }; //indexed by Stage
+    long draw_calls = 0;
+    long text_draws = 0;
+    long solver_lines = -1; //-1 if no analysis is open
+
+    double time_ms(Stage stage) const
+    { return stage_ms[static_cast<int>(stage)]; }
+    inline double total_ms() const;
+  };
+
+  FrameProfiler();
+
+  FrameProfiler(const FrameProfiler&) = delete;
+  FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+  // Start timing a frame, counting the renderer's work from stats
+  void begin_frame(const RenderStats& stats);
+
+  // Charge the time since the previous stage ended to this stage
+  void end_stage(Stage stage);
+
+  /*
+   * Finish the frame. solver_lines is the number of lines solved so
+   * far by an open analysis, or -1 if there is none.
+   */
+  void end_frame(const RenderStats& stats, long solver_lines);
+
+  /*
+   * Write each frame from now on to a file as a line of comma-separated
+   * values. Throws std::runtime_error if the file cannot be opened.
+   */
+  void export_to(const std::string& filename);
+
+  long num_frames() const { return m_num_frames; }
+  const Frame& totals() const { return m_totals; }
+  double worst_frame_ms() const { return m_worst_ms; }
+
+  /*
+   * Draw a graph of recent frame times with the averages below it,
+   * in a box whose top right corner is at the given position.
+   */
+  void draw(Renderer& renderer, const Font& font, int right, int top) const;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  std::vector<Frame> m_history; //oldest frame at m_next
+  std::size_t m_next = 0;
+  long m_num_frames = 0;
+
+  Frame m_current;
+  Clock::time_point m_stage_start;
+  RenderStats m_start_stats;
+  long m_prev_solver_lines = -1;
+
+  Frame m_totals;
+  double m_worst_ms = 0.0;
+
+  std::unique_ptr<std::ofstream> m_export;
+  mutable RectBatch m_bars;
+};
+
+
+/* implementation */
+
+inline double FrameProfiler::Frame::total_ms() const
+{
+  double total = 0.0;
+  for (double ms : stage_ms)
+    total += ms;
+  return total;
+}
+
+#endif
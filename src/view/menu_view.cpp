@@ -84,6 +84,13 @@ void MenuView::update(unsigned ticks, InputHandler& input)
   m_main_panel.update(ticks, input);
 }
 
+unsigned MenuView::time_until_update() const
+{
+  if (m_sliding || m_action != MenuAction::no_action)
+    return 0;
+  return no_timeout;
+}
+
 void MenuView::draw(Renderer& renderer)
 {
   renderer.set_draw_color(menu_background_color);
@@ -104,18 +111,11 @@ void MenuView::resize(int width, int height)
 
 void MenuView::load_resources()
 {
-  std::string file = m_mgr.game_settings().image_dir()
-    + m_mgr.game_settings().filesystem_separator() + "nonny.png";
-  m_logo_texture = m_mgr.video_system().load_image(m_mgr.renderer(), file);
-
-  file = m_mgr.game_settings().font_dir()
-    + m_mgr.game_settings().filesystem_separator() + "FreeSansBold.ttf";
-  m_title_font = m_mgr.video_system().new_font(file, 56);
-
-  file = m_mgr.game_settings().font_dir()
-    + m_mgr.game_settings().filesystem_separator() + "FreeSans.ttf";
-  m_about_font = m_mgr.video_system().new_font(file, 18);
-  m_control_font = m_mgr.video_system().new_font(file, 24);
+  AssetCache& assets = m_mgr.assets();
+  m_logo_texture = assets.image("nonny.png");
+  m_title_font = assets.font("FreeSansBold.ttf", 56);
+  m_about_font = assets.font("FreeSans.ttf", 18);
+  m_control_font = assets.font("FreeSans.ttf", 24);
 }
 
 void MenuView::start_slide()
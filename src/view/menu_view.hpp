@@ -42,6 +42,7 @@ public:
   void update(unsigned ticks, InputHandler& input) override;
   void draw(Renderer& renderer) override;
   void resize(int width, int height) override;
+  unsigned time_until_update() const override;
 
 private:
   void load_resources();
@@ -58,10 +59,10 @@ private:
   ScrollingPanel m_main_panel;
   MenuAction m_action = MenuAction::no_action;
 
-  std::unique_ptr<Font> m_title_font;
-  std::unique_ptr<Font> m_control_font;
-  std::unique_ptr<Font> m_about_font;
-  std::unique_ptr<Texture> m_logo_texture;
+  std::shared_ptr<Font> m_title_font;
+  std::shared_ptr<Font> m_control_font;
+  std::shared_ptr<Font> m_about_font;
+  std::shared_ptr<Texture> m_logo_texture;
 
   bool m_sliding = false;
   int m_slide_offset = 0;
@@ -100,6 +100,11 @@ void MessageBoxView::update(unsigned ticks, InputHandler& input)
   m_mbox.update(ticks, input);
 }
 
+unsigned MessageBoxView::time_until_update() const
+{
+  return no_timeout;
+}
+
 void MessageBoxView::draw(Renderer& renderer)
 {
   m_mbox.draw(renderer);
@@ -117,8 +122,6 @@ void MessageBoxView::resize(int width, int height)
 
 void MessageBoxView::load_resources()
 {
-  std::string file = m_mgr.game_settings().font_dir()
-    + m_mgr.game_settings().filesystem_separator() + "FreeSans.ttf";
-  m_text_font = m_mgr.video_system().new_font(file, 18);
-  m_control_font = m_mgr.video_system().new_font(file, 24);
+  m_text_font = m_mgr.assets().font("FreeSans.ttf", 18);
+  m_control_font = m_mgr.assets().font("FreeSans.ttf", 24);
 }
@@ -39,6 +39,7 @@ public:
   void update(unsigned ticks, InputHandler& input) override;
   void draw(Renderer& renderer) override;
   void resize(int width, int height) override;
+  unsigned time_until_update() const override;
 
   bool is_transparent() const override { return true; }
 
@@ -46,8 +47,8 @@ private:
   void load_resources();
 
   MessageBox m_mbox;
-  std::unique_ptr<Font> m_text_font;
-  std::unique_ptr<Font> m_control_font;
+  std::shared_ptr<Font> m_text_font;
+  std::shared_ptr<Font> m_control_font;
   Callback m_esc_callback;
 };
 
@@ -28,10 +28,10 @@
 #include <utility>
 #include <experimental/filesystem>
 #include "SDL.h"
-#include "SDL_image.h"
 #include "color/color.hpp"
 #include "input/input_handler.hpp"
 #include "puzzle/puzzle_io.hpp"
+#include "puzzle/puzzle_pack.hpp"
 #include "puzzle/puzzle_progress.hpp"
 #include "settings/game_settings.hpp"
 #include "solver/solver.hpp"
@@ -80,6 +80,7 @@ PuzzleView::PuzzleView(const PuzzleView& pv)
   : View(pv.m_mgr),
     m_puzzle(pv.m_puzzle),
     m_puzzle_filename(pv.m_puzzle_filename),
+    m_progress(pv.m_progress),
     m_edit_mode(pv.m_edit_mode),
     m_best_time(pv.m_best_time)
 {
@@ -90,6 +91,7 @@ PuzzleView::PuzzleView(PuzzleView&& pv)
   : View(pv.m_mgr),
     m_puzzle(std::move(pv.m_puzzle)),
     m_puzzle_filename(std::move(pv.m_puzzle_filename)),
+    m_progress(std::move(pv.m_progress)),
     m_edit_mode(pv.m_edit_mode),
     m_best_time(pv.m_best_time)
 {
@@ -106,6 +108,7 @@ PuzzleView& PuzzleView::operator=(const PuzzleView& pv) &
 
     m_puzzle = pv.m_puzzle;
     m_puzzle_filename = pv.m_puzzle_filename;
+    m_progress = pv.m_progress;
     m_edit_mode = pv.m_edit_mode;
     m_best_time = pv.m_best_time;
     setup_panels();
@@ -123,6 +126,7 @@ PuzzleView& PuzzleView::operator=(PuzzleView&& pv) &
 
     m_puzzle = std::move(pv.m_puzzle);
     m_puzzle_filename = std::move(pv.m_puzzle_filename);
+    m_progress = std::move(pv.m_progress);
     m_edit_mode = pv.m_edit_mode;
     m_best_time = pv.m_best_time;
     setup_panels();
@@ -132,24 +136,24 @@ PuzzleView& PuzzleView::operator=(PuzzleView&& pv) &
 
 void PuzzleView::load(const std::string& filename)
 {
-  std::ifstream file(filename);
-  if (!file.is_open()) {
+  std::string pack_filename;
+  std::size_t pack_index;
+  if (split_pack_entry_path(filename, pack_filename, pack_index)) {
+    PuzzlePack(pack_filename).load(pack_index, m_puzzle);
+  } else if (!read_puzzle_file(filename, m_puzzle, file_type(filename))) {
     throw std::runtime_error("PuzzleView::load: "
                              "could not open puzzle file " + filename);
   }
 
   m_puzzle_filename = filename;
 
-  read_puzzle(file, m_puzzle, file_type(filename));
-
   //load puzzle progress
   std::string id = puzzle_id();
   std::string collection = puzzle_collection();
-  PuzzleProgress prog;
-  m_mgr.save_manager().load_progress(prog, m_puzzle_filename,
+  m_mgr.save_manager().load_progress(m_progress, m_puzzle_filename,
                                      collection, id);
-  m_best_time = prog.best_time();
-  prog.restore_progress(m_puzzle);
+  m_best_time = m_progress.best_time();
+  m_progress.restore_progress(m_puzzle);
 
   if (m_puzzle.width() == 0 || m_puzzle.height() == 0)
     throw InvalidPuzzleFile("PuzzleView::load: puzzle has a "
@@ -160,9 +164,9 @@ void PuzzleView::load(const std::string& filename)
   //restore game time
   auto& ipanel
     = dynamic_cast<PuzzleInfoPanel&>(m_info_pane.main_panel());
-  ipanel.time(prog.current_time());
+  ipanel.time(m_progress.current_time());
 
-  if (prog.is_complete())
+  if (m_progress.is_complete())
     ipanel.show_puzzle_title();
   else
     ipanel.hide_puzzle_title();
@@ -172,26 +176,7 @@ void PuzzleView::load(const std::string& filename)
 
 PuzzleFormat PuzzleView::file_type(const std::string& filename) const
 {
-  auto pos = filename.rfind('.');
-  std::string extension = "";
-  if (pos != std::string::npos) {
-    extension = filename.substr(pos);
-    std::transform(extension.begin(), extension.end(), extension.begin(),
-                   to_lower);
-  }
-
-  if (extension.empty() || extension == ".non")
-    return PuzzleFormat::non;
-  else if (extension == ".g")
-    return PuzzleFormat::g;
-  else if (extension == ".mk")
-    return PuzzleFormat::mk;
-  else if (extension == ".nin")
-    return PuzzleFormat::nin;
-  else if (extension == ".png")
-    return PuzzleFormat::png;
-  else
-    return PuzzleFormat::non;
+  return puzzle_format(filename);
 }
 
 void PuzzleView::new_puzzle()
@@ -208,7 +193,7 @@ std::string PuzzleView::puzzle_id() const
   if (!id)
     id = m_puzzle.find_property("title");
   if (!id)
-    return stdfs::path(m_puzzle_filename).stem().string();
+    return puzzle_path_stem(m_puzzle_filename);
   else
     return *id;
 }
@@ -232,10 +217,10 @@ void PuzzleView::save_progress()
   std::string id = puzzle_id();
   std::string collection = puzzle_collection();
 
-  //load previous progress
-  PuzzleProgress prog;
-  m_mgr.save_manager().load_progress(prog, m_puzzle_filename,
-                                     collection, id);
+  //load previous progress if it isn't already in memory
+  if (m_progress.filename() != m_puzzle_filename)
+    m_mgr.save_manager().load_progress(m_progress, m_puzzle_filename,
+                                       collection, id);
 
   //store current progress
   unsigned time = 0;
@@ -243,10 +228,12 @@ void PuzzleView::save_progress()
     auto& ip = dynamic_cast<const PuzzleInfoPanel&>(m_info_pane.main_panel());
     time = ip.time();
   }
-  prog.store_progress(m_puzzle, time, just_completed);
+  m_progress.store_progress(m_puzzle, time, just_completed);
 
-  m_mgr.save_manager().save_progress(prog, m_puzzle_filename,
-                                     collection, id);
+  //the save thread writes a snapshot while play continues
+  auto snapshot = std::make_shared<const PuzzleProgress>(m_progress);
+  m_mgr.save_manager().queue_progress(snapshot, m_puzzle_filename,
+                                      collection, id);
 
   //clear save flag
   auto& pp = dynamic_cast<PuzzlePanel&>(m_main_panel.main_panel());
@@ -269,6 +256,12 @@ void PuzzleView::save_puzzle(std::string filename)
   else if (filename != m_puzzle_filename)
     m_ask_before_save = false;
 
+  //puzzles can't be written back into a pack
+  std::string pack_filename;
+  std::size_t pack_index;
+  if (split_pack_entry_path(filename, pack_filename, pack_index))
+    filename.clear();
+
   if (filename.empty()) {
     m_mgr.schedule_action(ViewManager::Action::save_puzzle_as);
   } else {
@@ -286,29 +279,31 @@ void PuzzleView::save_puzzle(std::string filename)
     } else {
       PuzzleFormat type = file_type(filename);
 
-      if (type == PuzzleFormat::png) {
-        write_puzzle_png(filename, m_puzzle);
-      } else {
-        std::ofstream file(filename);
+      auto mode = std::ios::out;
+      if (type == PuzzleFormat::nbn || type == PuzzleFormat::png)
+        mode |= std::ios::binary;
+      std::ofstream file(filename, mode);
 
-        if (file.is_open())
-          m_puzzle_filename = filename;
+      //PNG files are exported images rather than editable puzzles
+      bool is_image = type == PuzzleFormat::png;
+      if (file.is_open() && !is_image)
+        m_puzzle_filename = filename;
 
-        try {
-          write_puzzle(file, m_puzzle, file_type(filename));
+      try {
+        write_puzzle(file, m_puzzle, type);
 
-          //wipe previous puzzle progress and store solution
+        //wipe previous puzzle progress and store solution
+        if (!is_image)
           save_progress();
-        } catch (const std::exception& e) {
-          std::string err_msg = "Error saving puzzle:\n\n";
-          err_msg += e.what();
-
-          //show error message
-          auto close = [this]() {
-            m_mgr.schedule_action(ViewManager::Action::close_message_box); };
-          m_mgr.message_box(err_msg, MessageBoxView::Type::okay,
-                            close, []() { }, []() { });
-        }
+      } catch (const std::exception& e) {
+        std::string err_msg = "Error saving puzzle:\n\n";
+        err_msg += e.what();
+
+        //show error message
+        auto close = [this]() {
+          m_mgr.schedule_action(ViewManager::Action::close_message_box); };
+        m_mgr.message_box(err_msg, MessageBoxView::Type::okay,
+                          close, []() { }, []() { });
       }
     }
   }
@@ -332,7 +327,14 @@ void PuzzleView::set_edit_mode()
   m_mgr.save_manager().load_progress(prog, m_puzzle_filename,
                                      collection, id);
 
-  if (!prog.is_complete()) {
+  //the puzzle file may have come with its solution
+  bool has_solution = prog.is_complete();
+  if (!has_solution && m_puzzle.solution().width() > 0) {
+    prog.set_solution(m_puzzle.solution());
+    has_solution = true;
+  }
+
+  if (!has_solution) {
     auto solve = [this]() {
       m_mgr.schedule_action(ViewManager::Action::solve_and_edit); };
     auto close = [this]() {
@@ -368,16 +370,14 @@ bool PuzzleView::is_save_needed() const
 void PuzzleView::setup_panels()
 {
   const GameSettings& settings = m_mgr.game_settings();
+  AssetCache& assets = m_mgr.assets();
 
+  //the puzzle panel resizes the clue font as it zooms, so it can't be
+  //shared with other views
   std::string font_file = settings.font_dir()
     + settings.filesystem_separator() + "FreeSans.ttf";
-  std::string bold_font_file = settings.font_dir()
-    + settings.filesystem_separator() + "FreeSansBold.ttf";
-  std::string texture_file = settings.image_dir()
-    + settings.filesystem_separator() + "puzzle.png";
   m_clue_font = m_mgr.video_system().new_font(font_file, 12);
-  m_cell_texture = m_mgr.video_system().load_image(m_mgr.renderer(),
-                                                   texture_file);
+  m_cell_texture = assets.image("puzzle.png");
 
   auto ppanel = std::make_shared<PuzzlePanel>(*m_clue_font, *m_cell_texture,
                                               m_puzzle);
@@ -387,24 +387,12 @@ void PuzzleView::setup_panels()
   Rect win_region(0, 0, m_width, m_height);
   m_main_panel = ScrollingPanel(win_region, ppanel);
 
-  m_title_font = m_mgr.video_system().new_font(bold_font_file, 32);
-  m_info_font = m_mgr.video_system().new_font(font_file, 18);
-  m_size_font = m_mgr.video_system().new_font(font_file, 24);
-
-  texture_file = settings.image_dir()
-    + settings.filesystem_separator() + "control.png";
-  m_ctrl_texture = m_mgr.video_system().load_image(m_mgr.renderer(),
-                                                   texture_file);
-
-  texture_file = settings.image_dir()
-    + settings.filesystem_separator() + "nav.png";
-  m_arrow_texture = m_mgr.video_system().load_image(m_mgr.renderer(),
-                                                    texture_file);
-
-  texture_file = settings.image_dir()
-    + settings.filesystem_separator() + "draw.png";
-  m_draw_texture = m_mgr.video_system().load_image(m_mgr.renderer(),
-                                                   texture_file);
+  m_title_font = assets.font("FreeSansBold.ttf", 32);
+  m_info_font = assets.font("FreeSans.ttf", 18);
+  m_size_font = assets.font("FreeSans.ttf", 24);
+  m_ctrl_texture = assets.image("control.png");
+  m_arrow_texture = assets.image("nav.png");
+  m_draw_texture = assets.image("draw.png");
 
   auto ipanel = std::make_shared<PuzzleInfoPanel>(*m_title_font,
                                                   *m_info_font,
@@ -534,6 +522,19 @@ void PuzzleView::update(unsigned ticks, InputHandler& input)
     m_mgr.schedule_action(ViewManager::Action::open_menu);
 }
 
+unsigned PuzzleView::time_until_update() const
+{
+  auto& ppanel = dynamic_cast<const PuzzlePanel&>(m_main_panel.main_panel());
+  if (m_info_pane.boundary().width() < info_pane_width
+      || m_main_panel.is_smooth_scrolling() || ppanel.is_animating())
+    return 0;
+
+  //the clock shows whole seconds
+  if (!m_edit_mode)
+    return 1000 - time() % 1000;
+  return no_timeout;
+}
+
 void PuzzleView::draw(Renderer& renderer)
 {
   m_main_panel.draw(renderer);
@@ -569,47 +570,3 @@ unsigned PuzzleView::time() const
     = dynamic_cast<const PuzzleInfoPanel&>(m_info_pane.main_panel());
   return ipanel.time();
 }
-
-void read_puzzle_png(const std::string& filename, Puzzle& puzzle)
-{
-}
-
-void write_puzzle_png(const std::string& filename, Puzzle& puzzle)
-{
-  Uint32* data = new Uint32[puzzle.width() * puzzle.height()];
-  auto* fmt = SDL_AllocFormat(SDL_PIXELFORMAT_RGBA32);
-
-  for (int y = 0; y < puzzle.height(); ++y) {
-    for (int x = 0; x < puzzle.width(); ++x) {
-      Uint32 value;
-      if (puzzle[x][y].state == PuzzleCell::State::filled) {
-        Color color = puzzle[x][y].color;
-        value = static_cast<Uint32>(SDL_MapRGBA(fmt,
-                                                color.red(),
-                                                color.green(),
-                                                color.blue(),
-                                                255));
-      } else {
-        value = static_cast<Uint32>(SDL_MapRGBA(fmt, 0, 0, 0, 0));
-      }
-
-      data[x + y * puzzle.width()] = value;
-    }
-  }
-
-  Uint32 rmask = 0x000000ff,
-         gmask = 0x0000ff00,
-         bmask = 0x00ff0000,
-         amask = 0xff000000;
-  SDL_FreeFormat(fmt);
-  SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(static_cast<void*>(data),
-                                                  puzzle.width(),
-                                                  puzzle.height(),
-                                                  32, 4 * puzzle.width(),
-                                                  rmask, gmask, bmask, amask);
-
-  IMG_SavePNG(surface, filename.c_str());
-
-  SDL_FreeSurface(surface);
-  delete[] data;
-}
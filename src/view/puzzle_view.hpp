@@ -23,6 +23,7 @@
 
 #include <string>
 #include "puzzle/puzzle.hpp"
+#include "puzzle/puzzle_progress.hpp"
 #include "ui/scrolling_panel.hpp"
 #include "video/font.hpp"
 #include "video/texture.hpp"
@@ -51,6 +52,7 @@ public:
   void update(unsigned ticks, InputHandler& input) override;
   void draw(Renderer& renderer) override;
   void resize(int width, int height) override;
+  unsigned time_until_update() const override;
 
   void save_progress();
   void restart();
@@ -83,6 +85,7 @@ private:
 
   Puzzle m_puzzle;
   std::string m_puzzle_filename;
+  PuzzleProgress m_progress; //last progress saved for this puzzle
   bool m_edit_mode = false;
   unsigned m_best_time = 0;
   bool m_ask_before_save = false;
@@ -92,17 +95,14 @@ private:
   ScrollingPanel m_info_pane;
 
   std::unique_ptr<Font> m_clue_font;
-  std::unique_ptr<Texture> m_cell_texture;
-
-  std::unique_ptr<Font> m_title_font;
-  std::unique_ptr<Font> m_info_font;
-  std::unique_ptr<Font> m_size_font;
-  std::unique_ptr<Texture> m_ctrl_texture;
-  std::unique_ptr<Texture> m_arrow_texture;
-  std::unique_ptr<Texture> m_draw_texture;
+  std::shared_ptr<Texture> m_cell_texture;
+
+  std::shared_ptr<Font> m_title_font;
+  std::shared_ptr<Font> m_info_font;
+  std::shared_ptr<Font> m_size_font;
+  std::shared_ptr<Texture> m_ctrl_texture;
+  std::shared_ptr<Texture> m_arrow_texture;
+  std::shared_ptr<Texture> m_draw_texture;
 };
 
-void read_puzzle_png(const std::string& filename, Puzzle& puzzle);
-void write_puzzle_png(const std::string& filename, Puzzle& puzzle);
-
 #endif
@@ -68,6 +68,11 @@ void VictoryView::update(unsigned ticks, InputHandler& input)
     m_mgr.schedule_action(ViewManager::Action::quit_puzzle);
 }
 
+unsigned VictoryView::time_until_update() const
+{
+  return no_timeout;
+}
+
 void VictoryView::draw(Renderer& renderer)
 {
   Point pt(0, spacing);
@@ -158,13 +163,8 @@ void VictoryView::load_resources()
     oss << " (New record!)";
   m_times = oss.str();
 
-  GameSettings& settings = m_mgr.game_settings();
-  std::string font_file = settings.font_dir()
-    + settings.filesystem_separator() + "FreeSans.ttf";
-  std::string bold_font_file = settings.font_dir()
-    + settings.filesystem_separator() + "FreeSansBold.ttf";
-  m_title_font = m_mgr.video_system().new_font(bold_font_file, 32);
-  m_info_font = m_mgr.video_system().new_font(font_file, 24);
+  m_title_font = m_mgr.assets().font("FreeSansBold.ttf", 32);
+  m_info_font = m_mgr.assets().font("FreeSans.ttf", 24);
 
   m_back_button = std::make_shared<Button>(*m_info_font, "Back");
   m_back_button->register_callback([this]() {
@@ -53,6 +53,7 @@ public:
   void update(unsigned ticks, InputHandler& input) override;
   void draw(Renderer& renderer) override;
   void resize(int width, int height) override;
+  unsigned time_until_update() const override;
 
 private:
   void load_resources();
@@ -63,8 +64,8 @@ private:
   std::string m_puzzle_title;
   std::string m_puzzle_author;
   std::string m_times;
-  std::unique_ptr<Font> m_title_font;
-  std::unique_ptr<Font> m_info_font;
+  std::shared_ptr<Font> m_title_font;
+  std::shared_ptr<Font> m_info_font;
 
   std::shared_ptr<Button> m_back_button;
 
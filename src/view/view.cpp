@@ -20,6 +20,8 @@
 
 #include "view/view.hpp"
 
+constexpr unsigned View::no_timeout;
+
 void View::resize(int width, int height)
 {
   m_width = width;
@@ -43,6 +43,15 @@ public:
 
   virtual bool is_transparent() const { return false; }
 
+  /*
+   * How long in milliseconds the view can go without input before it
+   * needs to be updated and drawn again: 0 while it is animating, or
+   * no_timeout if it only changes in response to input. The default
+   * updates the view on every frame.
+   */
+  static constexpr unsigned no_timeout = static_cast<unsigned>(-1);
+  virtual unsigned time_until_update() const { return 0; }
+
 protected:
   ViewManager& m_mgr;
   int m_width = 0;
@@ -22,8 +22,10 @@
 
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include "input/input_handler.hpp"
 #include "settings/game_settings.hpp"
+#include "utility/trace.hpp"
 #include "video/renderer.hpp"
 #include "view/analyze_view.hpp"
 #include "view/data_edit_view.hpp"
@@ -37,7 +39,10 @@ ViewManager::ViewManager(VideoSystem& vs, Renderer& renderer,
   : m_video(vs),
     m_renderer(renderer),
     m_settings(settings),
-    m_save_mgr(settings)
+    m_save_mgr(settings),
+    m_assets(vs, renderer,
+             settings.font_dir() + settings.filesystem_separator(),
+             settings.image_dir() + settings.filesystem_separator())
 {
 }
 
@@ -48,11 +53,33 @@ ViewManager::ViewManager(VideoSystem& vs, Renderer& renderer,
     m_renderer(renderer),
     m_settings(settings),
     m_save_mgr(settings),
+    m_assets(vs, renderer,
+             settings.font_dir() + settings.filesystem_separator(),
+             settings.image_dir() + settings.filesystem_separator()),
     m_width(width),
     m_height(height)
 {
 }
 
+void ViewManager::preload_assets()
+{
+  //keep in step with the views' load_resources functions
+  static const std::pair<const char*, int> fonts[] = {
+    { "FreeSans.ttf", 12 }, { "FreeSans.ttf", 16 },
+    { "FreeSans.ttf", 18 }, { "FreeSans.ttf", 24 },
+    { "FreeSansBold.ttf", 32 }, { "FreeSansBold.ttf", 56 }
+  };
+  static const char* const images[] = {
+    "control.png", "draw.png", "file.png", "nav.png", "nonny.png",
+    "puzzle.png"
+  };
+
+  for (const auto& font : fonts)
+    m_assets.font(font.first, font.second);
+  for (const char* image : images)
+    m_assets.image(image);
+}
+
 void ViewManager::message_box(const std::string& message,
                               MessageBoxView::Type type,
                               Callback on_yes,
@@ -289,6 +316,11 @@ void ViewManager::update(unsigned ticks, InputHandler& input)
     resize(m_width, m_height);
   }
 
+  if (input.was_key_pressed(Keyboard::f3))
+    m_show_profiler = !m_show_profiler;
+  if (input.was_key_pressed(Keyboard::f4))
+    trace::dump();
+
   if (!m_views.empty())
     m_views.back()->update(ticks, input);
 }
@@ -304,6 +336,25 @@ void ViewManager::draw(Renderer& renderer)
       ++cur;
     }
   }
+
+  if (m_show_profiler)
+    draw_profiler(renderer);
+}
+
+unsigned ViewManager::time_until_update() const
+{
+  //only the top view is updated, so only it can be animating
+  if (m_action != Action::no_action || m_views.empty())
+    return 0;
+  return m_views.back()->time_until_update();
+}
+
+long ViewManager::num_lines_solved() const
+{
+  if (m_views.empty())
+    return -1;
+  auto av = std::dynamic_pointer_cast<AnalyzeView>(m_views.back());
+  return av ? av->num_lines_solved() : -1;
 }
 
 void ViewManager::refresh()
@@ -330,6 +381,16 @@ bool ViewManager::is_save_needed() const
   return false;
 }
 
+void ViewManager::draw_profiler(Renderer& renderer)
+{
+  if (!m_profiler_font)
+    m_profiler_font = m_assets.font("FreeSans.ttf", 12);
+
+  renderer.set_viewport();
+  renderer.set_clip_rect();
+  m_profiler.draw(renderer, *m_profiler_font, m_width, 0);
+}
+
 bool ViewManager::save()
 {
   for (auto it = m_views.rbegin(); it != m_views.rend(); ++it) {
@@ -26,8 +26,10 @@
 #include <string>
 #include <vector>
 #include "save/save_manager.hpp"
+#include "view/frame_profiler.hpp"
 #include "view/message_box_view.hpp"
 #include "view/view.hpp"
+#include "video/asset_cache.hpp"
 #include "video/font.hpp"
 #include "video/video_system.hpp"
 
@@ -69,11 +71,31 @@ public:
   void update(unsigned ticks, InputHandler& input);
   void draw(Renderer& renderer);
 
+  // How long the game can wait for input; see View::time_until_update
+  unsigned time_until_update() const;
+
+  /*
+   * Timing for the game loop. Pressing F3 toggles an overlay showing
+   * recent frames on top of the current view.
+   */
+  FrameProfiler& profiler() { return m_profiler; }
+  const FrameProfiler& profiler() const { return m_profiler; }
+
+  // Lines solved by an open analysis, or -1 if none is open
+  long num_lines_solved() const;
+
   void refresh();
   void resize(int width, int height);
   int width() const { return m_width; }
   int height() const { return m_height; }
 
+  /*
+   * Fonts and images shared by the views. Preloading loads everything
+   * the views use, so that switching views needs no disk I/O.
+   */
+  AssetCache& assets() { return m_assets; }
+  void preload_assets();
+
   VideoSystem& video_system() { return m_video; }
   const VideoSystem& video_system() const { return m_video; }
 
@@ -89,12 +111,14 @@ public:
 private:
   bool is_save_needed() const;
   bool save(); //returns true if save was successful or unneeded
+  void draw_profiler(Renderer& renderer);
 
   std::vector<std::shared_ptr<View>> m_views;
   VideoSystem& m_video;
   Renderer& m_renderer;
   GameSettings& m_settings;
   SaveManager m_save_mgr;
+  AssetCache m_assets;
   int m_width = 0;
   int m_height = 0;
   enum PuzzleStatus { no_puzzle, puzzle_play, puzzle_edit };
@@ -103,6 +127,10 @@ private:
   Action m_action = Action::no_action;
   std::string m_action_arg;
 
+  FrameProfiler m_profiler;
+  bool m_show_profiler = false;
+  std::shared_ptr<Font> m_profiler_font;
+
   //Message box callbacks
   MessageBoxView::Type m_mbox_type;
   Callback m_mbox_yes;